@@ -59,6 +59,12 @@
 /* Relation uses a union relation */
 #define EQREL_RELATION (0x100)
 
+/* Relation uses a sparse bit-map data structure */
+#define BITMAP_RELATION (0x200)
+
+/* Relation uses hash indices for equality searches */
+#define HASH_RELATION (0x400)
+
 /* Relation warnings are suppressed */
 #define SUPPRESSED_RELATION (0x800)
 
@@ -116,6 +122,8 @@ public:
 
     /** Set qualifier associated with this relation */
     void setQualifier(int q) {
+        // the io directives of the qualifiers that were set already exist
+        const int added = q & ~qualifier;
         qualifier = q;
         if (q & EQREL_RELATION) {
             representation = RelationRepresentation::EQREL;
@@ -123,19 +131,23 @@ public:
             representation = RelationRepresentation::BRIE;
         } else if (q & BTREE_RELATION) {
             representation = RelationRepresentation::BTREE;
+        } else if (q & BITMAP_RELATION) {
+            representation = RelationRepresentation::BITMAP;
+        } else if (q & HASH_RELATION) {
+            representation = RelationRepresentation::HASH;
         }
 
-        if (q & INPUT_RELATION) {
+        if (added & INPUT_RELATION) {
             loads.emplace_back(new AstLoad());
             loads.back()->setName(getName());
             loads.back()->setSrcLoc(getSrcLoc());
         }
-        if (q & OUTPUT_RELATION) {
+        if (added & OUTPUT_RELATION) {
             stores.emplace_back(new AstStore());
             stores.back()->setName(getName());
             stores.back()->setSrcLoc(getSrcLoc());
         }
-        if (q & PRINTSIZE_RELATION) {
+        if (added & PRINTSIZE_RELATION) {
             stores.emplace_back(new AstPrintSize());
             stores.back()->setName(getName());
             stores.back()->setSrcLoc(getSrcLoc());
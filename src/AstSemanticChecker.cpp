@@ -192,6 +192,8 @@ void AstSemanticChecker::checkProgram(AstTranslationUnit& translationUnit) {
     visitDepthFirst(nodes, [&](const AstRecordInit& cnst) {
         // TODO (#467) remove the next line to enable subprogram compilation for record types
         Global::config().unset("engine");
+        // records are numbered differently by each process of a data-parallel run
+        Global::config().unset("data-parallel");
         TypeSet types = typeAnalysis.getTypes(&cnst);
         if (isRecordType(types)) {
             for (const Type& type : types) {
@@ -212,6 +214,11 @@ void AstSemanticChecker::checkProgram(AstTranslationUnit& translationUnit) {
 
     // - intrinsic functors -
     visitDepthFirst(nodes, [&](const AstIntrinsicFunctor& fun) {
+        // symbols created at run time are numbered differently by each process of a data-parallel run
+        if (fun.isSymbolic()) {
+            Global::config().unset("data-parallel");
+        }
+
         // check type of result
         if (fun.isNumerical() && !isNumberType(typeAnalysis.getTypes(&fun))) {
             report.addError("Non-numeric use for numeric functor", fun.getSrcLoc());
@@ -246,6 +253,10 @@ void AstSemanticChecker::checkProgram(AstTranslationUnit& translationUnit) {
             if (funDecl->getArgCount() != fun.getArgCount()) {
                 report.addError("Mismatching number of arguments of functor", fun.getSrcLoc());
             }
+            // symbols created at run time are numbered differently by each process of a data-parallel run
+            if (funDecl->isSymbolic()) {
+                Global::config().unset("data-parallel");
+            }
             // check return values of user-defined functor
             if (funDecl->isNumerical() && !isNumberType(typeAnalysis.getTypes(&fun))) {
                 report.addError("Non-numeric use for numeric functor", fun.getSrcLoc());
@@ -647,6 +658,10 @@ void AstSemanticChecker::checkRelation(ErrorReport& report, const TypeEnvironmen
                     relation.getSrcLoc());
         }
     }
+    if (relation.getRepresentation() == RelationRepresentation::BITMAP && relation.getArity() != 1) {
+        report.addError(
+                "Bitmap relation " + toString(relation.getName()) + " is not unary", relation.getSrcLoc());
+    }
 
     // start with declaration
     checkRelationDeclaration(report, typeEnv, program, relation, ioTypes);
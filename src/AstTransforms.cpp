@@ -897,8 +897,8 @@ bool ReduceExistentialsTransformer::transform(AstTranslationUnit& translationUni
         newRelation->setName(newRelationName.str());
         newRelation->setSrcLoc(originalRelation->getSrcLoc());
 
-        // EqRel relations require two arguments, so remove it from the qualifier
-        newRelation->setQualifier(originalRelation->getQualifier() & ~(EQREL_RELATION));
+        // EqRel and bitmap relations require a fixed arity, so remove them from the qualifier
+        newRelation->setQualifier(originalRelation->getQualifier() & ~(EQREL_RELATION | BITMAP_RELATION));
 
         // Keep all non-recursive clauses
         for (AstClause* clause : originalRelation->getClauses()) {
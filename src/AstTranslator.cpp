@@ -825,7 +825,8 @@ std::unique_ptr<RamStatement> AstTranslator::ClauseTranslator::translateClause(
                                     std::make_unique<RamEmptinessCheck>(translator.translateRelation(head))),
                             std::move(op));
                 }
-                if (Global::config().has("profile")) {
+                // count the tuples of each atom, unless the profile samples rules rather than timing them
+                if (Global::config().has("profile") && !Global::config().has("profile-sampling")) {
                     std::stringstream ss;
                     ss << head->getName();
                     ss.str("");
@@ -953,6 +954,13 @@ std::unique_ptr<RamStatement> AstTranslator::translateNonRecursiveRelation(
             appendStmt(res, std::make_unique<RamLogSize>(
                                     std::unique_ptr<RamRelationReference>(rrel->clone()), logSizeStatement));
         }
+
+        // add memory printer, which walks the indexes and is too slow for a sampling profile
+        if (!Global::config().has("profile-sampling")) {
+            appendStmt(res,
+                    std::make_unique<RamLogMemory>(std::unique_ptr<RamRelationReference>(rrel->clone()),
+                            LogStatement::mNonrecursiveRelation(relationName, srcLocation)));
+        }
     }
 
     // done
@@ -1033,6 +1041,14 @@ std::unique_ptr<RamStatement> AstTranslator::translateRecursiveRelation(
             updateRelTable = std::make_unique<RamLogRelationTimer>(std::move(updateRelTable),
                     LogStatement::cRecursiveRelation(toString(rel->getName()), rel->getSrcLoc()),
                     std::unique_ptr<RamRelationReference>(relNew[rel]->clone()));
+
+            /* measure the memory of each relation at the end of each iteration */
+            if (!Global::config().has("profile-sampling")) {
+                appendStmt(updateRelTable, std::make_unique<RamLogMemory>(
+                                                   std::unique_ptr<RamRelationReference>(rrel[rel]->clone()),
+                                                   LogStatement::mRecursiveRelation(
+                                                           toString(rel->getName()), rel->getSrcLoc())));
+            }
         }
 
         /* drop temporary tables after recursion */
@@ -1477,7 +1493,10 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
         appendStmt(current, std::make_unique<RamDrop>(translateRelation(relation)));
     };
 
-#ifdef USE_MPI
+    // the processes of the mpi and shm engines exchange relations by messages rather than files
+    const bool passMessages =
+            Global::config().get("engine") == "mpi" || Global::config().get("engine") == "shm";
+
     const auto& makeRamSend = [&](std::unique_ptr<RamStatement>& current, const AstRelation* relation,
                                       const std::set<size_t> destinationStrata) {
         appendStmt(current, std::make_unique<RamSend>(translateRelation(relation), destinationStrata));
@@ -1495,7 +1514,6 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
     const auto& makeRamWait = [&](std::unique_ptr<RamStatement>& current, const size_t count) {
         appendStmt(current, std::make_unique<RamWait>(count));
     };
-#endif
 
     // maintain the index of the SCC within the topological order
     size_t indexOfScc = 0;
@@ -1537,11 +1555,10 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
             }
         }
 
-#ifdef USE_MPI
         const auto& externPreds = sccGraph.getExternalPredecessorRelations(scc);
         const auto& internsWithExternSuccs = sccGraph.getInternalRelationsWithExternalSuccessors(scc);
         // note that the order of receives is first by relation then second destination
-        if (Global::config().get("engine") == "mpi") {
+        if (passMessages) {
             // first, recv all internal input relations from the master process
             for (const auto& relation : internIns) {
                 makeRamRecv(current, relation, (size_t)-1);
@@ -1550,9 +1567,7 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
             for (const auto& relation : externPreds) {
                 makeRamRecv(current, relation, sccOrder.indexOfScc(sccGraph.getSCC(relation)));
             }
-        } else
-#endif
-        {
+        } else {
             // load all internal input relations from the facts dir with a .facts extension
             for (const auto& relation : internIns) {
                 makeRamLoad(current, relation, "fact-dir", ".facts");
@@ -1578,9 +1593,8 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
                                          *((const AstRelation*)*allInterns.begin()), recursiveClauses)
                                : translateRecursiveRelation(allInterns, recursiveClauses);
         appendStmt(current, std::move(bodyStatement));
-#ifdef USE_MPI
         // note that the order of sends is first by relation then second destination
-        if (Global::config().get("engine") == "mpi") {
+        if (passMessages) {
             // first, send all internal relations with external successors to their destination slave
             // processes
             for (const auto& relation : internsWithExternSuccs) {
@@ -1592,9 +1606,7 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
             for (const auto& relation : internOuts) {
                 makeRamSend(current, relation, std::set<size_t>({(size_t)-1}));
             }
-        } else
-#endif
-        {
+        } else {
             // if a communication engine is enabled...
             if (Global::config().has("engine")) {
                 // store all internal non-output relations with external successors to the output dir with
@@ -1643,8 +1655,7 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
         }
     }
 
-#ifdef USE_MPI
-    if (Global::config().get("engine") == "mpi") {
+    if (passMessages) {
         // make a new ram statement for the master process
         std::unique_ptr<RamStatement> current;
 
@@ -1695,7 +1706,6 @@ void AstTranslator::translateProgram(const AstTranslationUnit& translationUnit)
         // append the master process as a stratum with index of the max int
         appendStmt(res, std::make_unique<RamStratum>(std::move(current), std::numeric_limits<int>::max()));
     }
-#endif
 
     // add main timer if profiling
     if (res && Global::config().has("profile")) {
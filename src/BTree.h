@@ -20,9 +20,11 @@
 #include "ParallelUtils.h"
 #include "Util.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <iterator>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -229,6 +231,29 @@ struct updater {
     void update(T& /* old_t */, const T& /* new_t */) {}
 };
 
+/**
+ * The number of entries in the sub-tree rooted by a node. Only recorded by
+ * b-trees supporting order statistics; others do not spend memory on it.
+ */
+template <bool isCounted>
+struct subtree_size {
+    void setSubtreeSize(std::size_t /* size */) {}
+    std::size_t getSubtreeSize() const {
+        return 0;
+    }
+};
+
+template <>
+struct subtree_size<true> {
+    std::size_t subtreeSize = 0;
+    void setSubtreeSize(std::size_t size) {
+        subtreeSize = size;
+    }
+    std::size_t getSubtreeSize() const {
+        return subtreeSize;
+    }
+};
+
 /**
  * The actual implementation of a b-tree data structure.
  *
@@ -238,11 +263,12 @@ struct updater {
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
  * @tparam isSet        .. true = set, false = multiset
+ * @tparam isCounted    .. true = record sub-tree sizes for order statistics while frozen
  */
 template <typename Key, typename Comparator,
         typename Allocator,  // is ignored so far - TODO: add support
         unsigned blockSize, typename SearchStrategy, bool isSet, typename WeakComparator = Comparator,
-        typename Updater = detail::updater<Key>>
+        typename Updater = detail::updater<Key>, bool isCounted = false>
 class btree {
 public:
     class iterator;
@@ -297,7 +323,7 @@ protected:
      * The base type of all node types containing essential
      * book-keeping information.
      */
-    struct base {
+    struct base : public subtree_size<isCounted> {
 #ifdef IS_PARALLEL
 
         // the parent node
@@ -395,6 +421,7 @@ protected:
             // copy basic fields
             res->position = this->position;
             res->numElements = this->numElements;
+            res->setSubtreeSize(this->getSubtreeSize());
 
             for (size_type i = 0; i < this->numElements; ++i) {
                 res->keys[i] = this->keys[i];
@@ -475,6 +502,23 @@ protected:
             return sum;
         }
 
+        /**
+         * Records the number of entries contained in the sub-tree rooted by each
+         * node of the sub-tree rooted by this node.
+         *
+         * @return the number of entries contained in the sub-tree rooted by this node
+         */
+        size_type countSubtreeSizes() {
+            size_type sum = this->numElements;
+            if (this->isInner()) {
+                for (unsigned i = 0; i <= this->numElements; ++i) {
+                    sum += getChild(i)->countSubtreeSizes();
+                }
+            }
+            this->setSubtreeSize(sum);
+            return sum;
+        }
+
         /**
          * Determines the amount of memory used by the sub-tree rooted
          * by this node.
@@ -1086,6 +1130,8 @@ public:
      * The iterator type to be utilized for scanning through btree instances.
      */
     class iterator : public std::iterator<std::forward_iterator_tag, Key> {
+        friend class btree;
+
         // a pointer to the node currently referred to
         node const* cur;
 
@@ -1216,6 +1262,12 @@ protected:
     // a pointer to the left-most node of this tree (initial note for iteration)
     leaf_node* leftmost;
 
+    // a flag indicating that this tree is read-only until it gets unfrozen
+    bool frozen = false;
+
+    // the number of elements recorded when this tree was frozen
+    size_type frozenSize = 0;
+
     /* -------------- operator hint statistics ----------------- */
 
     // an aggregation of statistical values of the hint utilization
@@ -1256,9 +1308,12 @@ public:
 
     // a move constructor
     btree(btree&& other)
-            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost) {
+            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost),
+              frozen(other.frozen), frozenSize(other.frozenSize) {
         other.root = nullptr;
         other.leftmost = nullptr;
+        other.frozen = false;
+        other.frozenSize = 0;
     }
 
     // a copy constructor
@@ -1289,9 +1344,50 @@ public:
 
     // determines the number of elements in this tree
     size_type size() const {
+        if (frozen) {
+            return frozenSize;
+        }
         return (root) ? root->countEntries() : 0;
     }
 
+    /**
+     * Freezes this tree, declaring it read-only until unfreeze() is called.
+     * While frozen, the element count is cached such that size() requests
+     * do not need to traverse the tree. Lookups and iterators never acquire
+     * node locks, hence a frozen tree may be read concurrently without any
+     * synchronization. Insertions into a frozen tree throw a std::logic_error.
+     * Trees supporting order statistics record the sizes of all sub-trees.
+     */
+    void freeze() {
+        if (frozen) {
+            return;
+        }
+        if (root) {
+            frozenSize = (isCounted) ? root->countSubtreeSizes() : root->countEntries();
+        } else {
+            frozenSize = 0;
+        }
+        frozen = true;
+    }
+
+    /**
+     * Lifts the read-only state of this tree established by freeze(). Must
+     * be called before inserting into a tree that has been frozen.
+     */
+    void unfreeze() {
+        frozen = false;
+    }
+
+    // determines whether this tree is currently frozen
+    bool isFrozen() const {
+        return frozen;
+    }
+
+    // determines whether count() and nth() are currently answered in logarithmic time
+    bool hasOrderStatistics() const {
+        return isCounted && frozen;
+    }
+
     /**
      * Inserts the given key into this tree.
      */
@@ -1304,6 +1400,11 @@ public:
      * Inserts the given key into this tree.
      */
     bool insert(const Key& k, operation_hints& hints) {
+        // the cached size and sub-tree sizes of a frozen tree would be invalidated
+        if (frozen) {
+            throw std::logic_error("insertion into frozen b-tree - unfreeze it first");
+        }
+
 #ifdef IS_PARALLEL
 
         // special handling for inserting first element
@@ -1731,9 +1832,80 @@ public:
         if (empty()) {
             return res;
         }
+
+        // with order statistics the chunks are cut at exact positions
+        if (hasOrderStatistics()) {
+            num = std::max<size_type>(1, std::min(num, frozenSize));
+            iterator from = begin();
+            for (size_type i = 1; i < num; ++i) {
+                iterator to = nth(i * frozenSize / num);
+                res.push_back(chunk(from, to));
+                from = to;
+            }
+            res.push_back(chunk(from, end()));
+            return res;
+        }
+
         return root->collectChunks(res, num, begin(), end());
     }
 
+    /**
+     * Determines the number of elements in the given range of this tree. The
+     * range is counted in logarithmic time if this tree has order statistics,
+     * by iterating through it otherwise.
+     *
+     * @param a .. the iterator referencing the first element of the range
+     * @param b .. the iterator referencing the element after the range
+     */
+    size_type count(const iterator& a, const iterator& b) const {
+        if (hasOrderStatistics()) {
+            return rank(b) - rank(a);
+        }
+        size_type res = 0;
+        for (iterator it = a; it != b; ++it) {
+            ++res;
+        }
+        return res;
+    }
+
+    /**
+     * Obtains an iterator referencing the element at the given position within
+     * the order of this tree, or an end-iterator if there is no such element.
+     * The element is located in logarithmic time if this tree has order
+     * statistics, by iterating up to it otherwise.
+     */
+    iterator nth(size_type i) const {
+        if (!hasOrderStatistics()) {
+            iterator it = begin();
+            for (; i > 0 && it != end(); --i) {
+                ++it;
+            }
+            return it;
+        }
+        if (i >= frozenSize) {
+            return end();
+        }
+
+        // descend to the node containing the requested element
+        const node* cur = root;
+        while (cur->isInner()) {
+            size_type j = 0;
+            for (; j < cur->numElements; ++j) {
+                size_type childSize = cur->getChild(j)->getSubtreeSize();
+                if (i < childSize) {
+                    break;
+                }
+                i -= childSize;
+                if (i == 0) {
+                    return iterator(cur, j);
+                }
+                --i;
+            }
+            cur = cur->getChild(j);
+        }
+        return iterator(cur, i);
+    }
+
     /**
      * Determines whether the given element is a member of this tree.
      */
@@ -1933,6 +2105,8 @@ public:
         delete root;
         root = nullptr;
         leftmost = nullptr;
+        frozen = false;
+        frozenSize = 0;
     }
 
     /**
@@ -1944,6 +2118,8 @@ public:
         // swap the content
         std::swap(root, other.root);
         std::swap(leftmost, other.leftmost);
+        std::swap(frozen, other.frozen);
+        std::swap(frozenSize, other.frozenSize);
     }
 
     // Implementation of the assignment operation for trees.
@@ -1953,6 +2129,9 @@ public:
             return *this;
         }
 
+        // the content is replaced, hence a cached state is no longer valid
+        frozen = false;
+
         // create a deep-copy of the content of the other tree
         // shortcut for empty sets
         if (other.empty()) {
@@ -2115,6 +2294,37 @@ public:
     }
 
 protected:
+    /**
+     * Determines the number of elements preceding the element referenced by the
+     * given iterator, utilizing the recorded sub-tree sizes.
+     */
+    size_type rank(const iterator& it) const {
+        assert(hasOrderStatistics());
+        if (it.cur == nullptr) {
+            return frozenSize;
+        }
+
+        // the elements before the position within the current node
+        const node* cur = it.cur;
+        size_type res = it.pos;
+        if (cur->isInner()) {
+            for (size_type i = 0; i <= it.pos; ++i) {
+                res += cur->getChild(i)->getSubtreeSize();
+            }
+        }
+
+        // the elements in the sub-trees to the left of the path to the root
+        while (cur->getParent() != nullptr) {
+            const size_type pos = cur->getPositionInParent();
+            cur = cur->getParent();
+            res += pos;
+            for (size_type i = 0; i < pos; ++i) {
+                res += cur->getChild(i)->getSubtreeSize();
+            }
+        }
+        return res;
+    }
+
     /**
      * Determines whether the range covered by the given node is also
      * covering the given key value.
@@ -2214,9 +2424,9 @@ private:
 
 // Instantiation of static member search.
 template <typename Key, typename Comparator, typename Allocator, unsigned blockSize, typename SearchStrategy,
-        bool isSet, typename WeakComparator, typename Updater>
-const SearchStrategy
-        btree<Key, Comparator, Allocator, blockSize, SearchStrategy, isSet, WeakComparator, Updater>::search;
+        bool isSet, typename WeakComparator, typename Updater, bool isCounted>
+const SearchStrategy btree<Key, Comparator, Allocator, blockSize, SearchStrategy, isSet, WeakComparator,
+        Updater, isCounted>::search;
 
 }  // end namespace detail
 
@@ -2228,18 +2438,19 @@ const SearchStrategy
  * @tparam Allocator     .. utilized for allocating memory for required nodes
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
+ * @tparam isCounted    .. enables order statistics, see count() and nth()
  */
 template <typename Key, typename Comparator = detail::comparator<Key>,
         typename Allocator = std::allocator<Key>,  // is ignored so far
         unsigned blockSize = 256, typename SearchStrategy = typename detail::default_strategy<Key>::type,
-        typename WeakComparator = Comparator, typename Updater = detail::updater<Key>>
+        typename WeakComparator = Comparator, typename Updater = detail::updater<Key>, bool isCounted = false>
 class btree_set : public detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, true,
-                          WeakComparator, Updater> {
+                          WeakComparator, Updater, isCounted> {
     using super = detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, true, WeakComparator,
-            Updater>;
+            Updater, isCounted>;
 
     friend class detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, true, WeakComparator,
-            Updater>;
+            Updater, isCounted>;
 
 public:
     /**
@@ -2289,18 +2500,19 @@ public:
  * @tparam Allocator     .. utilized for allocating memory for required nodes
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
+ * @tparam isCounted    .. enables order statistics, see count() and nth()
  */
 template <typename Key, typename Comparator = detail::comparator<Key>,
         typename Allocator = std::allocator<Key>,  // is ignored so far
         unsigned blockSize = 256, typename SearchStrategy = typename detail::default_strategy<Key>::type,
-        typename WeakComparator = Comparator, typename Updater = detail::updater<Key>>
+        typename WeakComparator = Comparator, typename Updater = detail::updater<Key>, bool isCounted = false>
 class btree_multiset : public detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, false,
-                               WeakComparator, Updater> {
+                               WeakComparator, Updater, isCounted> {
     using super = detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, false, WeakComparator,
-            Updater>;
+            Updater, isCounted>;
 
     friend class detail::btree<Key, Comparator, Allocator, blockSize, SearchStrategy, false, WeakComparator,
-            Updater>;
+            Updater, isCounted>;
 
 public:
     /**
@@ -2342,4 +2554,18 @@ public:
     }
 };
 
+/**
+ * A b-tree based set supporting order statistics while frozen.
+ */
+template <typename Key, typename Comparator = detail::comparator<Key>>
+using btree_counted_set = btree_set<Key, Comparator, std::allocator<Key>, 256,
+        typename detail::default_strategy<Key>::type, Comparator, detail::updater<Key>, true>;
+
+/**
+ * A b-tree based multi-set supporting order statistics while frozen.
+ */
+template <typename Key, typename Comparator = detail::comparator<Key>>
+using btree_counted_multiset = btree_multiset<Key, Comparator, std::allocator<Key>, 256,
+        typename detail::default_strategy<Key>::type, Comparator, detail::updater<Key>, true>;
+
 }  // end of namespace souffle
@@ -27,6 +27,7 @@
 #pragma once
 
 #include "CompiledTuple.h"
+#include "ParallelUtils.h"
 #include "RamTypes.h"
 #include "Util.h"
 
@@ -797,11 +798,93 @@ private:
         }
     }
 
+    /**
+     * A static operation merging the given source sub-tree into the given target
+     * sub-tree utilizing multiple threads. The first node of the source sub-tree
+     * with more than a single branch is split and its branches -- covering disjoint
+     * index ranges -- are merged concurrently.
+     *
+     * @param parent the parent node of the current merge operation
+     * @param trg a reference to the pointer the merged node should be stored to
+     * @param src the node to be merged
+     * @param levels the height of the merged node
+     */
+    static void mergeParallel(const Node* parent, Node*& trg, const Node* src, int levels) {
+        // if other side is null => done
+        if (!src) return;
+
+#ifdef SOUFFLE_WORK_STEALING
+        // nested merges are processed by the thread encountering them
+        if (WorkStealingPool::inParallel()) {
+            merge(parent, trg, src, levels);
+            return;
+        }
+#elif defined _OPENMP
+        // nested merges are processed by the thread encountering them
+        if (omp_in_parallel()) {
+            merge(parent, trg, src, levels);
+            return;
+        }
+#endif
+
+        // descend along chains of single branches
+        Node** node = &trg;
+        while (true) {
+            // create the target node if necessary -- its content is merged below
+            if (*node == nullptr) {
+                *node = newNode();
+                (*node)->parent = parent;
+            }
+
+            // the leaf level can not be split any further
+            if (levels == 0) break;
+
+            // check whether there is a single branch only
+            int branch = -1;
+            int branches = 0;
+            for (int i = 0; i < NUM_CELLS; ++i) {
+                if (src->cell[i].ptr) {
+                    branch = i;
+                    ++branches;
+                }
+            }
+            if (branches != 1) break;
+
+            // continue one level below
+            parent = *node;
+            node = &(*node)->cell[branch].ptr;
+            src = src->cell[branch].ptr;
+            --levels;
+        }
+
+        // merge the branches of this level in parallel
+        Node* cur = *node;
+        PARALLEL_START {
+            merge_op merg;
+            pfor_range(i, 0, NUM_CELLS) {
+                if (levels == 0) {
+                    cur->cell[i].value = merg(cur->cell[i].value, src->cell[i].value);
+                } else {
+                    merge(cur, cur->cell[i].ptr, src->cell[i].ptr, levels - 1);
+                }
+            }
+        }
+        PARALLEL_END
+    }
+
 public:
     /**
      * Adds all the values stored in the given array to this array.
      */
     void addAll(const SparseArray& other) {
+        addAll(other, false);
+    }
+
+    /**
+     * Adds all the values stored in the given array to this array. If requested,
+     * the disjoint top-level branches of the given array are merged in parallel.
+     */
+    void addAll(const SparseArray& other, bool parallel) {
         // skip if other is empty
         if (other.empty()) {
             return;
@@ -809,9 +892,16 @@ public:
 
         // special case: emptiness
         if (empty()) {
-            // use assignment operator
-            *this = other;
-            return;
+            if (!parallel) {
+                // use assignment operator
+                *this = other;
+                return;
+            }
+
+            // adopt the shape of the other tree and fill it below
+            unsynced.levels = other.unsynced.levels;
+            unsynced.offset = other.unsynced.offset;
+            unsynced.firstOffset = std::numeric_limits<index_type>::max();
         }
 
         // adjust levels
@@ -842,7 +932,11 @@ public:
         }
 
         // merge sub-branches from here
-        merge((*node)->parent, *node, other.unsynced.root, level);
+        if (parallel) {
+            mergeParallel((*node) ? (*node)->parent : nullptr, *node, other.unsynced.root, level);
+        } else {
+            merge((*node)->parent, *node, other.unsynced.root, level);
+        }
 
         // update first
         if (unsynced.firstOffset > other.unsynced.firstOffset) {
@@ -2270,12 +2364,13 @@ public:
     }
 
     /**
-     * Inserts all elements stored within the given trie into this trie.
+     * Inserts all elements stored within the given trie into this trie. The
+     * top-level branches of the given trie are merged in parallel.
      *
      * @param other the elements to be inserted into this trie
      */
     void insertAll(const Trie& other) {
-        store.addAll(other.store);
+        store.addAll(other.store, true);
     }
 
     /**
@@ -26,7 +26,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
-#ifdef _OPENMP
+#ifdef SOUFFLE_WORK_STEALING
+#include "WorkStealing.h"
+#elif defined _OPENMP
 #include <omp.h>
 #endif
 
@@ -185,7 +187,7 @@ public:
                     profile_name = optarg;
                     break;
                 case 'j':
-#ifdef _OPENMP
+#if defined(_OPENMP) || defined(SOUFFLE_WORK_STEALING)
                     if (std::string(optarg) == "auto") {
                         num_jobs = 0;
                     } else {
@@ -214,7 +216,11 @@ public:
         input_dir = fact_dir;
         output_dir = out_dir;
 
-#ifdef _OPENMP
+#ifdef SOUFFLE_WORK_STEALING
+        if (num_jobs > 0) {
+            WorkStealingPool::setNumThreads(num_jobs);
+        }
+#elif defined _OPENMP
         if (num_jobs > 0) {
             omp_set_num_threads(num_jobs);
         }
@@ -242,7 +248,7 @@ private:
             std::cerr << "    -p <file>, --profile=<file>  -- Specify filename for profiling\n";
             std::cerr << "                                    (default: " << profile_name << ")\n";
         }
-#ifdef _OPENMP
+#if defined(_OPENMP) || defined(SOUFFLE_WORK_STEALING)
         std::cerr << "    -j <NUM>, --jobs=<NUM>       -- Specify number of threads\n";
         if (num_jobs > 0) {
             std::cerr << "                                    (default: " << num_jobs << ")\n";
@@ -18,12 +18,16 @@
 
 #include "CompiledTuple.h"
 #include "ParallelUtils.h"
+#include "PiggyList.h"
 #include "Util.h"
 
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <limits>
-#include <memory>
 #include <unordered_map>
-#include <vector>
 
 namespace souffle {
 
@@ -74,29 +78,52 @@ namespace detail {
 
 /**
  * A bidirectional mapping between tuples and reference indices.
+ *
+ * The mapping from tuples to indices is split into shards guarded by their own
+ * read/write lock, such that concurrent packs only contend when they create a
+ * new record in the same shard. Tuples are stored in blocks doubling in size,
+ * which are never moved, such that unpacking is wait-free. The first block
+ * covers about 64 KiB, whatever the arity of the tuples.
  */
 template <typename Tuple>
 class RecordMap {
-    // create blocks of a million entries
-    static const std::size_t BLOCK_SIZE = 1 << 20;
-
     /** The definition of the tuple type handled by this instance */
     using tuple_type = Tuple;
 
-    /** The definition of the type of a tuple block */
-    using block_type = std::array<tuple_type, BLOCK_SIZE>;
+    /** the number of shards, a power of two */
+    static const std::size_t NUM_SHARDS = 64;
+
+    /** the binary logarithm of the given number, rounded down */
+    static constexpr std::size_t floorLog2(std::size_t n) {
+        return (n <= 1) ? 0 : 1 + floorLog2(n / 2);
+    }
+
+    /** the number of tuples in the first block is 2^BLOCK_BITS, such that it covers about 64 KiB */
+    static constexpr std::size_t BLOCK_BITS = floorLog2((1 << 16) / sizeof(tuple_type));
 
-    /** The type utilized for the block index */
-    using block_index_type = std::vector<std::unique_ptr<block_type>>;
+    /** a part of the mapping from tuples to indices */
+    struct alignas(64) Shard {
+        ReadWriteLock lock;
+        std::unordered_map<tuple_type, RamDomain> r2i;
+    };
 
     /** The mapping from tuples to references/indices */
-    std::unordered_map<tuple_type, RamDomain> r2i;
+    Shard shards[NUM_SHARDS];
 
-    /** The mapping from indices to tuples */
-    block_index_type i2r;
+    /** The mapping from indices to tuples, stored in blocks doubling in size */
+    RandomInsertPiggyList<tuple_type> i2r{BLOCK_BITS};
 
-    /** a lock for the pack operation */
-    Lock pack_lock;
+    /** The next index to be assigned, 0 is skipped for the Nil element */
+    std::atomic<std::size_t> next{1};
+
+    /** select the shard of a tuple, mixing the hash value as the maps use its low bits */
+    static std::size_t getShard(const tuple_type& tuple) {
+        uint64_t h = std::hash<tuple_type>()(tuple);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h >> 58) & (NUM_SHARDS - 1);
+    }
 
 public:
     RecordMap() = default;
@@ -105,40 +132,42 @@ public:
      * Packs the given tuple -- and may create a new reference if necessary.
      */
     RamDomain pack(const tuple_type& tuple) {
-        RamDomain index;
-
-        {
-            // lock pack operation
-            auto leas = pack_lock.acquire();  // lock hold till end of scope
-            (void)leas;                       // avoid warning
-
-            // try lookup
-            auto pos = r2i.find(tuple);
-            if (pos != r2i.end()) {
-                // take the previously assigned value
-                index = pos->second;
-            } else {
-                // add tuple to index
-                index = r2i.size() + 1;  // since 0 is skipped for the Nil element
-                r2i[tuple] = index;
-
-                // assert that new index is smaller than the range
-                assert(index != std::numeric_limits<RamDomain>::max());
-
-                if (index / BLOCK_SIZE == i2r.size()) {
-                    i2r.push_back(std::make_unique<block_type>());
-                }
-
-                // create entry for unpacking
-                auto& list = i2r[index / BLOCK_SIZE];
-
-                // insert tuple
-                (*list)[index % BLOCK_SIZE] = tuple;
-            }
+        Shard& shard = shards[getShard(tuple)];
+
+        // try lookup, which may be carried out concurrently
+        shard.lock.start_read();
+        auto pos = shard.r2i.find(tuple);
+        if (pos != shard.r2i.end()) {
+            RamDomain index = pos->second;
+            shard.lock.end_read();
+            return index;
+        }
+        shard.lock.end_read();
+
+        shard.lock.start_write();
+
+        // the tuple may have been added in the meantime
+        pos = shard.r2i.find(tuple);
+        if (pos != shard.r2i.end()) {
+            RamDomain index = pos->second;
+            shard.lock.end_write();
+            return index;
         }
 
+        // add tuple to index
+        std::size_t index = next++;
+
+        // assert that new index is smaller than the range
+        assert(index < static_cast<std::size_t>(std::numeric_limits<RamDomain>::max()));
+
+        // create entry for unpacking before the reference is published
+        i2r.insertAt(index, tuple);
+        shard.r2i[tuple] = index;
+
+        shard.lock.end_write();
+
         // done
-        return index;
+        return static_cast<RamDomain>(index);
     }
 
     /**
@@ -146,7 +175,14 @@ public:
      */
     const tuple_type& unpack(RamDomain index) {
         // just look up the right spot
-        return (*(i2r[index / BLOCK_SIZE]))[index % BLOCK_SIZE];
+        return i2r.get(index);
+    }
+
+    /**
+     * Obtains the number of records created so far.
+     */
+    std::size_t size() const {
+        return next - 1;
     }
 };
 
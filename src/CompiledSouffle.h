@@ -22,20 +22,26 @@
 #include "souffle/CompiledRecord.h"
 #include "souffle/CompiledRelation.h"
 #include "souffle/CompiledTuple.h"
+#include "souffle/HashIndex.h"
 #include "souffle/IODirectives.h"
 #include "souffle/IOSystem.h"
 #include "souffle/Logger.h"
 #include "souffle/ParallelUtils.h"
 #include "souffle/ProfileEvent.h"
+#include "souffle/ProfileSampler.h"
 #include "souffle/RamTypes.h"
 #include "souffle/SignalHandler.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/SymbolTable.h"
+#include "souffle/TaskGraph.h"
 #include "souffle/Util.h"
 #include "souffle/WriteStream.h"
 #ifdef USE_MPI
 #include "souffle/Mpi.h"
 #endif
+#ifdef USE_SHM
+#include "souffle/Shm.h"
+#endif
 
 #include <array>
 #include <atomic>
@@ -45,6 +51,7 @@
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <regex>
 #include <string>
@@ -120,6 +127,7 @@ public:
         for (size_t i = 0; i < Arity; i++) {
             t[i] = arg[i];
         }
+        relation.unfreeze();
         relation.insert(t);
     }
     bool contains(const tuple& arg) const override {
@@ -235,7 +243,12 @@ public:
     void purge() {
         data = false;
     }
+    void freeze() {}
+    void unfreeze() {}
     void printHintStatistics(std::ostream& o, std::string prefix) const {}
+    std::map<std::string, std::size_t> getMemoryUsageByIndex() const {
+        return {{"flag", sizeof(data)}};
+    }
 };
 
 }  // namespace souffle
@@ -23,22 +23,21 @@
 #include "Util.h"
 #include <algorithm>
 #include <exception>
-#include <set>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace souffle {
 template <typename TupleType>
 class EquivalenceRelation {
     using value_type = typename TupleType::value_type;
 
-    // mapping from representative to disjoint set
+    // mapping from the label of a class (one of its members) to the disjoint set
     // just a cache, essentially, used for iteration over
     using StatesList = souffle::PiggyList<value_type>;
     using StatesBucket = StatesList*;
-    using StorePair = std::pair<value_type, StatesBucket>;
-    using StatesMap = souffle::LambdaBTreeSet<StorePair, std::function<StatesBucket(StorePair&)>,
-            souffle::EqrelMapComparator<StorePair>>;
+    using StatesMap = std::unordered_map<value_type, StatesBucket>;
+    using UnionPair = std::pair<value_type, value_type>;
 
 public:
     EquivalenceRelation() : statesMapStale(false){};
@@ -76,10 +75,16 @@ public:
      * @return true if the pair is new to the data structure
      */
     bool insert(value_type x, value_type y, operation_hints) {
-        // indicate that iterators will have to generate on request
-        this->statesMapStale.store(true, std::memory_order_relaxed);
         bool retval = contains(x, y);
-        sds.unionNodes(x, y);
+        if (!retval) {
+            // record the union such that the cache can catch up on request; the cache is
+            // brought up to date under the exclusive lock, which thus sees all recorded unions
+            statesLock.lock_shared();
+            sds.unionNodes(x, y);
+            pendingUnions.append({x, y});
+            this->statesMapStale.store(true, std::memory_order_relaxed);
+            statesLock.unlock_shared();
+        }
         return retval;
     }
 
@@ -90,17 +95,16 @@ public:
     void insertAll(const EquivalenceRelation<TupleType>& other) {
         other.genAllDisjointSetLists();
 
-        // iterate over partitions at a time
-        for (typename StatesMap::chunk it : other.equivalencePartition.getChunks(MAX_THREADS)) {
-            for (auto& p : it) {
-                value_type rep = p.first;
-                StatesList& pl = *p.second;
-                const size_t ksize = pl.size();
-                for (size_t i = 0; i < ksize; ++i) {
-                    this->sds.unionNodes(rep, pl.get(i));
-                }
-            }
+        // union each element with the representative of its disjoint set, batch by batch
+        std::vector<UnionPair> batch;
+        batch.reserve(UNION_BATCH_SIZE);
+        other.statesLock.lock_shared();
+        for (auto& p : other.equivalencePartition) {
+            addToBatch(batch, p.first, *p.second);
         }
+        other.statesLock.unlock_shared();
+        unionBatch(batch);
+
         // invalidate iterators unconditionally
         this->statesMapStale.store(true, std::memory_order_relaxed);
     }
@@ -118,39 +122,44 @@ public:
         this->genAllDisjointSetLists();
         other.genAllDisjointSetLists();
 
-        std::set<value_type> repsCovered;
+        // collect the disjoint sets of other
+        std::vector<std::pair<value_type, StatesBucket>> djSets;
+        other.statesLock.lock_shared();
+        for (auto& p : other.equivalencePartition) {
+            djSets.push_back(p);
+        }
+        other.statesLock.unlock_shared();
 
         // find all the disjoint sets that need to be added to this relation
         // that exist in other (and exist in this)
-        {
-            auto it = this->sds.sparseToDenseMap.begin();
-            auto end = this->sds.sparseToDenseMap.end();
-            value_type el;
-            for (; it != end; ++it) {
-                std::tie(el, std::ignore) = *it;
-                if (other.containsElement(el)) {
-                    value_type rep = other.sds.findNode(el);
-                    if (repsCovered.count(rep) == 0) {
-                        repsCovered.emplace(rep);
+        const size_t numSets = djSets.size();
+        std::vector<char> covered(numSets, 0);
+        PARALLEL_START {
+            pfor_range(i, size_t(0), numSets) {
+                const StatesList& pl = *djSets[i].second;
+                const size_t ksize = pl.size();
+                for (size_t j = 0; j < ksize; ++j) {
+                    if (this->containsElement(pl.get(j))) {
+                        covered[i] = 1;
+                        break;
                     }
                 }
             }
         }
+        PARALLEL_END
 
         // add the intersecting dj sets into this one
-        {
-            value_type el;
-            value_type rep;
-            auto it = other.sds.sparseToDenseMap.begin();
-            auto end = other.sds.sparseToDenseMap.end();
-            for (; it != end; ++it) {
-                std::tie(el, std::ignore) = *it;
-                rep = other.sds.findNode(el);
-                if (repsCovered.count(rep) != 0) {
-                    this->insert(el, rep);
-                }
+        std::vector<UnionPair> batch;
+        batch.reserve(UNION_BATCH_SIZE);
+        for (size_t i = 0; i < numSets; ++i) {
+            if (covered[i]) {
+                addToBatch(batch, djSets[i].first, *djSets[i].second);
             }
         }
+        unionBatch(batch);
+
+        // invalidate iterators unconditionally
+        this->statesMapStale.store(true, std::memory_order_relaxed);
     }
 
     /**
@@ -171,6 +180,8 @@ public:
         this->statesMapStale.store(true, std::memory_order_relaxed);
 
         equivalencePartition.clear();
+        classLabel.clear();
+        pendingUnions.clear();
     }
 
     /**
@@ -193,15 +204,26 @@ public:
         genAllDisjointSetLists();
 
         statesLock.lock_shared();
+        size_t retVal = countPairs();
+        statesLock.unlock_shared();
+        return retVal;
+    }
 
-        size_t retVal = 0;
-        for (auto& e : this->equivalencePartition) {
-            const size_t s = e.second->size();
-            retVal += s * s;
+    /**
+     * The number of bytes allocated by this relation, including the cache of its classes
+     */
+    size_t getMemoryUsage() const {
+        statesLock.lock_shared();
+
+        size_t res = sizeof(*this) - sizeof(sds) - sizeof(pendingUnions) + sds.getMemoryUsage() +
+                     pendingUnions.getMemoryUsage() + classLabel.capacity() * sizeof(value_type) +
+                     equivalencePartition.bucket_count() * sizeof(void*);
+        for (const auto& e : equivalencePartition) {
+            res += sizeof(e) + 2 * sizeof(void*) + e.second->getMemoryUsage();
         }
 
         statesLock.unlock_shared();
-        return retVal;
+        return res;
     }
 
     // an almighty iterator for several types of iteration.
@@ -419,7 +441,11 @@ public:
      */
     iterator begin() const {
         genAllDisjointSetLists();
-        return iterator(this);
+
+        statesLock.lock_shared();
+        iterator res(this);
+        statesLock.unlock_shared();
+        return res;
     }
 
     /**
@@ -492,13 +518,8 @@ public:
      * @return the iterator representing this.
      */
     iterator anteriorIt(value_type anteriorVal) const {
-        genAllDisjointSetLists();
-
         // locate the blocklist that the anterior val resides in
-        auto found = equivalencePartition.find({sds.findNode(anteriorVal), nullptr});
-        assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
-
-        return iterator(this, anteriorVal, (*found).second);
+        return iterator(this, anteriorVal, classOf(anteriorVal));
     }
 
     /**
@@ -513,13 +534,8 @@ public:
         // obv if they're in diff sets, then iteration for this pair just ends.
         if (!sds.sameSet(anteriorVal, posteriorVal)) return end();
 
-        genAllDisjointSetLists();
-
         // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(posteriorVal), nullptr});
-        assert(found != equivalencePartition.end() && "iterator called on partition that doesn't exist");
-
-        return iterator(this, anteriorVal, posteriorVal, (*found).second);
+        return iterator(this, anteriorVal, posteriorVal, classOf(posteriorVal));
     }
 
     /**
@@ -528,11 +544,8 @@ public:
      * @return an iterator that will generate all pairs within the disjoint set
      */
     iterator closure(value_type rep) const {
-        genAllDisjointSetLists();
-
         // locate the blocklist that the val resides in
-        auto found = equivalencePartition.find({sds.findNode(rep), nullptr});
-        return iterator(this, (*found).second);
+        return iterator(this, classOf(rep));
     }
 
     /**
@@ -547,33 +560,35 @@ public:
         // generate all reps
         genAllDisjointSetLists();
 
-        size_t numPairs = this->size();
-        if (numPairs == 0) return {};
-        if (numPairs == 1 || chunks <= 1) return {souffle::make_range(begin(), end())};
-
-        // if there's more dj sets than requested chunks, then just return an iter per dj set
+        statesLock.lock_shared();
         std::vector<souffle::range<iterator>> ret;
-        if (chunks <= equivalencePartition.size()) {
+        size_t numPairs = countPairs();
+        if (numPairs == 0) {
+            // no partitions
+        } else if (numPairs == 1 || chunks <= 1) {
+            ret.push_back(souffle::make_range(iterator(this), end()));
+        } else if (chunks <= equivalencePartition.size()) {
+            // if there's more dj sets than requested chunks, then just return an iter per dj set
             for (auto& p : equivalencePartition) {
-                ret.push_back(souffle::make_range(closure(p.first), end()));
+                ret.push_back(souffle::make_range(iterator(this, p.second), end()));
             }
-            return ret;
-        }
-
-        // keep it simple stupid
-        // just go through and if the size of the binrel is > numpairs/chunks, then generate an anteriorIt for
-        // each
-        const size_t perchunk = numPairs / chunks;
-        for (const auto& itp : equivalencePartition) {
-            const size_t s = itp.second->size();
-            if (s * s > perchunk) {
-                for (const auto& i : *itp.second) {
-                    ret.push_back(souffle::make_range(anteriorIt(i), end()));
+        } else {
+            // keep it simple stupid
+            // just go through and if the size of the binrel is > numpairs/chunks, then generate an
+            // anteriorIt for each
+            const size_t perchunk = numPairs / chunks;
+            for (const auto& itp : equivalencePartition) {
+                const size_t s = itp.second->size();
+                if (s * s > perchunk) {
+                    for (const auto& i : *itp.second) {
+                        ret.push_back(souffle::make_range(iterator(this, i, itp.second), end()));
+                    }
+                } else {
+                    ret.push_back(souffle::make_range(iterator(this, itp.second), end()));
                 }
-            } else {
-                ret.push_back(souffle::make_range(closure(itp.first), end()));
             }
         }
+        statesLock.unlock_shared();
 
         return ret;
     }
@@ -602,14 +617,122 @@ private:
     mutable souffle::shared_mutex statesLock;
 
     mutable StatesMap equivalencePartition;
+    // the label of the cached class of each node, indexed by its dense value
+    mutable std::vector<value_type> classLabel;
+    // the pairs unioned since the cache was last brought up to date
+    mutable souffle::PiggyList<UnionPair> pendingUnions;
     // whether the cache is stale
     mutable std::atomic<bool> statesMapStale;
 
+    // the maximum number of pairs unioned in a single parallel batch
+    static constexpr size_t UNION_BATCH_SIZE = 1 << 16;
+
+    /**
+     * Append the pairs unioning each element of the given disjoint set with its
+     * representative to the batch, flushing the batch whenever it is full.
+     * @param batch the pending pairs to be unioned
+     * @param rep the representative of the disjoint set
+     * @param elements the elements of the disjoint set
+     */
+    void addToBatch(std::vector<UnionPair>& batch, value_type rep, const StatesList& elements) {
+        const size_t ksize = elements.size();
+        for (size_t i = 0; i < ksize; ++i) {
+            batch.emplace_back(rep, elements.get(i));
+            if (batch.size() == UNION_BATCH_SIZE) {
+                unionBatch(batch);
+            }
+        }
+    }
+
     /**
-     * Generate a cache of the sets such that they can be iterated over efficiently.
-     * Each set is partitioned into a PiggyList.
+     * Union all pairs of the batch, recording them for the cache, and empty the batch.
+     * @param batch the pending pairs to be unioned
+     */
+    void unionBatch(std::vector<UnionPair>& batch) {
+        if (batch.empty()) return;
+        statesLock.lock_shared();
+        for (const auto& p : batch) {
+            pendingUnions.append(p);
+        }
+        this->sds.unionAll(batch);
+        this->statesMapStale.store(true, std::memory_order_relaxed);
+        statesLock.unlock_shared();
+        batch.clear();
+    }
+
+    /**
+     * The number of pairs of the cached disjoint sets; the lock must be held.
+     */
+    size_t countPairs() const {
+        size_t res = 0;
+        for (auto& e : this->equivalencePartition) {
+            const size_t s = e.second->size();
+            res += s * s;
+        }
+        return res;
+    }
+
+    /**
+     * Retrieve the cached disjoint set containing the given value, which must exist.
+     * The cache is brought up to date again if the value was added after its last generation.
+     */
+    StatesBucket classOf(value_type val) const {
+        for (;;) {
+            genAllDisjointSetLists();
+
+            statesLock.lock_shared();
+            const size_t dense = sds.toDense(val);
+            if (dense < classLabel.size()) {
+                auto found = equivalencePartition.find(classLabel[dense]);
+                assert(found != equivalencePartition.end() &&
+                        "iterator called on partition that doesn't exist");
+                StatesBucket res = found->second;
+                statesLock.unlock_shared();
+                return res;
+            }
+            // the node was created since, e.g. by looking it up
+            this->statesMapStale.store(true, std::memory_order_relaxed);
+            statesLock.unlock_shared();
+        }
+    }
+
+    /**
+     * Merge the two cached disjoint sets with the given labels by splicing the
+     * smaller one into the larger one; the exclusive lock must be held.
+     * Each node thus moves O(log n) times over the lifetime of the relation.
+     */
+    void mergeClasses(value_type a, value_type b) const {
+        if (a == b) return;
+
+        auto larger = equivalencePartition.find(a);
+        auto smaller = equivalencePartition.find(b);
+        if (larger->second->size() < smaller->second->size()) {
+            std::swap(larger, smaller);
+        }
+
+        const value_type label = larger->first;
+        StatesList* moved = smaller->second;
+        const size_t ksize = moved->size();
+        for (size_t i = 0; i < ksize; ++i) {
+            const value_type v = moved->get(i);
+            larger->second->append(v);
+            classLabel[sds.toDense(v)] = label;
+        }
+
+        delete moved;
+        equivalencePartition.erase(smaller);
+    }
+
+    /**
+     * Bring the cache of the sets up to date such that they can be iterated over efficiently.
+     * Each set is partitioned into a PiggyList. Rather than regenerating the cache from
+     * scratch, nodes created since the last generation are added as singleton sets and the
+     * sets joined by the recorded unions are merged.
      */
     void genAllDisjointSetLists() const {
+        // an up to date cache need not be locked exclusively; readers take the lock shared
+        if (!this->statesMapStale.load(std::memory_order_acquire)) return;
+
         statesLock.lock();
 
         // no need to generate again, already done.
@@ -618,22 +741,39 @@ private:
             return;
         }
 
-        // btree version
-        emptyPartition();
+        const size_t dSetSize = this->sds.ds.a_blocks.size();
+        if (pendingUnions.size() >= dSetSize) {
+            // replaying the unions costs more than a fresh generation
+            emptyPartition();
+            for (size_t i = 0; i < dSetSize; ++i) {
+                value_type sparseVal = this->sds.toSparse(i);
+                value_type rep = this->sds.findNode(sparseVal);
+
+                StatesBucket& mapList = equivalencePartition[rep];
+                if (mapList == nullptr) {
+                    mapList = new StatesList(1);
+                }
+                mapList->append(sparseVal);
+                classLabel.push_back(rep);
+            }
+        } else {
+            // new nodes start out in a set of their own
+            for (size_t i = classLabel.size(); i < dSetSize; ++i) {
+                value_type sparseVal = this->sds.toSparse(i);
+                auto* mapList = new StatesList(1);
+                mapList->append(sparseVal);
+                equivalencePartition[sparseVal] = mapList;
+                classLabel.push_back(sparseVal);
+            }
 
-        size_t dSetSize = this->sds.ds.a_blocks.size();
-        for (size_t i = 0; i < dSetSize; ++i) {
-            typename TupleType::value_type sparseVal = this->sds.toSparse(i);
-            parent_t rep = this->sds.findNode(sparseVal);
-
-            StorePair p = {rep, nullptr};
-            StatesList* mapList = equivalencePartition.insert(p, [&](StorePair& sp) {
-                auto* r = new StatesList(1);
-                sp.second = r;
-                return r;
-            });
-            mapList->append(sparseVal);
+            // merge the sets joined since the last generation
+            const size_t numUnions = pendingUnions.size();
+            for (size_t i = 0; i < numUnions; ++i) {
+                const UnionPair p = pendingUnions.get(i);
+                mergeClasses(classLabel[sds.toDense(p.first)], classLabel[sds.toDense(p.second)]);
+            }
         }
+        pendingUnions.clear();
 
         statesMapStale.store(false, std::memory_order_release);
         statesLock.unlock();
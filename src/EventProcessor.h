@@ -20,6 +20,7 @@
 #include <cassert>
 #include <chrono>
 #include <cstdarg>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <string>
@@ -176,6 +177,22 @@ private:
     }
 };
 
+/** hardware counts of a timing event by the name of the counted event */
+using HardwareCounts = std::map<std::string, uint64_t>;
+
+/**
+ * Add the hardware counts of a timing event to the directory of the timed rule, one size entry
+ * per counted event
+ */
+inline void addCounts(ProfileDatabase& db, std::vector<std::string> directory, const HardwareCounts* counts) {
+    directory.push_back("counters");
+    for (const auto& cur : *counts) {
+        directory.push_back(cur.first);
+        db.addSizeEntry(directory, cur.second);
+        directory.pop_back();
+    }
+}
+
 /**
  * Non-Recursive Rule Timing Profile Event Processor
  */
@@ -193,6 +210,8 @@ public:
         size_t startMaxRSS = va_arg(args, size_t);
         size_t endMaxRSS = va_arg(args, size_t);
         size_t size = va_arg(args, size_t);
+        va_arg(args, size_t);
+        const auto* counts = va_arg(args, const HardwareCounts*);
         db.addSizeEntry(
                 {"program", "relation", relation, "non-recursive-rule", rule, "maxRSS", "pre"}, startMaxRSS);
         db.addSizeEntry(
@@ -202,6 +221,7 @@ public:
         db.addDurationEntry(
                 {"program", "relation", relation, "non-recursive-rule", rule, "runtime"}, start, end);
         db.addSizeEntry({"program", "relation", relation, "non-recursive-rule", rule, "num-tuples"}, size);
+        addCounts(db, {"program", "relation", relation, "non-recursive-rule", rule}, counts);
     }
 } nonRecursiveRuleTimingProcessor;
 
@@ -244,6 +264,7 @@ public:
         size_t endMaxRSS = va_arg(args, size_t);
         size_t size = va_arg(args, size_t);
         std::string iteration = std::to_string(va_arg(args, size_t));
+        const auto* counts = va_arg(args, const HardwareCounts*);
         db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
                                 version, "maxRSS", "pre"},
                 startMaxRSS);
@@ -259,6 +280,9 @@ public:
         db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "recursive-rule", rule,
                                 version, "num-tuples"},
                 size);
+        addCounts(db,
+                {"program", "relation", relation, "iteration", iteration, "recursive-rule", rule, version},
+                counts);
     }
 } recursiveRuleTimingProcessor;
 
@@ -376,6 +400,45 @@ public:
     }
 } recursiveRelationNumberProcessor;
 
+/**
+ * Non-Recursive Relation Memory Profile Event Processor
+ */
+const class NonRecursiveRelationMemoryProcessor : public EventProcessor {
+public:
+    NonRecursiveRelationMemoryProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@m-nonrecursive-relation", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& srcLocator = signature[2];
+        const std::string& part = signature[3];
+        size_t bytes = va_arg(args, size_t);
+        db.addTextEntry({"program", "relation", relation, "source-locator"}, srcLocator);
+        db.addSizeEntry({"program", "relation", relation, "memory", part}, bytes);
+    }
+} nonRecursiveRelationMemoryProcessor;
+
+/**
+ * Recursive Relation Memory Profile Event Processor
+ */
+const class RecursiveRelationMemoryProcessor : public EventProcessor {
+public:
+    RecursiveRelationMemoryProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@m-recursive-relation", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& srcLocator = signature[2];
+        const std::string& part = signature[3];
+        size_t bytes = va_arg(args, size_t);
+        std::string iteration = std::to_string(va_arg(args, size_t));
+        db.addTextEntry({"program", "relation", relation, "source-locator"}, srcLocator);
+        db.addSizeEntry({"program", "relation", relation, "iteration", iteration, "memory", part}, bytes);
+    }
+} recursiveRelationMemoryProcessor;
+
 /**
  * Recursive Relation Copy Timing Profile Event Processor
  */
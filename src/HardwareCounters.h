@@ -0,0 +1,134 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HardwareCounters.h
+ *
+ * Hardware performance counters read by the loggers of a profile.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace souffle {
+
+/**
+ * The hardware counters count the cycles, instructions and last-level cache misses of the program,
+ * so that a logger records them next to the time spent on a rule or an iteration of it.
+ *
+ * The counters are opened with perf_event_open and count the user-space events of the thread which
+ * starts them and of the threads it creates afterwards, so they are started before the evaluation
+ * creates its worker threads. An event the kernel or the processor does not count, e.g. in a
+ * container or a virtual machine, is left out, and without any event the profile has no counts.
+ *
+ * The counters are implemented as a singleton.
+ */
+class HardwareCounters {
+public:
+    /** counts of the events by their name */
+    using Counts = std::map<std::string, uint64_t>;
+
+    ~HardwareCounters() {
+        stop();
+    }
+
+    /** get singleton */
+    static HardwareCounters& instance() {
+        static HardwareCounters singleton;
+        return singleton;
+    }
+
+    /**
+     * Open the counters of the available events, warning if there are none.
+     * @return whether any event is counted
+     */
+    bool start() {
+        stop();
+#ifdef __linux__
+        const std::vector<std::pair<std::string, uint64_t>> hardwareEvents = {
+                {"cycles", PERF_COUNT_HW_CPU_CYCLES}, {"instructions", PERF_COUNT_HW_INSTRUCTIONS},
+                {"llc-misses", PERF_COUNT_HW_CACHE_MISSES}};
+        for (const auto& event : hardwareEvents) {
+            struct perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = event.second;
+            attr.inherit = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fd >= 0) {
+                events.emplace_back(event.first, fd);
+            }
+        }
+#endif
+        if (events.empty()) {
+            std::cerr << "Warning: hardware performance counters are not available, the profile is "
+                         "recorded without them.\n";
+        }
+        return !events.empty();
+    }
+
+    /** close the counters */
+    void stop() {
+#ifdef __linux__
+        for (const auto& event : events) {
+            close(event.second);
+        }
+#endif
+        events.clear();
+    }
+
+    /** check whether any event is counted */
+    bool isCounting() const {
+        return !events.empty();
+    }
+
+    /** read the counts of the events so far */
+    Counts read() const {
+        Counts counts;
+#ifdef __linux__
+        for (const auto& event : events) {
+            // count, time enabled, time running
+            uint64_t values[3];
+            if (::read(event.second, values, sizeof(values)) != sizeof(values)) {
+                continue;
+            }
+            // scale the count of an event which shared a counter with other events
+            if (values[2] != 0 && values[2] < values[1]) {
+                values[0] = static_cast<uint64_t>(static_cast<double>(values[0]) * values[1] / values[2]);
+            }
+            counts[event.first] = values[0];
+        }
+#endif
+        return counts;
+    }
+
+private:
+    HardwareCounters() = default;
+
+    /** file descriptors of the counted events by their name */
+    std::vector<std::pair<std::string, int>> events;
+};
+
+}  // end of namespace souffle
@@ -0,0 +1,218 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashIndex.h
+ *
+ * A hash-based index for relations which are only searched by equality
+ * on a fixed set of columns.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+#include "Util.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A hash index grouping tuples by the values of the given key columns.
+ *
+ * Tuples with the same key are stored in one bucket, such that the tuples
+ * matching a key can be enumerated and tested for existence in constant
+ * expected time. The index is split into shards with their own lock, such
+ * that concurrent inserts only contend when they hit the same shard. As for
+ * the other relation data structures, lookups must not overlap with inserts.
+ *
+ * If the key covers all columns, the index is a set, i.e., duplicates are
+ * rejected by insert. Otherwise it is a multiset of the inserted tuples.
+ *
+ * @tparam Tuple the type of the indexed tuples
+ * @tparam Columns the key columns
+ */
+template <typename Tuple, unsigned... Columns>
+class HashIndex {
+    static_assert(sizeof...(Columns) > 0, "hash index requires at least one key column");
+
+    using value_type = typename Tuple::value_type;
+    using bucket = std::vector<Tuple>;
+
+    /** whether the key covers all columns of the tuples */
+    static constexpr bool isSet = sizeof...(Columns) == Tuple::arity;
+
+    /** the number of shards, a power of two */
+    static constexpr std::size_t NUM_SHARDS = 64;
+
+    /** hash the key columns of a tuple */
+    struct key_hash {
+        std::size_t operator()(const Tuple& t) const {
+            const unsigned columns[] = {Columns...};
+            std::size_t seed = 0;
+            for (unsigned column : columns) {
+                seed ^= std::hash<value_type>()(t[column]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            }
+            return seed;
+        }
+    };
+
+    /** compare the key columns of two tuples */
+    struct key_equal {
+        bool operator()(const Tuple& a, const Tuple& b) const {
+            const unsigned columns[] = {Columns...};
+            for (unsigned column : columns) {
+                if (a[column] != b[column]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /** a part of the index, covering the keys with the same shard number */
+    struct Shard {
+        Lock lock;
+        std::unordered_map<Tuple, bucket, key_hash, key_equal> buckets;
+        std::size_t size = 0;
+    };
+
+    Shard shards[NUM_SHARDS];
+
+    /** select the shard of a key, mixing the hash value as the buckets use its low bits */
+    static std::size_t getShard(const Tuple& t) {
+        uint64_t h = key_hash()(t);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h >> 58) & (NUM_SHARDS - 1);
+    }
+
+    static const bucket& emptyBucket() {
+        static const bucket none;
+        return none;
+    }
+
+public:
+    using iterator = typename bucket::const_iterator;
+
+    /**
+     * Operation hints are not required for hash lookups; the type is provided
+     * for compatibility with the other index data structures.
+     */
+    struct operation_hints {
+        void clear() {}
+    };
+
+    /**
+     * Insert the given tuple.
+     * @return false if the index is a set and already contains the tuple
+     */
+    bool insert(const Tuple& t) {
+        Shard& shard = shards[getShard(t)];
+        auto lease = shard.lock.acquire();
+        (void)lease;
+        bucket& cur = shard.buckets[t];
+        if (isSet && !cur.empty()) {
+            return false;
+        }
+        cur.push_back(t);
+        shard.size++;
+        return true;
+    }
+
+    bool insert(const Tuple& t, operation_hints&) {
+        return insert(t);
+    }
+
+    /** Insert all tuples of the given index */
+    void insertAll(const HashIndex& other) {
+        for (const Shard& shard : other.shards) {
+            for (const auto& cur : shard.buckets) {
+                for (const Tuple& t : cur.second) {
+                    insert(t);
+                }
+            }
+        }
+    }
+
+    /** Check whether the given tuple is contained */
+    bool contains(const Tuple& t) const {
+        for (const Tuple& cur : find(t)) {
+            if (cur == t) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains(const Tuple& t, operation_hints&) const {
+        return contains(t);
+    }
+
+    /** Obtain the tuples agreeing with the given tuple on the key columns */
+    range<iterator> equalRange(const Tuple& t) const {
+        const bucket& cur = find(t);
+        return make_range(cur.begin(), cur.end());
+    }
+
+    range<iterator> equalRange(const Tuple& t, operation_hints&) const {
+        return equalRange(t);
+    }
+
+    std::size_t size() const {
+        std::size_t res = 0;
+        for (const Shard& shard : shards) {
+            res += shard.size;
+        }
+        return res;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /** The number of bytes allocated by this index, estimating the nodes of the hash maps */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this);
+        for (const Shard& shard : shards) {
+            res += shard.buckets.bucket_count() * sizeof(void*);
+            for (const auto& cur : shard.buckets) {
+                res += sizeof(cur) + 2 * sizeof(void*) + cur.second.capacity() * sizeof(Tuple);
+            }
+        }
+        return res;
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            shard.buckets.clear();
+            shard.size = 0;
+        }
+    }
+
+    /** The index has no read-only representation; provided for compatibility with b-trees */
+    void freeze() {}
+
+    void unfreeze() {}
+
+private:
+    const bucket& find(const Tuple& t) const {
+        const Shard& shard = shards[getShard(t)];
+        auto pos = shard.buckets.find(t);
+        return (pos == shard.buckets.end()) ? emptyBucket() : pos->second;
+    }
+};
+
+}  // end of namespace souffle
@@ -19,6 +19,7 @@
 #include "BinaryConstraintOps.h"
 #include "FunctorOps.h"
 #include "Global.h"
+#include "HardwareCounters.h"
 #include "IODirectives.h"
 #include "IOSystem.h"
 #include "LVMIndex.h"
@@ -99,7 +100,15 @@ void LVM::executeMain() {
         visitDepthFirst(main, [&](const RamQuery& rule) { ++ruleCount; });
         ProfileEventSingleton::instance().makeConfigRecord("ruleCount", std::to_string(ruleCount));
 
+        if (Global::config().has("profile-sampling")) {
+            ProfileSampler::instance().start(std::stoi(Global::config().get("profile-sampling")));
+        }
+        if (Global::config().has("profile-counters")) {
+            HardwareCounters::instance().start();
+        }
         execute(mainProgram, ctxt);
+        ProfileSampler::instance().stop();
+        HardwareCounters::instance().stop();
         ProfileEventSingleton::instance().stopTimer();
         for (auto const& cur : frequencies) {
             for (auto const& iter : cur.second) {
@@ -575,7 +584,7 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 const std::string& relName = rel.getName();
                 size_t arity = rel.getArity();
 
-                if (Global::config().has("profile") && !(relName[0] == '@')) {
+                if (countOperations && !(relName[0] == '@')) {
                     this->reads[relName]++;
                 }
 
@@ -668,7 +677,7 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 ip += 1;
                 break;
             case LVM_Search: {
-                if (Global::config().has("profile") && code[ip + 1] != 0) {
+                if (countOperations && code[ip + 1] != 0) {
                     std::string msg = symbolTable.resolve(code[ip + 2]);
                     this->frequencies[msg][this->getIterationNumber()]++;
                 }
@@ -694,7 +703,7 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 break;
             }
             case LVM_Filter:
-                if (Global::config().has("profile")) {
+                if (countOperations) {
                     std::string msg = symbolTable.resolve(code[ip + 1]);
                     if (!msg.empty()) {
                         this->frequencies[msg][this->getIterationNumber()]++;
@@ -790,9 +799,15 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 size_t timerIndex = code[ip + 2];
                 size_t relId = code[ip + 3];
                 const LVMRelation& rel = *getRelation(relId);
-                Logger* logger = new Logger(
-                        msg.c_str(), this->getIterationNumber(), std::bind(&LVMRelation::size, &rel));
-                insertTimerAt(timerIndex, logger);
+                if (Global::config().has("profile-sampling")) {
+                    auto& frame = ProfileSampler::instance().getFrame(msg);
+                    insertScopeAt(timerIndex,
+                            new ProfileSampler::Scope(frame, std::bind(&LVMRelation::size, &rel)));
+                } else {
+                    Logger* logger = new Logger(
+                            msg.c_str(), this->getIterationNumber(), std::bind(&LVMRelation::size, &rel));
+                    insertTimerAt(timerIndex, logger);
+                }
                 ip += 4;
                 break;
             }
@@ -838,6 +853,8 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
 
                 if (code[ip + 3] == LVM_EQREL) {
                     res = std::make_unique<LVMEqRelation>(arity, &orderSet, relName);
+                } else if (code[ip + 3] == LVM_BITMAP) {
+                    res = std::make_unique<LVMBitmapRelation>(arity, &orderSet, relName);
                 } else {
                     res = std::make_unique<LVMRelation>(arity, &orderSet, relName);
                 }
@@ -873,6 +890,15 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 ip += 3;
                 break;
             }
+            case LVM_LogMemory: {
+                size_t relId = code[ip + 1];
+                auto relPtr = getRelation(relId);
+                std::string msg = symbolTable.resolve(code[ip + 2]);
+                ProfileEventSingleton::instance().makeMemoryEvent(
+                        msg, relPtr->getMemoryUsageByIndex(), this->getIterationNumber());
+                ip += 3;
+                break;
+            }
             case LVM_Load: {
                 size_t relId = code[ip + 1];
                 auto IOs = codeStream->getIODirectives()[code[ip + 2]];
@@ -979,6 +1005,8 @@ void LVM::execute(std::unique_ptr<LVMCode>& codeStream, LVMContext& ctxt, size_t
                 break;
             };
             case LVM_Aggregate_COUNT: {
+                // the range is counted sequentially: a range of a B-tree can only be split among
+                // threads by walking it, which costs as much as counting it
                 RamDomain res = 0;
                 RamDomain idx = code[ip + 1];
                 auto& iter = iteratorPool[idx];
@@ -16,12 +16,14 @@
 
 #pragma once
 
+#include "Global.h"
 #include "LVMCode.h"
 #include "LVMContext.h"
 #include "LVMGenerator.h"
 #include "LVMInterface.h"
 #include "LVMRelation.h"
 #include "Logger.h"
+#include "ProfileSampler.h"
 #include "RamTranslationUnit.h"
 #include "RamTypes.h"
 #include "RelationRepresentation.h"
@@ -50,6 +52,9 @@ class LVMProgInterface;
 class LVM : public LVMInterface {
 public:
     LVM(RamTranslationUnit& tUnit) : LVMInterface(tUnit) {
+        // a sampling profile leaves the operations uncounted to keep its overhead low
+        countOperations = Global::config().has("profile") && !Global::config().has("profile-sampling");
+
         // Construct mapping from relation Name to RamRelation node in RAM tree.
         // This will later be used for fast lookup during RamRelationCreate in order to retrieve
         // minIndexSet from a given relation.
@@ -62,6 +67,9 @@ public:
         for (auto* timer : timers) {
             delete timer;
         }
+        for (auto* scope : scopes) {
+            delete scope;
+        }
     }
 
     /** Execute the main program */
@@ -118,11 +126,25 @@ protected:
         timers[index] = timer;
     }
 
-    /** Stop and destroy logger */
+    /** Insert scope of the sampling profiler */
+    void insertScopeAt(size_t index, ProfileSampler::Scope* scope) {
+        if (index >= scopes.size()) {
+            scopes.resize((index + 1), nullptr);
+        }
+        scopes[index] = scope;
+    }
+
+    /** Stop and destroy logger or scope */
     void stopTimerAt(size_t index) {
-        assert(index < timers.size());
-        delete timers[index];
-        timers[index] = nullptr;
+        assert(index < timers.size() || index < scopes.size());
+        if (index < timers.size()) {
+            delete timers[index];
+            timers[index] = nullptr;
+        }
+        if (index < scopes.size()) {
+            delete scopes[index];
+            scopes[index] = nullptr;
+        }
     }
 
     /** Get symbol table */
@@ -222,6 +244,12 @@ private:
     /** List of loggers for logtimer */
     std::vector<Logger*> timers;
 
+    /** List of scopes for logtimer, when the profile samples rather than times rules */
+    std::vector<ProfileSampler::Scope*> scopes;
+
+    /** whether tuples and existence checks are counted for the profile */
+    bool countOperations = false;
+
     /** counter for $ operator */
     int counter = 0;
 
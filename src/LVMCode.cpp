@@ -379,6 +379,12 @@ void LVMCode::print() const {
                 ip += 3;
                 break;
             }
+            case LVM_LogMemory: {
+                printf("%ld\tLVM_LogMemory\t\n", ip);
+                printf("\t%s\t\n", symbolTable.resolve(code[ip + 1]).c_str());
+                ip += 3;
+                break;
+            }
             case LVM_Load: {
                 printf("%ld\tLVM_Load\t\n", ip);
                 printf("\t%s\t IODirectivesID:%d\n", symbolTable.resolve(code[ip + 1]).c_str(), code[ip + 2]);
@@ -116,6 +116,7 @@ enum LVM_Type {
     LVM_Clear,
     LVM_Drop,
     LVM_LogSize,
+    LVM_LogMemory,
     LVM_Load,
     LVM_Store,
     LVM_Fact,
@@ -134,6 +135,7 @@ enum LVM_Type {
     LVM_BTREE,
     LVM_BRIE,
     LVM_EQREL,
+    LVM_BITMAP,
     LVM_DEFAULT,
 
     LVM_ITER_InitFullIndex,
@@ -939,6 +939,8 @@ protected:
         code->push_back(create.getRelation().getArity());
         switch (create.getRelation().getRepresentation()) {
             case RelationRepresentation::BTREE:
+            // hash indices are only used by the synthesiser
+            case RelationRepresentation::HASH:
                 code->push_back(LVM_BTREE);
                 break;
             case RelationRepresentation::BRIE:
@@ -947,6 +949,9 @@ protected:
             case RelationRepresentation::EQREL:
                 code->push_back(LVM_EQREL);
                 break;
+            case RelationRepresentation::BITMAP:
+                code->push_back(LVM_BITMAP);
+                break;
             case RelationRepresentation::DEFAULT:
                 code->push_back(LVM_DEFAULT);
             default:
@@ -975,6 +980,12 @@ protected:
         code->push_back(symbolTable.lookup(size.getMessage()));
     }
 
+    void visitLogMemory(const RamLogMemory& memory, size_t exitAddress) override {
+        code->push_back(LVM_LogMemory);
+        code->push_back(relationEncoder.encodeRelation(memory.getRelation().getName()));
+        code->push_back(symbolTable.lookup(memory.getMessage()));
+    }
+
     void visitLoad(const RamLoad& load, size_t exitAddress) override {
         code->push_back(LVM_Load);
         code->push_back(relationEncoder.encodeRelation(load.getRelation().getName()));
@@ -107,6 +107,11 @@ public:
         operation_hints.clear();
     }
 
+    /** number of bytes allocated by the index */
+    size_t getMemoryUsage() const {
+        return set.getMemoryUsage();
+    }
+
     /** enables the index to be printed */
     void print(std::ostream& out) const {
         set.printStats(out);
@@ -15,9 +15,14 @@
  ***********************************************************************/
 
 #include "LVMRecords.h"
+#include "ParallelUtils.h"
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <functional>
 #include <limits>
-#include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace souffle {
@@ -28,48 +33,137 @@ using namespace std;
 
 /**
  * A bidirectional mapping between tuples and reference indices.
+ *
+ * The tuples are stored back to back in an arena of blocks doubling in size,
+ * which are never moved, such that unpacking requires no synchronisation. The
+ * references are indexed by an open-addressing hash table comparing the given
+ * tuple with the arena in place, such that packing allocates no memory unless
+ * a new tuple is added. Lookups are carried out concurrently; a write lock is
+ * only taken to add a tuple.
  */
 class LVMRecordMap {
+    /** The number of tuples in the first block of the arena is 2^BLOCK_BITS */
+    static const size_t BLOCK_BITS = 10;
+
+    /** The number of tuples in the first block of the arena */
+    static const size_t FIRST_BLOCK_SIZE = 1 << BLOCK_BITS;
+
+    /** The number of blocks, sufficient to cover all non-negative indices */
+    static const size_t NUM_BLOCKS = numeric_limits<RamDomain>::digits + 1;
+
     /** The arity of the stored tuples */
-    int arity;
+    const size_t arity;
+
+    /** The mapping from indices to tuples, block i holds FIRST_BLOCK_SIZE * 2^i tuples */
+    atomic<RamDomain*> blocks[NUM_BLOCKS];
+
+    /** The number of stored tuples, index 0 is left free for the Nil element */
+    size_t size = 0;
+
+    /** The mapping from tuples to references/indices; a power of two slots, 0 marks empty slots */
+    vector<RamDomain> r2i;
 
-    /** The mapping from tuples to references/indices */
-    map<vector<RamDomain>, RamDomain> r2i;
+    /** A lock for the pack operation */
+    ReadWriteLock lock;
 
-    /** The mapping from indices to tuples */
-    vector<vector<RamDomain>> i2r;
+    /** Compute the hash value of the given tuple */
+    size_t hash(const RamDomain* tuple) const {
+        size_t seed = 0;
+        for (size_t i = 0; i < arity; i++) {
+            seed ^= std::hash<RamDomain>()(tuple[i]) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        // mix the bits, as the slots are selected by the low bits
+        seed ^= seed >> 29;
+        seed *= 0xbf58476d1ce4e5b9ULL;
+        seed ^= seed >> 32;
+        return seed;
+    }
+
+    /** Obtain the address of the tuple with the given index in the arena */
+    RamDomain* getTuple(size_t index) const {
+        size_t pos = index + FIRST_BLOCK_SIZE;
+        size_t block = (63 - __builtin_clzll(pos)) - BLOCK_BITS;
+        size_t offset = pos - (FIRST_BLOCK_SIZE << block);
+        return blocks[block].load(memory_order_acquire) + offset * arity;
+    }
+
+    /** Find the slot of the given tuple, or the empty slot it would be stored in */
+    size_t find(const RamDomain* tuple) const {
+        size_t mask = r2i.size() - 1;
+        for (size_t slot = hash(tuple) & mask;; slot = (slot + 1) & mask) {
+            RamDomain index = r2i[slot];
+            if (index == 0 || equal(tuple, tuple + arity, getTuple(index))) {
+                return slot;
+            }
+        }
+    }
+
+    /** Double the number of slots of the hash table */
+    void grow() {
+        vector<RamDomain> old(r2i.size() * 2, 0);
+        r2i.swap(old);
+        for (RamDomain index : old) {
+            if (index != 0) {
+                r2i[find(getTuple(index))] = index;
+            }
+        }
+    }
 
 public:
-    LVMRecordMap(int arity) : arity(arity), i2r(1) {}  // note: index 0 element left free
+    LVMRecordMap(int arity) : arity(arity), r2i(FIRST_BLOCK_SIZE, 0) {
+        for (auto& block : blocks) {
+            block.store(nullptr, memory_order_relaxed);
+        }
+    }
+
+    LVMRecordMap(const LVMRecordMap&) = delete;
+    LVMRecordMap& operator=(const LVMRecordMap&) = delete;
+
+    ~LVMRecordMap() {
+        for (auto& block : blocks) {
+            delete[] block.load(memory_order_relaxed);
+        }
+    }
 
     /**
      * Packs the given tuple -- and may create a new reference if necessary.
      */
     RamDomain pack(const RamDomain* tuple) {
-        vector<RamDomain> tmp(arity);
-        for (int i = 0; i < arity; i++) {
-            tmp[i] = tuple[i];
+        // try lookup, which may be carried out concurrently
+        lock.start_read();
+        RamDomain index = r2i[find(tuple)];
+        lock.end_read();
+        if (index != 0) {
+            return index;
         }
 
-        RamDomain index;
-#pragma omp critical(record_pack)
-        {
-            auto pos = r2i.find(tmp);
-            if (pos != r2i.end()) {
-                index = pos->second;
-            } else {
-#pragma omp critical(record_unpack)
-                {
-                    i2r.push_back(tmp);
-                    index = i2r.size() - 1;
-                    r2i[tmp] = index;
-
-                    // assert that new index is smaller than the range
-                    assert(index != std::numeric_limits<RamDomain>::max());
-                }
+        lock.start_write();
+
+        // the tuple may have been added in the meantime
+        size_t slot = find(tuple);
+        index = r2i[slot];
+        if (index == 0) {
+            index = ++size;
+
+            // assert that new index is smaller than the range
+            assert(size < static_cast<size_t>(numeric_limits<RamDomain>::max()));
+
+            // copy the tuple into the arena, allocating a new block if required
+            size_t pos = size + FIRST_BLOCK_SIZE;
+            size_t block = (63 - __builtin_clzll(pos)) - BLOCK_BITS;
+            if (blocks[block].load(memory_order_relaxed) == nullptr) {
+                blocks[block].store(new RamDomain[(FIRST_BLOCK_SIZE << block) * arity], memory_order_release);
+            }
+            copy(tuple, tuple + arity, getTuple(index));
+            r2i[slot] = index;
+
+            // keep the load factor of the hash table at most 1/2
+            if (2 * size > r2i.size()) {
+                grow();
             }
         }
 
+        lock.end_write();
         return index;
     }
 
@@ -77,12 +171,67 @@ public:
      * Obtains a pointer to the tuple addressed by the given index.
      */
     RamDomain* unpack(RamDomain index) {
-        RamDomain* res;
+        return getTuple(index);
+    }
+};
+
+/**
+ * The record maps of all arities, created on demand by concurrent packs. The maps of small
+ * arities are installed into a fixed table by a compare-and-swap, such that looking them up
+ * takes no lock; the maps of larger arities are created and looked up under a mutex.
+ */
+class LVMRecordMaps {
+    /** The number of arities of the fixed table */
+    static const size_t NUM_SMALL = 64;
+
+    /** The maps of small arities, indexed by arity */
+    atomic<LVMRecordMap*> small[NUM_SMALL];
+
+    /** The maps of larger arities, indexed by arity minus NUM_SMALL */
+    vector<std::unique_ptr<LVMRecordMap>> large;
 
-#pragma omp critical(record_unpack)
-        res = &(i2r[index][0]);
+    /** A lock for the maps of larger arities */
+    std::mutex largeLock;
 
-        return res;
+public:
+    LVMRecordMaps() {
+        for (auto& map : small) {
+            map.store(nullptr, memory_order_relaxed);
+        }
+    }
+
+    ~LVMRecordMaps() {
+        for (auto& map : small) {
+            delete map.load(memory_order_relaxed);
+        }
+    }
+
+    /** Obtain the map of the given arity, creating it if required */
+    LVMRecordMap& get(int arity) {
+        if (static_cast<size_t>(arity) < NUM_SMALL) {
+            atomic<LVMRecordMap*>& slot = small[arity];
+            LVMRecordMap* map = slot.load(memory_order_acquire);
+            if (map == nullptr) {
+                // the map installed first wins, such that no pack is lost
+                auto* created = new LVMRecordMap(arity);
+                if (slot.compare_exchange_strong(map, created, memory_order_acq_rel)) {
+                    map = created;
+                } else {
+                    delete created;
+                }
+            }
+            return *map;
+        }
+
+        std::lock_guard<std::mutex> guard(largeLock);
+        const size_t pos = arity - NUM_SMALL;
+        if (large.size() <= pos) {
+            large.resize(pos + 1);
+        }
+        if (!large[pos]) {
+            large[pos].reset(new LVMRecordMap(arity));
+        }
+        return *large[pos];
     }
 };
 
@@ -90,18 +239,8 @@ public:
  * The static access function for record maps of certain arities.
  */
 LVMRecordMap& getForArity(int arity) {
-    // the static container -- filled on demand
-    static map<int, LVMRecordMap> maps;
-
-    // get container if present
-    auto pos = maps.find(arity);
-    if (pos != maps.end()) {
-        return pos->second;
-    }
-
-    // create new container if required
-    maps.emplace(arity, arity);
-    return getForArity(arity);
+    static LVMRecordMaps maps;
+    return maps.get(arity);
 }
 }  // namespace
 
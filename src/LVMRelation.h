@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "Brie.h"
 #include "LVMIndex.h"
 #include "ParallelUtils.h"
 #include "RamIndexAnalysis.h"
@@ -81,6 +82,16 @@ public:
         return num_tuples;
     }
 
+    /** Gets the number of bytes allocated by the blocks of tuples and by each index */
+    virtual std::map<std::string, size_t> getMemoryUsageByIndex() const {
+        std::map<std::string, size_t> res;
+        res["tuples"] = blockList.size() * BLOCK_SIZE * sizeof(RamDomain);
+        for (const auto& index : indices) {
+            res[toString(index.order())] = index.getMemoryUsage();
+        }
+        return res;
+    }
+
     /** Insert tuple */
     virtual void insert(const RamDomain* tuple) {
         assert(tuple);
@@ -90,32 +101,7 @@ public:
             return;
         }
 
-        // check for null-arity
-        if (arity == 0) {
-            indices[0].insert(tuple);
-            num_tuples = 1;
-            return;
-        }
-
-        int blockIndex = num_tuples / (BLOCK_SIZE / arity);
-        int tupleIndex = (num_tuples % (BLOCK_SIZE / arity)) * arity;
-
-        if (tupleIndex == 0) {
-            blockList.push_back(std::make_unique<RamDomain[]>(BLOCK_SIZE));
-        }
-
-        RamDomain* newTuple = &blockList[blockIndex][tupleIndex];
-        for (size_t i = 0; i < arity; ++i) {
-            newTuple[i] = tuple[i];
-        }
-
-        // update all indexes with new tuple
-        for (auto& cur : indices) {
-            cur.insert(newTuple);
-        }
-
-        // increment relation size
-        num_tuples++;
+        append(tuple);
     }
 
     /** Merge another relation into this relation */
@@ -127,7 +113,7 @@ public:
     }
 
     /** Purge table */
-    void purge() {
+    virtual void purge() {
         blockList.clear();
         for (auto& cur : indices) {
             cur.purge();
@@ -155,7 +141,7 @@ public:
     }
 
     /** check whether a tuple exists in the relation */
-    bool exists(const RamDomain* tuple) const {
+    virtual bool exists(const RamDomain* tuple) const {
         LVMIndex* index = getIndex(getTotalIndexKey());
         return index->exists(tuple);
     }
@@ -192,6 +178,41 @@ public:
     /** Extend relation */
     virtual void extend(const LVMRelation& rel) {}
 
+protected:
+    /**
+     * Append a tuple to this relation and update all indices
+     *
+     * precondition: tuple does not exist in the relation
+     */
+    void append(const RamDomain* tuple) {
+        // check for null-arity
+        if (arity == 0) {
+            indices[0].insert(tuple);
+            num_tuples = 1;
+            return;
+        }
+
+        int blockIndex = num_tuples / (BLOCK_SIZE / arity);
+        int tupleIndex = (num_tuples % (BLOCK_SIZE / arity)) * arity;
+
+        if (tupleIndex == 0) {
+            blockList.push_back(std::make_unique<RamDomain[]>(BLOCK_SIZE));
+        }
+
+        RamDomain* newTuple = &blockList[blockIndex][tupleIndex];
+        for (size_t i = 0; i < arity; ++i) {
+            newTuple[i] = tuple[i];
+        }
+
+        // update all indexes with new tuple
+        for (auto& cur : indices) {
+            cur.insert(newTuple);
+        }
+
+        // increment relation size
+        num_tuples++;
+    }
+
 private:
     /** Arity of relation */
     const size_t arity;
@@ -297,4 +318,52 @@ public:
     }
 };
 
+/**
+ * Interpreter Bitmap Relation
+ *
+ * A unary relation tracking its members in a sparse bit-map. Tuples are still
+ * appended to the relation to provide stable tuple pointers for scans, but
+ * membership tests and duplicate elimination are answered by the bit-map.
+ */
+class LVMBitmapRelation : public LVMRelation {
+public:
+    LVMBitmapRelation(size_t relArity, const MinIndexSelection* orderSet, std::string relName)
+            : LVMRelation(relArity, orderSet, relName) {
+        assert(relArity == 1 && "bitmap relation not unary");
+    }
+
+    /** Insert tuple */
+    void insert(const RamDomain* tuple) override {
+        assert(tuple);
+
+        // set the bit, skip the tuple if it has been set before
+        if (!members.set(tuple[0])) {
+            return;
+        }
+
+        append(tuple);
+    }
+
+    /** Purge table */
+    void purge() override {
+        LVMRelation::purge();
+        members.clear();
+    }
+
+    /** check whether a tuple exists in the relation */
+    bool exists(const RamDomain* tuple) const override {
+        return members.test(tuple[0]);
+    }
+
+    std::map<std::string, size_t> getMemoryUsageByIndex() const override {
+        auto res = LVMRelation::getMemoryUsageByIndex();
+        res["bit-map"] = members.getMemoryUsage();
+        return res;
+    }
+
+private:
+    /** Bit-map of the contained values */
+    SparseBitMap<> members;
+};
+
 }  // end of namespace souffle
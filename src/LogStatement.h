@@ -54,6 +54,14 @@ public:
         return line.str();
     }
 
+    static const std::string mNonrecursiveRelation(
+            const std::string& relationName, const SrcLocation& srcLocation) {
+        const char* messageType = "@m-nonrecursive-relation";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << srcLocation << ";";
+        return line.str();
+    }
+
     static const std::string tNonrecursiveRule(
             const std::string& relationName, const SrcLocation& srcLocation, const std::string& datalogText) {
         const char* messageType = "@t-nonrecursive-rule";
@@ -104,6 +112,14 @@ public:
         return line.str();
     }
 
+    static const std::string mRecursiveRelation(
+            const std::string& relationName, const SrcLocation& srcLocation) {
+        const char* messageType = "@m-recursive-relation";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << srcLocation << ";";
+        return line.str();
+    }
+
     static const std::string cRecursiveRelation(
             const std::string& relationName, const SrcLocation& srcLocation) {
         const char* messageType = "@c-recursive-relation";
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "HardwareCounters.h"
 #include "ParallelUtils.h"
 #include "ProfileEvent.h"
 
@@ -44,16 +45,26 @@ public:
         struct rusage ru {};
         getrusage(RUSAGE_SELF, &ru);
         startMaxRSS = ru.ru_maxrss;
+        if (HardwareCounters::instance().isCounting()) {
+            startCounts = HardwareCounters::instance().read();
+        }
         // Assume that if we are logging the progress of an event then we care about usage during that time.
         ProfileEventSingleton::instance().resetTimerInterval();
     }
 
     ~Logger() {
+        HardwareCounters::Counts counts;
+        if (!startCounts.empty()) {
+            for (const auto& cur : HardwareCounters::instance().read()) {
+                const uint64_t startCount = startCounts[cur.first];
+                counts[cur.first] = cur.second > startCount ? cur.second - startCount : 0;
+            }
+        }
         struct rusage ru {};
         getrusage(RUSAGE_SELF, &ru);
         size_t endMaxRSS = ru.ru_maxrss;
         ProfileEventSingleton::instance().makeTimingEvent(
-                label, start, now(), startMaxRSS, endMaxRSS, size() - preSize, iteration);
+                label, start, now(), startMaxRSS, endMaxRSS, size() - preSize, iteration, counts);
     }
 
 private:
@@ -63,5 +74,6 @@ private:
     size_t iteration;
     std::function<size_t()> size;
     size_t preSize;
+    HardwareCounters::Counts startCounts;
 };
 }  // end of namespace souffle
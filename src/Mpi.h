@@ -16,7 +16,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <set>
@@ -261,6 +264,90 @@ inline Status iprobe(const Status& status) {
 }
 }  // namespace
 
+/* chunks */
+namespace {
+
+/** The number of bytes of the tuples sent in one message when transferring a relation */
+constexpr std::size_t CHUNK_BYTES = 1 << 16;
+
+/** The formats of a chunk, given by its first byte */
+enum : char { RAW_CHUNK = 0, VARINT_CHUNK = 1 };
+
+/** The number of tuples of the given arity sent in one message */
+template <typename R>
+inline std::size_t chunkTuples(const std::size_t length) {
+    return std::max<std::size_t>(1, CHUNK_BYTES / (length * sizeof(R)));
+}
+
+/** The maximal size of a message holding a chunk of tuples of the given arity */
+template <typename R>
+inline int chunkCapacity(const std::size_t length) {
+    return (int)(1 + chunkTuples<R>(length) * length * sizeof(R));
+}
+
+/**
+ * Encodes a chunk of tuples, given column by column in a flat list of values. Every value is encoded as
+ * the zig-zag varint of its difference to the value of the same column in the previous tuple, which is
+ * small for the leading columns of tuples sent in order. The values are copied as they are if that is
+ * smaller.
+ */
+template <typename R>
+inline void encodeChunk(const std::vector<R>& values, const std::size_t length, std::vector<char>& chunk) {
+    chunk.clear();
+    chunk.push_back(VARINT_CHUNK);
+    std::vector<R> previous(length);
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        const int64_t delta = (int64_t)values[i] - (int64_t)previous[i % length];
+        previous[i % length] = values[i];
+        uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+        while (zigzag >= 0x80) {
+            chunk.push_back((char)((zigzag & 0x7f) | 0x80));
+            zigzag >>= 7;
+        }
+        chunk.push_back((char)zigzag);
+    }
+    const std::size_t rawSize = 1 + values.size() * sizeof(R);
+    if (chunk.size() >= rawSize) {
+        chunk.resize(rawSize);
+        chunk[0] = RAW_CHUNK;
+        std::copy_n(reinterpret_cast<const char*>(values.data()), rawSize - 1, chunk.begin() + 1);
+    }
+}
+
+/** Decodes a chunk of tuples encoded by encodeChunk, and inserts them into the given relation */
+template <typename R, typename T>
+inline void decodeChunk(const std::vector<char>& chunk, const int size, const std::size_t length, T& data) {
+    assert(size > 0);
+    auto element = std::unique_ptr<R[]>(new R[length]());
+    const auto* ptr = element.get();
+    if (chunk[0] == RAW_CHUNK) {
+        for (int position = 1; position < size; position += (int)(length * sizeof(R))) {
+            std::copy_n(&chunk[position], length * sizeof(R), reinterpret_cast<char*>(element.get()));
+            data.insert(ptr);
+        }
+        return;
+    }
+    assert(chunk[0] == VARINT_CHUNK);
+    std::size_t column = 0;
+    for (int position = 1; position < size;) {
+        uint64_t zigzag = 0;
+        for (int shift = 0;; shift += 7) {
+            const auto byte = (unsigned char)chunk[position++];
+            zigzag |= (uint64_t)(byte & 0x7f) << shift;
+            if (byte < 0x80) {
+                break;
+            }
+        }
+        const int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+        element[column] = (R)((int64_t)element[column] + delta);
+        if (++column == length) {
+            data.insert(ptr);
+            column = 0;
+        }
+    }
+}
+}  // namespace
+
 /* send */
 namespace {
 inline void send(const void* data, const int count, const MPI_Datatype type, const int destination,
@@ -344,19 +431,48 @@ template <typename S, typename T>
 inline void send(const T& data, const size_t length, const Status& status) {
     send<S>(data, length, status->MPI_SOURCE, status->MPI_TAG);
 }
+/**
+ * Sends the tuples of a relation in chunks, followed by an empty message. While a chunk is in flight,
+ * the next one is encoded into a second buffer, such that at most two chunks are held in memory.
+ */
 template <typename S, typename T>
 inline void send(const T& data, const size_t length, const std::set<int>& destinations, const int tag) {
     assert(length >= 0);
     if (length > 0) {
-        std::vector<S> buffer(data.size() * length);
-        size_t i = 0;
+        const size_t tuples = chunkTuples<S>(length);
+        std::vector<S> values;
+        values.reserve(tuples * length);
+        std::vector<char> chunks[2];
+        std::vector<MPI_Request> requests[2];
+        size_t current = 0;
+        auto flush = [&]() {
+            // the buffer is reused once its previous chunk has been sent
+            MPI_Waitall((int)requests[current].size(), requests[current].data(), MPI_STATUSES_IGNORE);
+            requests[current].resize(destinations.size());
+            encodeChunk(values, length, chunks[current]);
+            size_t i = 0;
+            for (const auto destination : destinations) {
+                MPI_Isend(&chunks[current][0], (int)chunks[current].size(), MPI_BYTE, destination, tag,
+                        MPI_COMM_WORLD, &requests[current][i++]);
+            }
+            values.clear();
+            current = 1 - current;
+        };
         for (const auto& element : data) {
             for (size_t j = 0; j < length; ++j) {
-                buffer[i] = element[j];
-                ++i;
+                values.push_back(element[j]);
+            }
+            if (values.size() == tuples * length) {
+                flush();
             }
         }
-        send(buffer, destinations, tag);
+        if (!values.empty()) {
+            flush();
+        }
+        for (auto& pending : requests) {
+            MPI_Waitall((int)pending.size(), pending.data(), MPI_STATUSES_IGNORE);
+        }
+        send(destinations, tag);
     } else {
         send((!data.empty()), destinations, tag);
     }
@@ -439,21 +555,29 @@ inline void recv(Status& status) {
     recv<char>(status);
 }
 
+/**
+ * Receives the tuples of a relation sent in chunks, until the empty message following them. The next
+ * chunk is received while the tuples of the current one are inserted.
+ */
 template <typename R, typename T>
 inline void recv(T& data, const size_t length, Status& status) {
     assert(length >= 0);
     if (length > 0) {
-        std::vector<R> newData;
-        recv(newData, status);
-        auto it = newData.begin();
-        while (it != newData.end()) {
-            auto element = std::unique_ptr<R[]>(new R[length]());
-            for (size_t i = 0; i < length; ++i) {
-                element[i] = *it;
-                ++it;
-            }
-            const auto* ptr = element.get();
-            data.insert(ptr);
+        const int source = status->MPI_SOURCE;
+        const int tag = status->MPI_TAG;
+        const int capacity = chunkCapacity<R>(length);
+        std::vector<char> chunks[2] = {std::vector<char>(capacity), std::vector<char>(capacity)};
+        size_t current = 0;
+        int size;
+        MPI_Recv(&chunks[current][0], capacity, MPI_BYTE, source, tag, MPI_COMM_WORLD, status.get());
+        MPI_Get_count(status.get(), MPI_BYTE, &size);
+        while (size > 0) {
+            MPI_Request request;
+            MPI_Irecv(&chunks[1 - current][0], capacity, MPI_BYTE, source, tag, MPI_COMM_WORLD, &request);
+            decodeChunk<R>(chunks[current], size, length, data);
+            MPI_Wait(&request, status.get());
+            MPI_Get_count(status.get(), MPI_BYTE, &size);
+            current = 1 - current;
         }
     } else {
         bool islengthotEmpty;
@@ -466,5 +590,162 @@ inline void recv(T& data, const size_t length, Status& status) {
     }
 }
 }  // namespace
+
+/* data parallelism */
+namespace {
+
+/**
+ * Determines the process owning the tuple of the given values in a data-parallel run, i.e., the process
+ * which evaluates the rules for it and holds it in a partitioned relation. The tuples are partitioned by
+ * their hash value.
+ */
+template <typename Values>
+inline int owner(const Values& values, const std::size_t length) {
+    static const int size = commSize();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i < length; ++i) {
+        hash = (hash ^ static_cast<uint64_t>(values[i])) * 0x100000001b3ULL;
+    }
+    hash ^= hash >> 32;
+    return static_cast<int>(hash % static_cast<uint64_t>(size));
+}
+
+/** Determines whether the given tuple is owned by this process */
+template <template <typename, std::size_t> class Tuple, typename Domain, std::size_t arity>
+inline bool isOwner(const Tuple<Domain, arity>& tuple) {
+    static const int rank = commRank();
+    return owner(tuple, arity) == rank;
+}
+
+/** Determines whether the given condition holds in all processes */
+inline bool allTrue(const bool condition) {
+    int local = condition ? 1 : 0;
+    int global;
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    return global != 0;
+}
+
+/**
+ * Exchanges the new tuples of a relation between all processes, such that each process keeps the new
+ * tuples it owns which are not in the given full relation yet, whichever process derived them. Each
+ * tuple is only sent to its owner, in one all-to-all exchange.
+ */
+template <typename R, typename T, typename U>
+inline void exchange(T& data, const U& full, const size_t length) {
+    // nullary relations are exchanged as a flag
+    const size_t width = (length > 0) ? length : 1;
+    const int size = commSize();
+    const int rank = commRank();
+    std::vector<std::vector<R>> buffers((size_t)size);
+    for (const auto& element : data) {
+        std::vector<R>& buffer = buffers[owner(element, length)];
+        for (size_t j = 0; j < length; ++j) {
+            buffer.push_back(element[j]);
+        }
+        if (length == 0) {
+            buffer.push_back(1);
+        }
+    }
+
+    // exchange the number of values sent to each process
+    std::vector<int> sendCounts((size_t)size);
+    for (int i = 0; i < size; ++i) {
+        sendCounts[i] = (i == rank) ? 0 : (int)buffers[i].size();
+    }
+    std::vector<int> recvCounts((size_t)size);
+    MPI_Alltoall(&sendCounts[0], 1, MPI_INT, &recvCounts[0], 1, MPI_INT, MPI_COMM_WORLD);
+    std::vector<int> sendDisplacements((size_t)size);
+    std::vector<int> recvDisplacements((size_t)size);
+    int sendTotal = 0;
+    int recvTotal = 0;
+    for (int i = 0; i < size; ++i) {
+        sendDisplacements[i] = sendTotal;
+        sendTotal += sendCounts[i];
+        recvDisplacements[i] = recvTotal;
+        recvTotal += recvCounts[i];
+    }
+
+    // exchange the values, keeping the tuples owned by this process
+    std::vector<R> sent;
+    sent.reserve((size_t)sendTotal);
+    for (int i = 0; i < size; ++i) {
+        if (i != rank) {
+            sent.insert(sent.end(), buffers[i].begin(), buffers[i].end());
+        }
+    }
+    std::vector<R> received((size_t)recvTotal);
+    MPI_Alltoallv(sent.data(), &sendCounts[0], &sendDisplacements[0], datatype<R>(), received.data(),
+            &recvCounts[0], &recvDisplacements[0], datatype<R>(), MPI_COMM_WORLD);
+    data.purge();
+    typename T::t_tuple tuple;
+    for (const std::vector<R>* values : {&buffers[rank], &received}) {
+        for (size_t j = 0; j < values->size(); j += width) {
+            std::copy(values->begin() + j, values->begin() + j + length, &tuple[0]);
+            // the tuples of this process were checked against the full relation when derived
+            if (values == &buffers[rank] || !full.contains(tuple)) {
+                data.insert(tuple);
+            }
+        }
+    }
+}
+
+/**
+ * Exchanges the tuples of a relation between all processes, such that each process holds the union
+ * of the tuples of all processes. The tuples are sent in one batch, which is empty if the relation is
+ * empty, such that all processes learn whether the relation is empty everywhere. If the relation is
+ * partitioned, each process only sends the tuples it owns, which it holds all of.
+ */
+template <typename R, typename T>
+inline void allGather(T& data, const size_t length, const bool partitioned = false) {
+    // nullary relations are exchanged as a flag
+    const size_t width = (length > 0) ? length : 1;
+    const int size = commSize();
+    const int rank = commRank();
+    std::vector<R> buffer;
+    for (const auto& element : data) {
+        if (partitioned && owner(element, length) != rank) {
+            continue;
+        }
+        for (size_t j = 0; j < length; ++j) {
+            buffer.push_back(element[j]);
+        }
+        if (length == 0) {
+            buffer.push_back(1);
+        }
+    }
+
+    // collect the number of values of each process
+    int count = (int)buffer.size();
+    std::vector<int> counts((size_t)size);
+    MPI_Allgather(&count, 1, MPI_INT, &counts[0], 1, MPI_INT, MPI_COMM_WORLD);
+    std::vector<int> displacements((size_t)size);
+    int total = 0;
+    for (int i = 0; i < size; ++i) {
+        displacements[i] = total;
+        total += counts[i];
+    }
+    if (total == 0) {
+        return;
+    }
+
+    // collect the values, and insert the tuples of the other processes
+    std::vector<R> values((size_t)total);
+    MPI_Allgatherv(buffer.data(), count, datatype<R>(), &values[0], &counts[0], &displacements[0],
+            datatype<R>(), MPI_COMM_WORLD);
+    auto element = std::unique_ptr<R[]>(new R[width]());
+    for (int i = 0; i < size; ++i) {
+        if (i == rank) {
+            continue;
+        }
+        for (int j = displacements[i]; j < displacements[i] + counts[i]; j += (int)width) {
+            if (length > 0) {
+                std::copy(values.begin() + j, values.begin() + j + length, element.get());
+            }
+            const auto* ptr = element.get();
+            data.insert(ptr);
+        }
+    }
+}
+}  // namespace
 }  // end of namespace mpi
 }  // end of namespace souffle
@@ -11,7 +11,8 @@
  * @file ParallelUtils.h
  *
  * A set of utilities abstracting from the underlying parallel library.
- * Currently supported APIs: OpenMP and Cilk
+ * Currently supported APIs: OpenMP, Cilk and a built-in work-stealing
+ * scheduler (selected by defining SOUFFLE_WORK_STEALING)
  *
  ***********************************************************************/
 
@@ -19,7 +20,48 @@
 
 #include <atomic>
 
+#ifdef SOUFFLE_WORK_STEALING
+
+/**
+ * Implementation of parallel control flow constructs utilizing the
+ * work-stealing scheduler of WorkStealing.h
+ */
+
 #ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __APPLE__
+#define pthread_yield pthread_yield_np
+#endif
+
+// support for a parallel region
+#define PARALLEL_START ::souffle::WorkStealingPool::instance().run([&]() {
+#define PARALLEL_END });
+
+// support for parallel loops over a range of indices or random-access iterators;
+// loops never end with a barrier, the end of the parallel region is the barrier
+#define pfor_range(IT, BEGIN, END) for (auto IT : ::souffle::WorkStealingPool::share((BEGIN), (END)))
+#define pfor_range_nowait(IT, BEGIN, END) pfor_range(IT, BEGIN, END)
+#define cilk_for for
+
+// spawn and sync are processed sequentially
+#define task_spawn
+#define task_sync
+
+// sections are processed sequentially
+#define SECTIONS_START {
+#define SECTIONS_END }
+
+// sections are inlined
+#define SECTION_START {
+#define SECTION_END }
+
+// a macro to create an operation context
+#define CREATE_OP_CONTEXT(NAME, INIT) auto NAME = INIT;
+#define READ_OP_CONTEXT(NAME) NAME
+
+#elif defined _OPENMP
 
 /**
  * Implementation of parallel control flow constructs utilizing OpenMP
@@ -39,6 +81,9 @@
 #define pfor _Pragma("omp for schedule(dynamic)") for
 #define cilk_for for
 
+// support for parallel loops without a barrier at their end
+#define pfor_nowait _Pragma("omp for schedule(dynamic) nowait") for
+
 // spawn and sync are processed sequentially (overhead to expensive)
 #define task_spawn
 #define task_sync
@@ -74,6 +119,7 @@
 
 // support for parallel loops
 #define pfor cilk_for
+#define pfor_nowait cilk_for
 
 // spawn and sync support is a direct forward
 #define task_spawn cilk_spawn
@@ -104,6 +150,7 @@
 
 // support for parallel loops => simple sequential loop
 #define pfor for
+#define pfor_nowait for
 #define cilk_for for
 
 // spawn and sync not supported
@@ -127,11 +174,19 @@
 
 #endif
 
+// support for parallel loops over a range of indices or random-access iterators
+#ifndef SOUFFLE_WORK_STEALING
+#define pfor_range(IT, BEGIN, END) pfor(auto IT = (BEGIN); IT < (END); ++IT)
+#define pfor_range_nowait(IT, BEGIN, END) pfor_nowait(auto IT = (BEGIN); IT < (END); ++IT)
+#endif
+
 #ifndef IS_SEQUENTIAL
 #define IS_PARALLEL
 #endif
 
-#ifdef IS_PARALLEL
+#ifdef SOUFFLE_WORK_STEALING
+#define MAX_THREADS ((int)::souffle::WorkStealingPool::instance().getNumThreads())
+#elif defined IS_PARALLEL
 #define MAX_THREADS (omp_get_max_threads())
 #else
 #define MAX_THREADS (1)
@@ -610,3 +665,7 @@ inline Lock& getOutputLock() {
 }
 
 }  // end of namespace souffle
+
+#ifdef SOUFFLE_WORK_STEALING
+#include "WorkStealing.h"
+#endif
@@ -29,6 +29,7 @@
 #include "ErrorReport.h"
 #include "SymbolTable.h"
 #include "Util.h"
+#include <map>
 #include <memory>
 #include <utility>
 
@@ -114,19 +115,62 @@ void ParserDriver::addFunctorDeclaration(std::unique_ptr<AstFunctorDeclaration>
     }
 }
 
-void ParserDriver::addRelation(std::unique_ptr<AstRelation> r) {
+AstRelation* ParserDriver::addRelation(std::unique_ptr<AstRelation> r) {
     const auto& name = r->getName();
     if (AstRelation* prev = translationUnit->getProgram()->getRelation(name)) {
         Diagnostic err(Diagnostic::ERROR,
                 DiagnosticMessage("Redefinition of relation " + toString(name), r->getSrcLoc()),
                 {DiagnosticMessage("Previous definition", prev->getSrcLoc())});
         translationUnit->getErrorReport().addDiagnostic(err);
-    } else {
-        if (!r->getStores().empty() || !r->getLoads().empty()) {
+        return nullptr;
+    }
+    AstRelation* rel = r.get();
+    translationUnit->getProgram()->addRelation(std::move(r));
+    return rel;
+}
+
+void ParserDriver::declareRelations(
+        const std::vector<AstRelation*>& relations, const SrcLocation& loc, bool topLevel) {
+    declaredRelations = relations;
+    declarationLoc = loc;
+    topLevelDeclaration = topLevel;
+}
+
+void ParserDriver::addQualifier(uint32_t qualifier, const SrcLocation& loc, const SrcLocation& previous) {
+    // qualifiers are read as statements of their own, so check that they follow a declaration;
+    // an unknown qualifier has been reported already
+    const SrcLocation::Point& end = declarationLoc.end;
+    if (previous.filename != declarationLoc.filename || previous.end < end || previous.end > end) {
+        if (qualifier != 0) {
+            error(loc, "relation qualifier does not follow a relation declaration");
+        }
+        return;
+    }
+    declarationLoc.end = loc.end;
+    if (qualifier == 0 || declaredRelations.empty()) {
+        return;
+    }
+
+    const uint32_t io = INPUT_RELATION | OUTPUT_RELATION | PRINTSIZE_RELATION;
+    const uint32_t representation =
+            BRIE_RELATION | BTREE_RELATION | EQREL_RELATION | BITMAP_RELATION | HASH_RELATION;
+    const uint32_t previousQualifier = declaredRelations.front()->getQualifier();
+    if ((qualifier & representation) != 0 && (previousQualifier & representation) != 0) {
+        error(loc, "btree/brie/eqrel/bitmap/hash qualifier already set");
+    } else if ((previousQualifier & qualifier) != 0) {
+        const std::map<uint32_t, std::string> names = {{OUTPUT_RELATION, "output"}, {INPUT_RELATION, "input"},
+                {PRINTSIZE_RELATION, "printsize"}, {OVERRIDABLE_RELATION, "overridable"},
+                {INLINE_RELATION, "inline"}};
+        error(loc, names.at(qualifier) + " qualifier already set");
+    }
+
+    for (auto* rel : declaredRelations) {
+        if (topLevelDeclaration && (qualifier & io) != 0 && (rel->getQualifier() & io) == 0) {
             translationUnit->getErrorReport().addWarning(
-                    "Deprecated io qualifier was used in relation " + toString(name), r->getSrcLoc());
+                    "Deprecated io qualifier was used in relation " + toString(rel->getName()),
+                    rel->getSrcLoc());
         }
-        translationUnit->getProgram()->addRelation(std::move(r));
+        rel->setQualifier(rel->getQualifier() | qualifier);
     }
 }
 
@@ -21,6 +21,7 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -54,7 +55,9 @@ public:
 
     std::unique_ptr<AstTranslationUnit> translationUnit;
 
-    void addRelation(std::unique_ptr<AstRelation> r);
+    AstRelation* addRelation(std::unique_ptr<AstRelation> r);
+    void declareRelations(const std::vector<AstRelation*>& relations, const SrcLocation& loc, bool topLevel);
+    void addQualifier(uint32_t qualifier, const SrcLocation& loc, const SrcLocation& previous);
     void addFunctorDeclaration(std::unique_ptr<AstFunctorDeclaration> f);
     void addStore(std::unique_ptr<AstStore> d);
     void addLoad(std::unique_ptr<AstLoad> d);
@@ -81,6 +84,16 @@ public:
 
     void error(const SrcLocation& loc, const std::string& msg);
     void error(const std::string& msg);
+
+private:
+    /* The relations of the latest declaration, which its qualifiers are added to */
+    std::vector<AstRelation*> declaredRelations;
+
+    /* The location of the latest declaration including the qualifiers read so far */
+    SrcLocation declarationLoc;
+
+    /* Whether the latest declaration is not part of a component */
+    bool topLevelDeclaration = false;
 };
 
 }  // end of namespace souffle
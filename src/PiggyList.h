@@ -58,6 +58,17 @@ public:
         return numElements.load();
     }
 
+    /** The number of bytes allocated by this list */
+    size_t getMemoryUsage() const {
+        size_t res = sizeof(*this);
+        for (size_t i = 0; i < maxContainers; ++i) {
+            if (blockLookupTable[i].load() != nullptr) {
+                res += (INITIALBLOCKSIZE << i) * sizeof(T);
+            }
+        }
+        return res;
+    }
+
     inline T* getBlock(size_t blockNum) const {
         return blockLookupTable[blockNum];
     }
@@ -164,6 +175,11 @@ public:
         return m_size.load();
     };
 
+    /** The number of bytes allocated by this list */
+    size_t getMemoryUsage() const {
+        return sizeof(*this) + container_size.load() * sizeof(T);
+    }
+
     inline T* getBlock(size_t blocknum) const {
         return this->blockLookupTable[blocknum];
     }
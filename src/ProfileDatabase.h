@@ -11,6 +11,7 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -285,6 +286,103 @@ public:
     }
 };
 
+/**
+ * Binary profile log
+ *
+ * The log records each entry added to a profile database, in the order they are added, so that a
+ * program writes its profile while it runs, and a log cut short still holds every entry written
+ * before. The log starts with the magic string and continues with records, each beginning with
+ * its kind. A key record introduces a string of the log, numbered in order of appearance. An entry
+ * record holds the path of the entry as the numbers of its keys and the value of the entry, where
+ * the text of a text entry is a key as well. Numbers are written as unsigned LEB128 and strings as
+ * their length followed by their characters.
+ */
+class ProfileLog {
+public:
+    /** magic string at the start of a log */
+    static constexpr const char* magic = "souffle-profile-log-1\n";
+
+    /** kind of record */
+    enum Kind : uint8_t { KEY, SIZE, TEXT, DURATION, TIME };
+
+    void addSize(const std::vector<std::string>& path, size_t size) {
+        std::lock_guard<std::mutex> guard(lock);
+        writeEntry(SIZE, path);
+        writeNumber(size);
+    }
+
+    void addText(const std::vector<std::string>& path, const std::string& text) {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t id = writeKey(text);
+        writeEntry(TEXT, path);
+        writeNumber(id);
+    }
+
+    void addDuration(const std::vector<std::string>& path, microseconds start, microseconds end) {
+        std::lock_guard<std::mutex> guard(lock);
+        writeEntry(DURATION, path);
+        writeNumber(start.count());
+        writeNumber(end.count());
+    }
+
+    void addTime(const std::vector<std::string>& path, microseconds time) {
+        std::lock_guard<std::mutex> guard(lock);
+        writeEntry(TIME, path);
+        writeNumber(time.count());
+    }
+
+    /** take the records added since the last call */
+    std::string take() {
+        std::lock_guard<std::mutex> guard(lock);
+        std::string result;
+        result.swap(buffer);
+        return result;
+    }
+
+private:
+    std::mutex lock;
+
+    /** records not taken yet */
+    std::string buffer{magic};
+
+    /** numbers of the keys written */
+    std::unordered_map<std::string, size_t> keys;
+
+    void writeNumber(uint64_t number) {
+        do {
+            uint8_t byte = number & 0x7f;
+            number >>= 7;
+            buffer.push_back(static_cast<char>(number != 0 ? (byte | 0x80) : byte));
+        } while (number != 0);
+    }
+
+    /** get the number of a key, writing a key record for a new key */
+    size_t writeKey(const std::string& key) {
+        auto it = keys.find(key);
+        if (it != keys.end()) {
+            return it->second;
+        }
+        buffer.push_back(KEY);
+        writeNumber(key.size());
+        buffer.append(key);
+        size_t id = keys.size();
+        keys[key] = id;
+        return id;
+    }
+
+    void writeEntry(Kind kind, const std::vector<std::string>& path) {
+        std::vector<size_t> ids;
+        for (const auto& key : path) {
+            ids.push_back(writeKey(key));
+        }
+        buffer.push_back(kind);
+        writeNumber(ids.size());
+        for (size_t id : ids) {
+            writeNumber(id);
+        }
+    }
+};
+
 /**
  * Hierarchical databas
  */
@@ -292,6 +390,9 @@ class ProfileDatabase {
 private:
     std::unique_ptr<DirectoryEntry> root;
 
+    /** log of the entries added, if the database is streamed to a file */
+    std::shared_ptr<ProfileLog> log;
+
 protected:
     /**
      * Find path: if directories along the path do not exist, create them.
@@ -367,6 +468,9 @@ public:
         const std::string& key = qualifier.back();
         std::unique_ptr<SizeEntry> entry = std::make_unique<SizeEntry>(key, size);
         dir->writeEntry(std::move(entry));
+        if (log != nullptr) {
+            log->addSize(qualifier, size);
+        }
     }
 
     // add text entry
@@ -378,6 +482,9 @@ public:
         const std::string& key = qualifier.back();
         std::unique_ptr<TextEntry> entry = std::make_unique<TextEntry>(key, text);
         dir->writeEntry(std::move(entry));
+        if (log != nullptr) {
+            log->addText(qualifier, text);
+        }
     }
 
     // add duration entry
@@ -389,6 +496,9 @@ public:
         const std::string& key = qualifier.back();
         std::unique_ptr<DurationEntry> entry = std::make_unique<DurationEntry>(key, start, end);
         dir->writeEntry(std::move(entry));
+        if (log != nullptr) {
+            log->addDuration(qualifier, start, end);
+        }
     }
 
     // add time entry
@@ -400,6 +510,14 @@ public:
         const std::string& key = qualifier.back();
         std::unique_ptr<TimeEntry> entry = std::make_unique<TimeEntry>(key, time);
         dir->writeEntry(std::move(entry));
+        if (log != nullptr) {
+            log->addTime(qualifier, time);
+        }
+    }
+
+    /** record the entries added from now on in the given log */
+    void setLog(std::shared_ptr<ProfileLog> log) {
+        this->log = std::move(log);
     }
 
     // compute sum
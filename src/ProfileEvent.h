@@ -22,11 +22,15 @@
 #include <atomic>
 #include <cassert>
 #include <chrono>
+#include <condition_variable>
 #include <ctime>
 #include <functional>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
@@ -35,6 +39,7 @@
 #include <vector>
 #include <sys/resource.h>
 #include <sys/time.h>
+#include <unistd.h>
 
 namespace souffle {
 
@@ -44,7 +49,6 @@ namespace souffle {
 class ProfileEventSingleton {
     /** profile database */
     profile::ProfileDatabase database;
-    std::string filename{""};
 
     ProfileEventSingleton() = default;
 
@@ -79,13 +83,13 @@ public:
                 database, txt.c_str(), std::chrono::duration_cast<microseconds>(now().time_since_epoch()));
     }
 
-    /** create an event for recording start and end times */
+    /** create an event for recording start and end times, and the hardware counts in between */
     void makeTimingEvent(const std::string& txt, time_point start, time_point end, size_t startMaxRSS,
-            size_t endMaxRSS, size_t size, size_t iteration) {
+            size_t endMaxRSS, size_t size, size_t iteration, const profile::HardwareCounts& counts = {}) {
         microseconds start_ms = std::chrono::duration_cast<microseconds>(start.time_since_epoch());
         microseconds end_ms = std::chrono::duration_cast<microseconds>(end.time_since_epoch());
         profile::EventProcessorSingleton::instance().process(
-                database, txt.c_str(), start_ms, end_ms, startMaxRSS, endMaxRSS, size, iteration);
+                database, txt.c_str(), start_ms, end_ms, startMaxRSS, endMaxRSS, size, iteration, &counts);
     }
 
     /** create quantity event */
@@ -93,6 +97,14 @@ public:
         profile::EventProcessorSingleton::instance().process(database, txt.c_str(), number, iteration);
     }
 
+    /** create memory events, one for each part of a relation, e.g. for each of its indexes */
+    void makeMemoryEvent(const std::string& txt, const std::map<std::string, size_t>& usage, int iteration) {
+        for (const auto& cur : usage) {
+            profile::EventProcessorSingleton::instance().process(
+                    database, (txt + cur.first + ";").c_str(), cur.second, static_cast<size_t>(iteration));
+        }
+    }
+
     /** create utilisation event */
     void makeUtilisationEvent(const std::string& txt) {
         /* current time */
@@ -111,19 +123,17 @@ public:
                 database, txt.c_str(), time, systemTime, userTime, maxRSS);
     }
 
+    /** Stream the events from now on to the given file, as a binary profile log */
     void setOutputFile(std::string filename) {
-        this->filename = filename;
+        auto log = std::make_shared<profile::ProfileLog>();
+        if (writer.start(filename, log)) {
+            database.setLog(log);
+        }
     }
-    /** Dump all events */
+
+    /** Dump all events, i.e. write the events not yet streamed to the profile log */
     void dump() {
-        if (!filename.empty()) {
-            std::ofstream os(filename);
-            if (!os.is_open()) {
-                std::cerr << "Cannot open profile log file <" + filename + ">";
-            } else {
-                database.print(os);
-            }
-        }
+        writer.stop();
     }
 
     /** Start timer */
@@ -143,6 +153,14 @@ public:
         return database;
     }
 
+    profile::ProfileDatabase& getDB() {
+        return database;
+    }
+
+    void setDB(profile::ProfileDatabase db) {
+        database = std::move(db);
+    }
+
     void setDBFromFile(const std::string& filename) {
         database = profile::ProfileDatabase(filename);
     }
@@ -233,6 +251,147 @@ private:
     };
 
     ProfileTimer timer;
+
+    /** Writer of the profile log */
+    class ProfileWriter {
+    private:
+        /** log of the profile database */
+        std::shared_ptr<profile::ProfileLog> log;
+
+        /** file the log is written to */
+        std::ofstream file;
+
+        /** process which opened the file */
+        pid_t owner = 0;
+
+        /** writer is running */
+        bool running = false;
+
+        /** thread the writer runs on */
+        std::unique_ptr<std::thread> th;
+
+        std::condition_variable conditionVariable;
+        std::mutex writerMutex;
+
+        /** append the records logged since the last write to the file */
+        void write() {
+            const std::string records = log->take();
+            file.write(records.data(), records.size());
+            file.flush();
+        }
+
+    public:
+        /**
+         *  Start writing the log to the file in the background
+         *  @param interval the time between writes in milliseconds
+         *  @return whether the file could be opened
+         */
+        bool start(const std::string& filename, std::shared_ptr<profile::ProfileLog> log,
+                uint32_t interval = 100) {
+            stop();
+            file.open(filename, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "Cannot open profile log file <" + filename + ">" << std::endl;
+                return false;
+            }
+            this->log = std::move(log);
+            owner = getpid();
+            running = true;
+            th = std::make_unique<std::thread>([this, interval]() {
+                std::unique_lock<std::mutex> lock(writerMutex);
+                while (running) {
+                    conditionVariable.wait_for(
+                            lock, std::chrono::milliseconds(interval), [this]() { return !running; });
+                    write();
+                }
+            });
+            return true;
+        }
+
+        /** write the remaining records and close the file */
+        void stop() {
+            if (th == nullptr) {
+                return;
+            }
+            // a process forked by the program, e.g. by the shm engine, leaves the file to its owner
+            if (getpid() != owner) {
+                th.release();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> guard(writerMutex);
+                running = false;
+            }
+            conditionVariable.notify_all();
+            th->join();
+            th.reset();
+            write();
+            file.close();
+        }
+    };
+
+    ProfileWriter writer;
+};
+
+/**
+ * Counters of a profiled program, e.g. the frequencies of its operations.
+ *
+ * Every thread increments a block of counters of its own, padded against
+ * false sharing, so that counting in parallel neither races nor slows down
+ * the program being measured. The blocks are summed up when reading.
+ */
+class ProfileFrequencyCounters {
+public:
+    explicit ProfileFrequencyCounters(size_t size) : size(size), id(nextId()) {}
+
+    /** Get the counter with the given index of the current thread */
+    size_t& operator[](size_t index) {
+        return local()[index];
+    }
+
+    /** Get the sum of the counters with the given index over all threads */
+    size_t sum(size_t index) const {
+        std::lock_guard<std::mutex> guard(lock);
+        size_t res = 0;
+        for (const auto& block : blocks) {
+            res += block[PADDING + index];
+        }
+        return res;
+    }
+
+private:
+    /** the number of counters filling a cache line */
+    static constexpr size_t PADDING = 64 / sizeof(size_t);
+
+    /** the number of counters per thread */
+    const size_t size;
+
+    /** a unique identifier of this instance, not reused after its destruction */
+    const size_t id;
+
+    /** the blocks of counters, each surrounded by a cache line of padding */
+    std::vector<std::unique_ptr<size_t[]>> blocks;
+    mutable std::mutex lock;
+
+    static size_t nextId() {
+        static std::atomic<size_t> counter(0);
+        return counter++;
+    }
+
+    /** Get the block of the current thread, creating it on first use */
+    size_t* local() {
+        static thread_local std::vector<size_t*> cache;
+        if (id < cache.size() && cache[id] != nullptr) {
+            return cache[id];
+        }
+        if (cache.size() <= id) {
+            cache.resize(id + 1, nullptr);
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        blocks.emplace_back(new size_t[size + 2 * PADDING]());
+        cache[id] = blocks.back().get() + PADDING;
+        return cache[id];
+    }
 };
 
 }  // namespace souffle
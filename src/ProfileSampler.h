@@ -0,0 +1,251 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ProfileSampler.h
+ *
+ * A sampling profiler attributing the time of a program to the rules and
+ * relations it is evaluating when a profiling signal arrives.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ProfileEvent.h"
+#include "Util.h"
+
+#include <atomic>
+#include <cassert>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <sys/time.h>
+
+namespace souffle {
+
+/**
+ * The sampling profiler is an alternative to the timing of each rule by a Logger. The evaluation
+ * only records the rule or relation it is working on in a per-thread slot, and a SIGPROF timer
+ * counts the samples of the frame in the slot of the interrupted thread and of all frames around
+ * it. Threads without a frame of their own, e.g. the workers of a parallel loop, are attributed
+ * to the frame of the thread which started the sampler.
+ *
+ * When sampling stops, each frame becomes a timing event with the share of the run time given by
+ * its share of the samples, so that souffle-profile reads the result like an ordinary profile.
+ * The samples of a recursive relation are reported as a single iteration.
+ *
+ * The sampler is implemented as a singleton.
+ */
+class ProfileSampler {
+public:
+    /**
+     * A frame is the rule or relation labelled by the message of a profile timer. Frames live as
+     * long as the sampler, so that the signal handler may follow them at any time.
+     */
+    class Frame {
+    public:
+        explicit Frame(std::string label) : label(std::move(label)) {}
+
+        const std::string& getLabel() const {
+            return label;
+        }
+
+        size_t getSamples() const {
+            return samples;
+        }
+
+        size_t getTuples() const {
+            return tuples;
+        }
+
+    private:
+        friend class ProfileSampler;
+
+        /** message of the profile timer */
+        const std::string label;
+
+        /** the frame this frame was first entered in */
+        std::atomic<const Frame*> parent{nullptr};
+
+        /** number of samples taken in this frame or in a frame inside it */
+        mutable std::atomic<size_t> samples{0};
+
+        /** number of tuples produced in this frame */
+        std::atomic<size_t> tuples{0};
+    };
+
+    /**
+     * A scope marks the current thread as working on a frame for its lifetime.
+     */
+    class Scope {
+    public:
+        explicit Scope(Frame& frame, std::function<size_t()> size = nullptr)
+                : frame(frame), previous(slot().load(std::memory_order_relaxed)), size(std::move(size)),
+                  preSize(this->size ? this->size() : 0) {
+            registeredSlot() = &slot();
+            const Frame* none = nullptr;
+            if (previous != nullptr && previous != &frame) {
+                frame.parent.compare_exchange_strong(none, previous, std::memory_order_relaxed);
+            }
+            slot().store(&frame, std::memory_order_relaxed);
+        }
+
+        ~Scope() {
+            slot().store(previous, std::memory_order_relaxed);
+            if (size) {
+                frame.tuples += size() - preSize;
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Frame& frame;
+        const Frame* previous;
+        std::function<size_t()> size;
+        size_t preSize;
+    };
+
+    /** get singleton */
+    static ProfileSampler& instance() {
+        static ProfileSampler singleton;
+        return singleton;
+    }
+
+    /** get the frame of a profile timer message, creating it on first use */
+    Frame& getFrame(const std::string& label) {
+        std::lock_guard<std::mutex> guard(framesMutex);
+        auto& frame = frames[label];
+        if (frame == nullptr) {
+            frame = std::make_unique<Frame>(label);
+        }
+        return *frame;
+    }
+
+    /**
+     * Start sampling every interval microseconds of the CPU time of the process.
+     */
+    void start(size_t interval) {
+        assert(!running && "sampler already started");
+        assert(interval > 0 && "sampling interval must be positive");
+        startTime = now();
+        samples = 0;
+        mainSlot = &slot();
+
+        struct sigaction action {};
+        action.sa_handler = handler;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, &prevAction) != 0) {
+            perror("Failed to set SIGPROF signal handler.");
+            exit(1);
+        }
+
+        struct itimerval timer {};
+        timer.it_interval.tv_sec = interval / 1000000;
+        timer.it_interval.tv_usec = interval % 1000000;
+        timer.it_value = timer.it_interval;
+        if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+            perror("Failed to start profiling timer.");
+            exit(1);
+        }
+        running = true;
+    }
+
+    /**
+     * Stop sampling and turn the samples of each frame into a timing event of the profile.
+     */
+    void stop() {
+        if (!running) {
+            return;
+        }
+        struct itimerval timer {};
+        setitimer(ITIMER_PROF, &timer, nullptr);
+        sigaction(SIGPROF, &prevAction, nullptr);
+        running = false;
+
+        // scale the samples to the elapsed time, as threads running in parallel sample faster
+        const time_point endTime = now();
+        const double total = samples;
+        const auto elapsed = endTime - startTime;
+
+        std::lock_guard<std::mutex> guard(framesMutex);
+        for (const auto& cur : frames) {
+            const Frame& frame = *cur.second;
+            const double share = total > 0 ? frame.samples / total : 0;
+            const auto duration = std::chrono::duration_cast<time_point::duration>(elapsed * share);
+            ProfileEventSingleton::instance().makeTimingEvent(
+                    frame.label, startTime, startTime + duration, 0, 0, frame.tuples, 0);
+        }
+    }
+
+    /** get the number of samples taken since the sampler was started */
+    size_t getSamples() const {
+        return samples;
+    }
+
+private:
+    ProfileSampler() = default;
+
+    /** the frame the current thread is working on */
+    static std::atomic<const Frame*>& slot() {
+        static thread_local std::atomic<const Frame*> frame(nullptr);
+        return frame;
+    }
+
+    /**
+     * The slot of the current thread, registered by its scopes, or null if the thread never
+     * entered a frame. Unlike the slot itself, the pointer lives in the static TLS block, which
+     * the signal handler reads without calling into the dynamic linker to allocate the TLS.
+     */
+    static std::atomic<const Frame*>*& registeredSlot() {
+        static thread_local std::atomic<const Frame*>* registered
+                __attribute__((tls_model("initial-exec"))) = nullptr;
+        return registered;
+    }
+
+    /** count a sample for the frames of the interrupted thread */
+    static void handler(int) {
+        ProfileSampler& sampler = instance();
+        const std::atomic<const Frame*>* own = registeredSlot();
+        const Frame* frame = own != nullptr ? own->load(std::memory_order_relaxed) : nullptr;
+        if (frame == nullptr) {
+            frame = sampler.mainSlot.load(std::memory_order_relaxed)->load(std::memory_order_relaxed);
+        }
+        for (; frame != nullptr; frame = frame->parent.load(std::memory_order_relaxed)) {
+            frame->samples.fetch_add(1, std::memory_order_relaxed);
+        }
+        sampler.samples.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** frames by the message of their profile timer */
+    std::map<std::string, std::unique_ptr<Frame>> frames;
+    std::mutex framesMutex;
+
+    /** slot of the thread which started the sampler */
+    std::atomic<std::atomic<const Frame*>*> mainSlot{nullptr};
+
+    /** number of samples taken */
+    std::atomic<size_t> samples{0};
+
+    time_point startTime;
+    bool running = false;
+
+    /** signal handler replaced by the sampler */
+    struct sigaction prevAction {};
+};
+
+}  // end of namespace souffle
@@ -284,6 +284,11 @@ bool ProvenanceTransformer::transform(AstTranslationUnit& translationUnit) {
             transformEqrelRelation(*relation);
         }
 
+        // provenance annotations extend the arity beyond what a bitmap can store
+        if (relation->getRepresentation() == RelationRepresentation::BITMAP) {
+            relation->setRepresentation(RelationRepresentation::BTREE);
+        }
+
         // generate info relations for each clause
         // do this before all other transformations so that we record
         // the original rule without any instrumentation
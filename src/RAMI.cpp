@@ -19,11 +19,13 @@
 #include "BinaryConstraintOps.h"
 #include "FunctorOps.h"
 #include "Global.h"
+#include "HardwareCounters.h"
 #include "IODirectives.h"
 #include "IOSystem.h"
 #include "Logger.h"
 #include "ParallelUtils.h"
 #include "ProfileEvent.h"
+#include "ProfileSampler.h"
 #include "RAMIIndex.h"
 #include "RAMIInterface.h"
 #include "RAMIRecords.h"
@@ -320,7 +322,8 @@ bool RAMI::evalCond(const RamCondition& cond, const RAMIContext& ctxt) {
             auto arity = rel.getArity();
             auto values = exists.getValues();
 
-            if (Global::config().has("profile") && !exists.getRelation().isTemp()) {
+            if (Global::config().has("profile") && !Global::config().has("profile-sampling") &&
+                    !exists.getRelation().isTemp()) {
                 interpreter.reads[exists.getRelation().getName()]++;
             }
             // for total we use the exists test
@@ -618,6 +621,9 @@ void RAMI::evalOp(const RamOperation& op, const RAMIContext& args) {
                     break;
             }
 
+            // the reduction is sequential, unlike in generated code: the interpreter evaluates an
+            // operation on a single thread, and the lookups of the condition update the operation
+            // hints of the indexes shared by all threads
             for (const RamDomain* data : rel) {
                 ctxt[aggregate.getTupleId()] = data;
 
@@ -895,6 +901,11 @@ void RAMI::evalStmt(const RamStatement& stmt, const RAMIContext& args) {
 
         bool visitLogRelationTimer(const RamLogRelationTimer& timer) override {
             const RAMIRelation& rel = interpreter.getRelation(timer.getRelation());
+            if (Global::config().has("profile-sampling")) {
+                ProfileSampler::Scope sampled(ProfileSampler::instance().getFrame(timer.getMessage()),
+                        std::bind(&RAMIRelation::size, &rel));
+                return visit(timer.getStatement());
+            }
             Logger logger(timer.getMessage().c_str(), interpreter.getIterationNumber(),
                     std::bind(&RAMIRelation::size, &rel));
             return visit(timer.getStatement());
@@ -955,6 +966,13 @@ void RAMI::evalStmt(const RamStatement& stmt, const RAMIContext& args) {
             return true;
         }
 
+        bool visitLogMemory(const RamLogMemory& memory) override {
+            const RAMIRelation& rel = interpreter.getRelation(memory.getRelation());
+            ProfileEventSingleton::instance().makeMemoryEvent(
+                    memory.getMessage(), rel.getMemoryUsageByIndex(), interpreter.getIterationNumber());
+            return true;
+        }
+
         bool visitLoad(const RamLoad& load) override {
             for (IODirectives ioDirectives : load.getIODirectives()) {
                 try {
@@ -1093,7 +1111,15 @@ void RAMI::executeMain() {
         visitDepthFirst(main, [&](const RamQuery& rule) { ++ruleCount; });
         ProfileEventSingleton::instance().makeConfigRecord("ruleCount", std::to_string(ruleCount));
 
+        if (Global::config().has("profile-sampling")) {
+            ProfileSampler::instance().start(std::stoi(Global::config().get("profile-sampling")));
+        }
+        if (Global::config().has("profile-counters")) {
+            HardwareCounters::instance().start();
+        }
         evalStmt(main);
+        ProfileSampler::instance().stop();
+        HardwareCounters::instance().stop();
         ProfileEventSingleton::instance().stopTimer();
         for (auto const& cur : frequencies) {
             for (auto const& iter : cur.second) {
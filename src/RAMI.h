@@ -111,6 +111,8 @@ protected:
         assert(environment.find(id.getName()) == environment.end());
         if (id.getRepresentation() == RelationRepresentation::EQREL) {
             res = new RAMIEqRelation(id.getArity(), orderSet, id.getName());
+        } else if (id.getRepresentation() == RelationRepresentation::BITMAP) {
+            res = new RAMIBitmapRelation(id.getArity(), orderSet, id.getName());
         } else {
             res = new RAMIRelation(id.getArity(), orderSet, id.getName());
         }
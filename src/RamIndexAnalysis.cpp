@@ -15,13 +15,20 @@
  ***********************************************************************/
 
 #include "RamIndexAnalysis.h"
+#include "Global.h"
 #include "RamCondition.h"
 #include "RamNode.h"
 #include "RamOperation.h"
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
+#include "RelationRepresentation.h"
+#include "profile/ProgramRun.h"
+#include "profile/Reader.h"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <iterator>
 #include <queue>
@@ -179,18 +186,7 @@ void MinIndexSelection::solve() {
     assert(!chains.empty());
 
     for (const auto& chain : chains) {
-        std::vector<int> ids;
-        SearchSignature initDelta = *(chain.begin());
-        insertIndex(ids, initDelta);
-
-        for (auto iit = chain.begin(); next(iit) != chain.end(); ++iit) {
-            SearchSignature delta = *(next(iit)) - *iit;
-            insertIndex(ids, delta);
-        }
-
-        assert(!ids.empty());
-
-        orders.push_back(ids);
+        orders.push_back(getChainOrder(chain));
     }
 
     // Construct the matching poblem
@@ -205,6 +201,92 @@ void MinIndexSelection::solve() {
     }
 }
 
+MinIndexSelection::LexOrder MinIndexSelection::getChainOrder(const Chain& chain) {
+    LexOrder ids;
+    SearchSignature initDelta = *(chain.begin());
+    insertIndex(ids, initDelta);
+
+    for (auto iit = chain.begin(); next(iit) != chain.end(); ++iit) {
+        SearchSignature delta = *(next(iit)) - *iit;
+        insertIndex(ids, delta);
+    }
+
+    assert(!ids.empty());
+    return ids;
+}
+
+namespace {
+
+/** estimated cost of a b-tree insert or lookup in a relation of the given size */
+double btreeCost(double size) {
+    return std::log2(std::max(size, 1.0)) + 1;
+}
+
+/** estimated cost of a hash index insert or lookup */
+constexpr double HASH_COST = 2;
+
+}  // namespace
+
+double MinIndexSelection::getMaintenanceCost(size_t idx) const {
+    const double size = std::max(estimatedSize, 0.0);
+    return size * (isHashIndex(idx) ? HASH_COST : btreeCost(size));
+}
+
+double MinIndexSelection::getLookupCost(size_t idx) const {
+    const double cost = isHashIndex(idx) ? HASH_COST : btreeCost(estimatedSize);
+    double res = 0;
+    for (SearchSignature search : chainToOrder[idx]) {
+        res += getLookups(search) * cost;
+    }
+    return res;
+}
+
+void MinIndexSelection::refine() {
+    if (!hashIndexes || estimatedSize < 0 || orders.size() != chainToOrder.size()) {
+        return;
+    }
+
+    // greedily detach the search with the highest net saving until none saves anything
+    const double saving = btreeCost(estimatedSize) - HASH_COST;
+    const double maintenance = estimatedSize * HASH_COST;
+    while (true) {
+        double bestGain = 0;
+        size_t bestChain = 0;
+        SearchSignature bestSearch = 0;
+        for (size_t i = 0; i < chainToOrder.size(); i++) {
+            const Chain& chain = chainToOrder[i];
+            if (chain.size() < 2) {
+                continue;
+            }
+            for (SearchSignature search : chain) {
+                double gain = getLookups(search) * saving - maintenance;
+                // the remaining search of a non-master chain becomes a hash index as well
+                if (chain.size() == 2 && i > 0) {
+                    for (SearchSignature other : chain) {
+                        if (other != search) {
+                            gain += getLookups(other) * saving;
+                        }
+                    }
+                }
+                if (gain > bestGain) {
+                    bestGain = gain;
+                    bestChain = i;
+                    bestSearch = search;
+                }
+            }
+        }
+        if (bestSearch == 0) {
+            break;
+        }
+
+        // removing a search from a chain leaves a chain
+        chainToOrder[bestChain].erase(bestSearch);
+        orders[bestChain] = getChainOrder(chainToOrder[bestChain]);
+        chainToOrder.push_back(Chain({bestSearch}));
+        orders.push_back(getChainOrder(chainToOrder.back()));
+    }
+}
+
 MinIndexSelection::Chain MinIndexSelection::getChain(
         const SearchSignature umn, const MaxMatching::Matchings& match) {
     SearchSignature start = umn;  // start at an unmateched node
@@ -320,6 +402,9 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
         indexes.solve();
     }
 
+    // add indexes where the statistics indicate that they pay off
+    estimateCosts(translationUnit);
+
     // Only case where indexSet is still empty is when relation has arity == 0
     for (auto& cur : minIndexCover) {
         MinIndexSelection& indexes = cur.second;
@@ -329,6 +414,156 @@ void RamIndexAnalysis::run(const RamTranslationUnit& translationUnit) {
     }
 }
 
+namespace {
+
+/** The name of the relation a delta or new relation belongs to */
+std::string getBaseName(const std::string& name) {
+    for (const std::string prefix : {"@delta_", "@new_"}) {
+        if (name.compare(0, prefix.size(), prefix) == 0) {
+            return name.substr(prefix.size());
+        }
+    }
+    return name;
+}
+
+/**
+ * Estimate the number of lines of a file from a sample of its beginning.
+ * @return a negative value if the file cannot be read
+ */
+double sampleLines(const std::string& filename) {
+    const std::streamoff SAMPLE_SIZE = 1 << 16;
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return -1;
+    }
+    const std::streamoff fileSize = in.tellg();
+    if (fileSize <= 0) {
+        return 0;
+    }
+    std::vector<char> sample(std::min(fileSize, SAMPLE_SIZE));
+    in.seekg(0);
+    in.read(sample.data(), sample.size());
+    double lines = std::count(sample.begin(), sample.end(), '\n');
+    if (fileSize <= SAMPLE_SIZE) {
+        return lines + (sample.back() != '\n' ? 1 : 0);
+    }
+    return lines * fileSize / SAMPLE_SIZE;
+}
+
+}  // namespace
+
+void RamIndexAnalysis::estimateCosts(const RamTranslationUnit& translationUnit) {
+    const RamProgram& program = *translationUnit.getProgram();
+
+    // sizes of the relations, from the profile or sampled from the input files
+    std::shared_ptr<profile::ProgramRun> programRun;
+    if (Global::config().has("profile-use")) {
+        programRun = std::make_shared<profile::ProgramRun>(profile::ProgramRun());
+        profile::Reader(Global::config().get("profile-use"), programRun).processFile();
+    }
+    std::map<std::string, double> sizes;
+    visitDepthFirst(program, [&](const RamLoad& load) {
+        double size = 0;
+        for (const auto& directives : load.getIODirectives()) {
+            if (directives.getIOType() != "file") {
+                return;
+            }
+            const double lines = sampleLines(directives.getFileName());
+            if (lines < 0) {
+                return;
+            }
+            size += lines;
+        }
+        sizes[load.getRelation().getName()] += size;
+    });
+    auto getSize = [&](const RamRelation& rel) -> double {
+        const std::string name = getBaseName(rel.getName());
+        if (programRun) {
+            if (const auto* profRel = programRun->getRelation(name)) {
+                return profRel->size();
+            }
+        }
+        auto pos = sizes.find(name);
+        return (pos == sizes.end()) ? -1 : pos->second;
+    };
+
+    // estimate the lookups per search, separately for existence checks and index operations,
+    // grouping a relation with its delta and new relations which are swapped with each other
+    std::map<std::string, std::map<SearchSignature, double>> existLookups;
+    std::map<std::string, std::map<SearchSignature, double>> indexLookups;
+    auto addLookups = [&](const RamNode& node, double executions) {
+        if (const auto* indexSearch = dynamic_cast<const RamIndexOperation*>(&node)) {
+            const std::string name = getBaseName(indexSearch->getRelation().getName());
+            indexLookups[name][getSearchSignature(indexSearch)] += executions;
+        } else if (const auto* exists = dynamic_cast<const RamExistenceCheck*>(&node)) {
+            const std::string name = getBaseName(exists->getRelation().getName());
+            existLookups[name][getSearchSignature(exists)] += executions;
+        }
+    };
+    visitDepthFirst(program, [&](const RamQuery& query) {
+        // every search is executed at least once
+        visitDepthFirst(query, [&](const RamNode& node) { addLookups(node, 1); });
+
+        // searches nested in the outermost loop are executed once per tuple of its relation
+        const RamOperation* outer = &query.getOperation();
+        while (dynamic_cast<const RamRelationOperation*>(outer) == nullptr) {
+            const auto* nested = dynamic_cast<const RamNestedOperation*>(outer);
+            if (nested == nullptr) {
+                return;
+            }
+            outer = &nested->getOperation();
+        }
+        const auto* loop = static_cast<const RamRelationOperation*>(outer);
+        const double size = getSize(loop->getRelation());
+        if (size > 1) {
+            visitDepthFirst(loop->getOperation(), [&](const RamNode& node) { addLookups(node, size - 1); });
+        }
+    });
+
+    // existence checks are counted by the profile, so scale the estimates to the counted reads
+    if (programRun) {
+        for (auto& cur : existLookups) {
+            const auto* profRel = programRun->getRelation(cur.first);
+            double estimated = 0;
+            for (const auto& lookups : cur.second) {
+                estimated += lookups.second;
+            }
+            if (profRel == nullptr || profRel->getReads() == 0 || estimated == 0) {
+                continue;
+            }
+            for (auto& lookups : cur.second) {
+                lookups.second *= profRel->getReads() / estimated;
+            }
+        }
+    }
+
+    // refine the selection, with hash indexes only where the synthesiser generates them
+    // (see SynthesiserRelation::getSynthesiserRelation)
+    const bool compiled = Global::config().has("compile") || Global::config().has("dl-program") ||
+                          Global::config().has("generate");
+    for (auto& cur : minIndexCover) {
+        const RamRelation& rel = *cur.first;
+        MinIndexSelection& indexes = cur.second;
+        const std::string name = getBaseName(rel.getName());
+        for (const auto* lookups : {&existLookups[name], &indexLookups[name]}) {
+            for (const auto& search : *lookups) {
+                indexes.addLookups(search.first, search.second);
+            }
+        }
+        // all searches are equality searches, so an index serving a single search may be a hash
+        // index; relations without a qualifier only get them if their size is known, such that
+        // the selection of programs without statistics stays the same
+        const double size = getSize(rel);
+        const auto representation = rel.getRepresentation();
+        const bool direct =
+                representation == RelationRepresentation::HASH ||
+                (representation == RelationRepresentation::DEFAULT && rel.getArity() <= 6 && size >= 0);
+        const bool hashable = compiled && direct && !rel.isNullary() && !Global::config().has("provenance");
+        indexes.setStatistics(size, hashable);
+        indexes.refine();
+    }
+}
+
 MinIndexSelection& RamIndexAnalysis::getIndexes(const RamRelation& rel) {
     auto pos = minIndexCover.find(&rel);
     if (pos != minIndexCover.end()) {
@@ -363,13 +598,26 @@ void RamIndexAnalysis::print(std::ostream& os) const {
         }
 
         os << "\tNumber of Indexes: " << indexes.getAllOrders().size() << "\n";
-        for (auto& order : indexes.getAllOrders()) {
+        const auto orders = indexes.getAllOrders();
+        for (size_t idx = 0; idx < orders.size(); idx++) {
             os << "\t\t";
-            for (auto& i : order) {
+            for (auto& i : orders[idx]) {
                 os << rel.getArg(i) << " ";
             }
             os << "\n";
         }
+
+        /* print estimated costs */
+        if (indexes.getEstimatedSize() < 0) {
+            os << "\tEstimated Size: unknown\n";
+            continue;
+        }
+        os << "\tEstimated Size: " << indexes.getEstimatedSize() << "\n";
+        for (size_t idx = 0; idx < orders.size(); idx++) {
+            os << "\t\t" << (indexes.isHashIndex(idx) ? "hash" : "b-tree") << " index " << idx
+               << ": maintenance " << indexes.getMaintenanceCost(idx) << ", lookups "
+               << indexes.getLookupCost(idx) << "\n";
+        }
     }
     os << "------ End of Auto-Index-Generation Report -------\n";
 }
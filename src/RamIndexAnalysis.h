@@ -147,6 +147,10 @@ private:
  * "Automatic Index Selection for Large-Scale Datalog Computation"
  * http://www.vldb.org/pvldb/vol12/p141-subotic.pdf
  *
+ * The minimal cover treats all searches alike. If statistics of the relation
+ * are available, refine() trades the maintenance cost of additional indexes
+ * against the cost of the lookups they save.
+ *
  */
 
 class MinIndexSelection {
@@ -203,6 +207,55 @@ public:
     /** @Brief map the keys in the key set to lexicographical order */
     void solve();
 
+    /** @Brief add to the estimated number of lookups of a search */
+    void addLookups(SearchSignature cols, double lookups) {
+        if (cols != 0) {
+            lookupEstimates[cols] += lookups;
+        }
+    }
+
+    /** @Brief get the estimated number of lookups of a search */
+    double getLookups(SearchSignature cols) const {
+        auto pos = lookupEstimates.find(cols);
+        return (pos == lookupEstimates.end()) ? 0 : pos->second;
+    }
+
+    /**
+     * @Brief set the statistics of the relation used by the cost model
+     * @param size the estimated number of tuples, negative if unknown
+     * @param hashable whether indexes serving a single search are hash indexes
+     */
+    void setStatistics(double size, bool hashable) {
+        estimatedSize = size;
+        hashIndexes = hashable;
+    }
+
+    /** @Brief get the estimated number of tuples, negative if unknown */
+    double getEstimatedSize() const {
+        return estimatedSize;
+    }
+
+    /** @Brief check whether an index is a hash index, i.e., a non-master index serving a single search */
+    bool isHashIndex(size_t idx) const {
+        return hashIndexes && idx > 0 && idx < chainToOrder.size() && chainToOrder[idx].size() == 1;
+    }
+
+    /** @Brief estimated cost of inserting all tuples into an index */
+    double getMaintenanceCost(size_t idx) const;
+
+    /** @Brief estimated cost of all lookups served by an index */
+    double getLookupCost(size_t idx) const;
+
+    /**
+     * @Brief detach searches from their chains where it pays off
+     *
+     * A search sharing a chain with others is answered by a b-tree in logarithmic
+     * time. Moved to an index of its own it is answered by a hash index instead.
+     * A search is detached if the estimated lookup cost saved exceeds the cost of
+     * maintaining the additional index. Requires a solution and the statistics.
+     */
+    void refine();
+
     /** @Brief convert from a representation of A verticies to B verticies */
     static SearchSignature toB(SearchSignature a) {
         SearchSignature msb = 1;
@@ -237,6 +290,12 @@ protected:
     OrderCollection orders;      // collection of lexicographical orders
     ChainOrderMap chainToOrder;  // maps order index to set of searches covered by chain
     MaxMatching matching;        // matching problem for finding minimal number of orders
+    std::map<SearchSignature, double> lookupEstimates;  // estimated number of lookups of each search
+    double estimatedSize = -1;                          // estimated number of tuples, negative if unknown
+    bool hashIndexes = false;                           // whether single-search indexes are hash indexes
+
+    /** @Brief compute the lexicographical order covering all searches of a chain */
+    LexOrder getChainOrder(const Chain& chain);
 
     /** count the number of bits in key */
     static size_t card(SearchSignature cols) {
@@ -380,6 +439,16 @@ private:
      * minimal index cover for relations, i.e., maps a relation to a set of indexes
      */
     std::map<const RamRelation*, MinIndexSelection> minIndexCover;
+
+    /**
+     * @Brief estimate the lookups of each search and the sizes of relations, and refine
+     * the index selection with them
+     *
+     * Sizes are taken from the profile given by --profile-use, or sampled from the fact
+     * files of input relations. A search is assumed to be executed once per tuple of the
+     * outermost relation of its query.
+     */
+    void estimateCosts(const RamTranslationUnit& translationUnit);
 };
 
 }  // end of namespace souffle
@@ -900,7 +900,42 @@ protected:
     }
 };
 
-#ifdef USE_MPI
+/**
+ * Log the memory allocated by each index of a relation
+ */
+class RamLogMemory : public RamRelationStatement {
+public:
+    RamLogMemory(std::unique_ptr<RamRelationReference> relRef, std::string message)
+            : RamRelationStatement(std::move(relRef)), message(std::move(message)) {}
+
+    /** Get logging message */
+    const std::string& getMessage() const {
+        return message;
+    }
+
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "LOGMEMORY " << getRelation().getName();
+        os << " TEXT "
+           << "\"" << stringify(message) << "\"";
+        os << std::endl;
+    }
+
+    RamLogMemory* clone() const override {
+        return new RamLogMemory(std::unique_ptr<RamRelationReference>(relationRef->clone()), message);
+    }
+
+protected:
+    /** logging message */
+    std::string message;
+
+    bool equal(const RamNode& node) const override {
+        assert(nullptr != dynamic_cast<const RamLogMemory*>(&node));
+        const auto& other = static_cast<const RamLogMemory&>(node);
+        return RamRelationStatement::equal(other) && getMessage() == other.getMessage();
+    }
+};
+
+// -- message passing between the processes of a distributed engine --
 
 class RamRecv : public RamRelationStatement {
 public:
@@ -1033,6 +1068,4 @@ protected:
     }
 };
 
-#endif
-
 }  // end of namespace souffle
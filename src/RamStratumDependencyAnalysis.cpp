@@ -0,0 +1,146 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamStratumDependencyAnalysis.cpp
+ *
+ * Implementation of RAM Stratum Dependency Analysis
+ *
+ ***********************************************************************/
+
+#include "RamStratumDependencyAnalysis.h"
+#include "FunctorOps.h"
+#include "RamExpression.h"
+#include "RamOperation.h"
+#include "RamProgram.h"
+#include "RamTranslationUnit.h"
+#include "RamVisitor.h"
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace souffle {
+
+namespace {
+
+/** pseudo relations for effects that have to stay in order across strata */
+const std::string CONSOLE = "@console";
+const std::string COUNTER = "@counter";
+const std::string RECORDS = "@records";
+const std::string SYMBOLS = "@symbols";
+
+}  // namespace
+
+void RamStratumDependencyAnalysis::run(const RamTranslationUnit& translationUnit) {
+    strata.clear();
+    predecessors.clear();
+
+    const RamStatement* main = translationUnit.getProgram()->getMain();
+    if (main == nullptr) {
+        return;
+    }
+    visitDepthFirst(*main, [&](const RamStratum& stratum) { strata.push_back(&stratum); });
+    predecessors.resize(strata.size());
+
+    // the last stratum modifying a relation, and the strata reading it since
+    std::map<std::string, size_t> lastWriter;
+    std::map<std::string, std::set<size_t>> readers;
+
+    for (size_t pos = 0; pos < strata.size(); ++pos) {
+        std::set<std::string> reads;
+        std::set<std::string> writes;
+
+        // every reference to a relation reads it, unless it is modified below
+        visitDepthFirst(*strata[pos],
+                [&](const RamRelationReference& ref) { reads.insert(ref.get()->getName()); });
+        visitDepthFirst(*strata[pos], [&](const RamNode& node) {
+            if (const auto* store = dynamic_cast<const RamStore*>(&node)) {
+                for (const auto& io : store->getIODirectives()) {
+                    if (io.getIOType().compare(0, 6, "stdout") == 0) {
+                        writes.insert(CONSOLE);
+                    }
+                }
+            } else if (dynamic_cast<const RamLogSize*>(&node) != nullptr ||
+                       dynamic_cast<const RamLogMemory*>(&node) != nullptr ||
+                       dynamic_cast<const RamLogRelationTimer*>(&node) != nullptr) {
+                // read-only relation statements
+            } else if (const auto* load = dynamic_cast<const RamLoad*>(&node)) {
+                // loading may report errors on the console and interns the symbols it reads
+                writes.insert(load->getRelation().getName());
+                writes.insert(CONSOLE);
+                for (const auto& qualifier : load->getRelation().getAttributeTypeQualifiers()) {
+                    if (qualifier[0] == 's') {
+                        writes.insert(SYMBOLS);
+                    }
+                }
+            } else if (const auto* stmt = dynamic_cast<const RamRelationStatement*>(&node)) {
+                writes.insert(stmt->getRelation().getName());
+            } else if (const auto* project = dynamic_cast<const RamProject*>(&node)) {
+                writes.insert(project->getRelation().getName());
+            } else if (const auto* merge = dynamic_cast<const RamMerge*>(&node)) {
+                writes.insert(merge->getTargetRelation().getName());
+            } else if (const auto* swap = dynamic_cast<const RamSwap*>(&node)) {
+                writes.insert(swap->getFirstRelation().getName());
+                writes.insert(swap->getSecondRelation().getName());
+            } else if (dynamic_cast<const RamAutoIncrement*>(&node) != nullptr) {
+                writes.insert(COUNTER);
+            } else if (dynamic_cast<const RamPackRecord*>(&node) != nullptr) {
+                writes.insert(RECORDS);
+            } else if (const auto* op = dynamic_cast<const RamIntrinsicOperator*>(&node)) {
+                // new symbols are numbered in the order they are interned
+                if (isSymbolicFunctorOp(op->getOperator())) {
+                    writes.insert(SYMBOLS);
+                }
+            } else if (const auto* op = dynamic_cast<const RamUserDefinedOperator*>(&node)) {
+                if (op->getType().back() == 'S') {
+                    writes.insert(SYMBOLS);
+                }
+            }
+        });
+        for (const auto& rel : writes) {
+            reads.erase(rel);
+        }
+
+        // a reader waits for the last writer
+        for (const auto& rel : reads) {
+            auto writer = lastWriter.find(rel);
+            if (writer != lastWriter.end()) {
+                predecessors[pos].insert(writer->second);
+            }
+            readers[rel].insert(pos);
+        }
+
+        // a writer waits for the last writer and all readers since
+        for (const auto& rel : writes) {
+            auto writer = lastWriter.find(rel);
+            if (writer != lastWriter.end()) {
+                predecessors[pos].insert(writer->second);
+            }
+            auto& relReaders = readers[rel];
+            predecessors[pos].insert(relReaders.begin(), relReaders.end());
+            relReaders.clear();
+            lastWriter[rel] = pos;
+        }
+    }
+}
+
+void RamStratumDependencyAnalysis::print(std::ostream& os) const {
+    os << "------ Stratum Dependencies -------\n";
+    for (size_t pos = 0; pos < strata.size(); ++pos) {
+        os << "Stratum " << strata[pos]->getIndex() << " depends on {";
+        bool first = true;
+        for (size_t pred : predecessors[pos]) {
+            os << (first ? "" : ", ") << strata[pred]->getIndex();
+            first = false;
+        }
+        os << "}\n";
+    }
+}
+
+}  // end of namespace souffle
@@ -0,0 +1,69 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RamStratumDependencyAnalysis.h
+ *
+ * Computes the dependencies between the strata of a RAM program, such that
+ * independent strata may be executed concurrently.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "RamAnalysis.h"
+#include "RamStatement.h"
+#include <cstddef>
+#include <iosfwd>
+#include <set>
+#include <vector>
+
+namespace souffle {
+
+class RamTranslationUnit;
+
+/**
+ * @class RamStratumDependencyAnalysis
+ * @brief A Ram Analysis determining which strata have to complete before a stratum may start
+ *
+ * Strata are numbered by their position in the main program. A stratum depends on
+ * every earlier stratum with which it shares a relation that either of them modifies,
+ * i.e. on the strata computing the relations it reads, and, if it drops a relation
+ * as per the expiry schedule, on every earlier stratum reading it. Strata emitting
+ * output to the console, generating counter values, records or new symbols are
+ * additionally kept in their original order so that the result of the program,
+ * including the numbering of symbols, stays the same.
+ */
+class RamStratumDependencyAnalysis : public RamAnalysis {
+public:
+    static constexpr const char* name = "stratum-dependency-analysis";
+
+    void run(const RamTranslationUnit& translationUnit) override;
+
+    void print(std::ostream& os) const override;
+
+    /** Get the strata of the main program in their sequential order */
+    const std::vector<const RamStratum*>& getStrata() const {
+        return strata;
+    }
+
+    /** Get the positions of the strata the stratum at the given position depends on */
+    const std::set<size_t>& getPredecessors(size_t pos) const {
+        return predecessors[pos];
+    }
+
+private:
+    /** strata in their sequential order */
+    std::vector<const RamStratum*> strata;
+
+    /** predecessors of each stratum */
+    std::vector<std::set<size_t>> predecessors;
+};
+
+}  // end of namespace souffle
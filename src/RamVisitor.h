@@ -126,6 +126,7 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(Clear);
         FORWARD(Drop);
         FORWARD(LogSize);
+        FORWARD(LogMemory);
 
         FORWARD(Merge);
         FORWARD(Swap);
@@ -141,13 +142,11 @@ struct RamVisitor : public ram_visitor_tag {
         FORWARD(DebugInfo);
         FORWARD(Stratum);
 
-#ifdef USE_MPI
-        // mpi
+        // message passing
         FORWARD(Send);
         FORWARD(Recv);
         FORWARD(Notify);
         FORWARD(Wait);
-#endif
 
 #undef FORWARD
 
@@ -178,6 +177,7 @@ protected:
     LINK(Clear, RelationStatement);
     LINK(Drop, RelationStatement);
     LINK(LogSize, RelationStatement);
+    LINK(LogMemory, RelationStatement);
 
     LINK(RelationStatement, Statement);
 
@@ -254,12 +254,10 @@ protected:
     LINK(Relation, Node);
     LINK(RelationReference, Node);
 
-#ifdef USE_MPI
     LINK(Send, RelationStatement);
     LINK(Recv, RelationStatement);
     LINK(Notify, Statement);
     LINK(Wait, Statement);
-#endif
 
 #undef LINK
 
@@ -29,7 +29,11 @@ enum class RelationRepresentation {
     // btree data-structure
     BRIE,
     // equivalence relation
-    EQREL
+    EQREL,
+    // sparse bit-map for unary relations
+    BITMAP,
+    // btree data-structure with hash indices for equality searches
+    HASH
 };
 
 inline std::ostream& operator<<(std::ostream& os, RelationRepresentation structure) {
@@ -43,6 +47,12 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation structu
         case RelationRepresentation::EQREL:
             os << "eqrel";
             break;
+        case RelationRepresentation::BITMAP:
+            os << "bitmap";
+            break;
+        case RelationRepresentation::HASH:
+            os << "hash";
+            break;
         case RelationRepresentation::DEFAULT:
         default:
             break;
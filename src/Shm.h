@@ -0,0 +1,694 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Shm.h
+ *
+ * Message passing between the processes of a program forked on a single
+ * node, through POSIX shared memory. The functions follow the subset of
+ * Mpi.h used by the generated code and the symbol table, such that the
+ * shm engine and the mpi engine run the same protocol.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace souffle {
+
+namespace shm {
+
+/** The source or tag of probe matching any message */
+constexpr int ANY = -1;
+
+/** The sender and tag of a message, named as the fields of MPI_Status */
+struct MessageStatus {
+    int MPI_SOURCE;
+    int MPI_TAG;
+};
+
+using Status = std::unique_ptr<MessageStatus>;
+
+namespace detail {
+
+/** The number of messages a mailbox holds initially, it grows whenever a sender finds it full */
+constexpr std::size_t MAILBOX_CAPACITY = 64;
+
+/** The size of payloads stored in the message itself rather than in a segment of their own */
+constexpr std::size_t INLINE_BYTES = 256;
+
+/** The size of the header of a segment, which holds the number of processes still to read it */
+constexpr std::size_t SEGMENT_HEADER = 64;
+
+/** The time after which waiting processes check whether the other processes are still alive */
+constexpr long POLL_NANOSECONDS = 100 * 1000 * 1000;
+
+struct Message {
+    int source;
+    int tag;
+    /** the size of the payload */
+    std::size_t size;
+    /** the payload if it fits, otherwise the name of the segment holding it */
+    char payload[INLINE_BYTES];
+};
+
+/**
+ * A mailbox, whose messages are held in a shared memory segment of their own. A sender never waits for
+ * the receiver, which may take messages out of order: it replaces a full segment by one twice as large.
+ */
+struct Mailbox {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    std::size_t count;
+    /** the number of messages the segment has room for */
+    std::size_t capacity;
+    /** the number of times the segment was replaced */
+    std::size_t generation;
+    /** the number of payload segments created by the process owning the mailbox */
+    std::size_t payloads;
+};
+
+/** The segment holding the messages of a mailbox, as mapped by this process */
+struct Messages {
+    std::size_t generation = 0;
+    std::size_t capacity = 0;
+    Message* messages = nullptr;
+};
+
+struct State {
+    int rank = 0;
+    int size = 1;
+    pid_t master = 0;
+    /** the mailboxes of all processes, shared by them */
+    Mailbox* mailboxes = nullptr;
+    /** the messages of the mailboxes, as mapped by this process */
+    std::vector<Messages> messages;
+    /** the worker processes forked by the master process, which have not terminated yet */
+    std::vector<pid_t> workers;
+};
+
+/** The state of this process, shared by all translation units of a program */
+inline State& state() {
+    static State state;
+    return state;
+}
+
+inline void fail(const std::string& message) {
+    std::cerr << "Error in shared memory engine: " << message << " (" << std::strerror(errno) << ")\n";
+    std::exit(EXIT_FAILURE);
+}
+
+/** The name of the segment holding the messages of a mailbox */
+inline std::string segmentName(const int rank, const std::size_t generation) {
+    return "/souffle." + std::to_string(state().master) + ".mailbox." + std::to_string(rank) + "." +
+           std::to_string(generation);
+}
+
+/** The name of the i-th segment holding a payload sent by a process */
+inline std::string payloadName(const int rank, const std::size_t i) {
+    return "/souffle." + std::to_string(state().master) + "." + std::to_string(rank) + "." +
+           std::to_string(i);
+}
+
+/** Map the segment holding the given number of messages, creating it if requested */
+inline Message* mapMessages(const std::string& name, const std::size_t capacity, const bool create) {
+    const int fd = create ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR)
+                          : shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        fail("cannot open segment " + name);
+    }
+    if (create && ftruncate(fd, (off_t)(capacity * sizeof(Message))) != 0) {
+        fail("cannot resize segment " + name);
+    }
+    void* base = mmap(nullptr, capacity * sizeof(Message), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fail("cannot map segment " + name);
+    }
+    return static_cast<Message*>(base);
+}
+
+/** Unmap the segments of the mailboxes, and remove them in the master process */
+inline void unmapMessages() {
+    auto& s = state();
+    for (int rank = 0; rank < (int)s.messages.size(); ++rank) {
+        Messages& mapped = s.messages[rank];
+        if (mapped.messages != nullptr) {
+            munmap(mapped.messages, mapped.capacity * sizeof(Message));
+        }
+        if (s.rank == 0) {
+            shm_unlink(segmentName(rank, s.mailboxes[rank].generation).c_str());
+        }
+    }
+    s.messages.clear();
+}
+
+/**
+ * Terminate the master process after a worker process terminated abnormally. The other workers are
+ * terminated as well, and the segments any of them may have left behind are removed.
+ */
+inline void abortWorkers() {
+    auto& s = state();
+    for (const pid_t worker : s.workers) {
+        kill(worker, SIGTERM);
+    }
+    for (const pid_t worker : s.workers) {
+        waitpid(worker, nullptr, 0);
+    }
+    s.workers.clear();
+    for (int rank = 0; rank < s.size; ++rank) {
+        const Mailbox& mailbox = s.mailboxes[rank];
+        // a process may have terminated while replacing the segment of a mailbox
+        shm_unlink(segmentName(rank, mailbox.generation + 1).c_str());
+        // or before the payloads it sent were read
+        for (std::size_t i = 0; i < mailbox.payloads; ++i) {
+            shm_unlink(payloadName(rank, i).c_str());
+        }
+    }
+    unmapMessages();
+    std::cerr << "Error in shared memory engine: worker process terminated abnormally\n";
+    std::exit(EXIT_FAILURE);
+}
+
+/** Terminate if another process of the program terminated abnormally */
+inline void checkProcesses() {
+    auto& s = state();
+    if (s.rank != 0) {
+        if (getppid() != s.master) {
+            std::cerr << "Error in shared memory engine: master process terminated\n";
+            std::_Exit(EXIT_FAILURE);
+        }
+        return;
+    }
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        s.workers.erase(std::remove(s.workers.begin(), s.workers.end(), pid), s.workers.end());
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            abortWorkers();
+        }
+    }
+}
+
+/** Wait for a change of a locked mailbox, checking the other processes from time to time */
+inline void wait(Mailbox& mailbox) {
+    timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += POLL_NANOSECONDS;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    if (pthread_cond_timedwait(&mailbox.changed, &mailbox.mutex, &deadline) == ETIMEDOUT) {
+        checkProcesses();
+    }
+}
+
+/** The i-th message of the locked mailbox of a process, mapping its segment again if it was replaced */
+inline Message& message(const int rank, const std::size_t i) {
+    auto& s = state();
+    const Mailbox& mailbox = s.mailboxes[rank];
+    Messages& mapped = s.messages[rank];
+    if (mapped.generation != mailbox.generation) {
+        munmap(mapped.messages, mapped.capacity * sizeof(Message));
+        mapped.generation = mailbox.generation;
+        mapped.capacity = mailbox.capacity;
+        mapped.messages = mapMessages(segmentName(rank, mailbox.generation), mailbox.capacity, false);
+    }
+    return mapped.messages[i];
+}
+
+/** Replace the segment of the full, locked mailbox of a process by one twice as large */
+inline void grow(const int rank) {
+    auto& s = state();
+    Mailbox& mailbox = s.mailboxes[rank];
+    const std::size_t capacity = 2 * mailbox.capacity;
+    Message* messages = mapMessages(segmentName(rank, mailbox.generation + 1), capacity, true);
+    for (std::size_t i = 0; i < mailbox.count; ++i) {
+        messages[i] = message(rank, i);
+    }
+    // processes still mapping the old segment map the new one before their next access
+    Messages& mapped = s.messages[rank];
+    munmap(mapped.messages, mapped.capacity * sizeof(Message));
+    shm_unlink(segmentName(rank, mailbox.generation).c_str());
+    mailbox.capacity = capacity;
+    ++mailbox.generation;
+    mapped.generation = mailbox.generation;
+    mapped.capacity = capacity;
+    mapped.messages = messages;
+}
+
+/** Find the first message of the locked mailbox of a process matching the given source and tag */
+inline std::size_t find(const int rank, const int source, const int tag) {
+    const Mailbox& mailbox = state().mailboxes[rank];
+    for (std::size_t i = 0; i < mailbox.count; ++i) {
+        const Message& current = message(rank, i);
+        if ((source == ANY || current.source == source) && (tag == ANY || current.tag == tag)) {
+            return i;
+        }
+    }
+    return mailbox.count;
+}
+
+/** Put a message into the mailbox of a process, growing it if it is full */
+inline void deliver(const int destination, const Message& sent) {
+    assert(0 <= destination && destination < state().size && "invalid destination");
+    Mailbox& mailbox = state().mailboxes[destination];
+    pthread_mutex_lock(&mailbox.mutex);
+    if (mailbox.count == mailbox.capacity) {
+        grow(destination);
+    }
+    message(destination, mailbox.count) = sent;
+    ++mailbox.count;
+    pthread_cond_broadcast(&mailbox.changed);
+    pthread_mutex_unlock(&mailbox.mutex);
+}
+
+/** Take the first message matching the given source and tag out of the mailbox of this process */
+inline Message take(const int source, const int tag) {
+    const int rank = state().rank;
+    Mailbox& mailbox = state().mailboxes[rank];
+    pthread_mutex_lock(&mailbox.mutex);
+    std::size_t i;
+    while ((i = find(rank, source, tag)) == mailbox.count) {
+        wait(mailbox);
+    }
+    const Message taken = message(rank, i);
+    // close the gap, keeping the order of the remaining messages
+    for (; i + 1 < mailbox.count; ++i) {
+        message(rank, i) = message(rank, i + 1);
+    }
+    --mailbox.count;
+    pthread_mutex_unlock(&mailbox.mutex);
+    return taken;
+}
+
+/**
+ * Send a payload of the given size to the given destinations. The payload is written once by the given
+ * function, into the message if it is small, and otherwise into a shared memory segment, which the last
+ * of the destinations to read it removes.
+ */
+template <typename Writer>
+inline void post(const std::set<int>& destinations, const int tag, const std::size_t size, Writer write) {
+    auto& s = state();
+    Message message;
+    message.source = s.rank;
+    message.tag = tag;
+    message.size = size;
+    if (size <= INLINE_BYTES) {
+        write(message.payload);
+    } else {
+        // counted before it is created, such that the master process finds it if this process fails
+        const std::string name = payloadName(s.rank, s.mailboxes[s.rank].payloads++);
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        if (fd < 0) {
+            fail("cannot create segment " + name);
+        }
+        if (ftruncate(fd, (off_t)(SEGMENT_HEADER + size)) != 0) {
+            fail("cannot resize segment " + name);
+        }
+        void* base = mmap(nullptr, SEGMENT_HEADER + size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            fail("cannot map segment " + name);
+        }
+        new (base) std::atomic<int>((int)destinations.size());
+        write(static_cast<char*>(base) + SEGMENT_HEADER);
+        munmap(base, SEGMENT_HEADER + size);
+        std::strncpy(message.payload, name.c_str(), INLINE_BYTES - 1);
+        message.payload[INLINE_BYTES - 1] = '\0';
+    }
+    for (const int destination : destinations) {
+        deliver(destination, message);
+    }
+}
+
+/** The payload of a received message, which is released along with this object */
+class Payload {
+public:
+    explicit Payload(const Message& message) : message(message) {
+        if (message.size <= INLINE_BYTES) {
+            data = this->message.payload;
+            return;
+        }
+        const int fd = shm_open(message.payload, O_RDWR, 0);
+        if (fd < 0) {
+            fail(std::string("cannot open segment ") + message.payload);
+        }
+        base = mmap(nullptr, SEGMENT_HEADER + message.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            fail(std::string("cannot map segment ") + message.payload);
+        }
+        data = static_cast<const char*>(base) + SEGMENT_HEADER;
+    }
+
+    Payload(const Payload&) = delete;
+    Payload& operator=(const Payload&) = delete;
+
+    ~Payload() {
+        if (base == nullptr) {
+            return;
+        }
+        const bool last = --*static_cast<std::atomic<int>*>(base) == 0;
+        munmap(base, SEGMENT_HEADER + message.size);
+        if (last) {
+            shm_unlink(message.payload);
+        }
+    }
+
+    const char* begin() const {
+        return data;
+    }
+
+    std::size_t size() const {
+        return message.size;
+    }
+
+private:
+    const Message message;
+    void* base = nullptr;
+    const char* data = nullptr;
+};
+
+template <typename T>
+inline void read(const char*& position, T& value) {
+    std::memcpy(&value, position, sizeof(T));
+    position += sizeof(T);
+}
+
+template <typename T>
+inline void write(char*& position, const T& value) {
+    std::memcpy(position, &value, sizeof(T));
+    position += sizeof(T);
+}
+}  // namespace detail
+
+/* init */
+
+/**
+ * Fork the given number of processes minus one, which share the mailboxes created here. The calling
+ * process becomes the master process of rank 0.
+ */
+inline void init(const int size) {
+    auto& s = detail::state();
+    s.size = size;
+    s.master = getpid();
+    void* mailboxes = mmap(nullptr, size * sizeof(detail::Mailbox), PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mailboxes == MAP_FAILED) {
+        detail::fail("cannot map mailboxes");
+    }
+    s.mailboxes = static_cast<detail::Mailbox*>(mailboxes);
+    s.messages.resize(size);
+    pthread_mutexattr_t mutexAttributes;
+    pthread_mutexattr_init(&mutexAttributes);
+    pthread_mutexattr_setpshared(&mutexAttributes, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_t condAttributes;
+    pthread_condattr_init(&condAttributes);
+    pthread_condattr_setpshared(&condAttributes, PTHREAD_PROCESS_SHARED);
+    for (int i = 0; i < size; ++i) {
+        detail::Mailbox& mailbox = s.mailboxes[i];
+        pthread_mutex_init(&mailbox.mutex, &mutexAttributes);
+        pthread_cond_init(&mailbox.changed, &condAttributes);
+        mailbox.count = 0;
+        mailbox.capacity = detail::MAILBOX_CAPACITY;
+        mailbox.generation = 0;
+        mailbox.payloads = 0;
+        s.messages[i].capacity = detail::MAILBOX_CAPACITY;
+        s.messages[i].messages =
+                detail::mapMessages(detail::segmentName(i, 0), detail::MAILBOX_CAPACITY, true);
+    }
+    pthread_mutexattr_destroy(&mutexAttributes);
+    pthread_condattr_destroy(&condAttributes);
+
+    // buffered output would be written by every process
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    for (int rank = 1; rank < size; ++rank) {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            detail::fail("cannot fork worker process");
+        }
+        if (pid == 0) {
+            s.rank = rank;
+            s.workers.clear();
+            return;
+        }
+        s.workers.push_back(pid);
+    }
+}
+
+/* finalize */
+
+/** Wait for the worker processes in the master process, terminating if one of them failed */
+inline void finalize() {
+    auto& s = detail::state();
+    if (s.rank == 0) {
+        while (!s.workers.empty()) {
+            int status;
+            const bool failed = waitpid(s.workers.front(), &status, 0) < 0 || !WIFEXITED(status) ||
+                                WEXITSTATUS(status) != 0;
+            s.workers.erase(s.workers.begin());
+            if (failed) {
+                detail::abortWorkers();
+            }
+        }
+    }
+    detail::unmapMessages();
+    munmap(s.mailboxes, s.size * sizeof(detail::Mailbox));
+    s.mailboxes = nullptr;
+}
+
+/* commSize */
+
+inline int commSize() {
+    return detail::state().size;
+}
+
+/* commRank */
+
+inline int commRank() {
+    return detail::state().rank;
+}
+
+/* probe */
+
+/** Wait for a message matching the given source and tag, without receiving it */
+inline Status probe(const int source, const int tag) {
+    const int rank = commRank();
+    detail::Mailbox& mailbox = detail::state().mailboxes[rank];
+    pthread_mutex_lock(&mailbox.mutex);
+    std::size_t i;
+    while ((i = detail::find(rank, source, tag)) == mailbox.count) {
+        detail::wait(mailbox);
+    }
+    const detail::Message& message = detail::message(rank, i);
+    auto status = Status(new MessageStatus({message.source, message.tag}));
+    pthread_mutex_unlock(&mailbox.mutex);
+    return status;
+}
+
+inline Status probe() {
+    return probe(ANY, ANY);
+}
+
+/* send */
+
+template <typename S>
+inline void send(const std::vector<S>& data, const int destination, const int tag) {
+    static_assert(std::is_trivially_copyable<S>::value, "values are sent as they are in memory");
+    const std::size_t size = data.size() * sizeof(S);
+    detail::post({destination}, tag, size, [&](char* position) {
+        if (size > 0) {
+            std::memcpy(position, data.data(), size);
+        }
+    });
+}
+
+inline void send(const std::string& data, const int destination, const int tag) {
+    detail::post({destination}, tag, data.size(),
+            [&](char* position) { std::memcpy(position, data.data(), data.size()); });
+}
+
+inline void send(const std::vector<std::string>& data, const int destination, const int tag) {
+    std::size_t size = sizeof(std::size_t);
+    for (const auto& element : data) {
+        size += sizeof(std::size_t) + element.size();
+    }
+    detail::post({destination}, tag, size, [&](char* position) {
+        detail::write(position, data.size());
+        for (const auto& element : data) {
+            detail::write(position, element.size());
+            std::memcpy(position, element.data(), element.size());
+            position += element.size();
+        }
+    });
+}
+
+template <typename S>
+inline void send(const S& data, const int destination, const int tag) {
+    send(std::vector<S>({data}), destination, tag);
+}
+
+template <typename S>
+inline void send(const S& data, const Status& status) {
+    send(data, status->MPI_SOURCE, status->MPI_TAG);
+}
+
+inline void send(const int destination, const int tag) {
+    detail::post({destination}, tag, 0, [](char*) {});
+}
+
+inline void send(const Status& status) {
+    send(status->MPI_SOURCE, status->MPI_TAG);
+}
+
+/**
+ * Sends the tuples of a relation to the given destinations. The tuples are written once, straight into
+ * the payload read by all destinations.
+ */
+template <typename S, typename T>
+inline void send(const T& data, const std::size_t length, const std::set<int>& destinations, const int tag) {
+    if (length == 0) {
+        const char flag = data.empty() ? 0 : 1;
+        detail::post(destinations, tag, 1, [&](char* position) { *position = flag; });
+        return;
+    }
+    const std::size_t count = data.size();
+    const std::size_t size = sizeof(std::size_t) + count * length * sizeof(S);
+    detail::post(destinations, tag, size, [&](char* position) {
+        detail::write(position, count);
+        for (const auto& element : data) {
+            for (std::size_t j = 0; j < length; ++j) {
+                detail::write(position, static_cast<S>(element[j]));
+            }
+        }
+    });
+}
+
+template <typename S, typename T>
+inline void send(const T& data, const std::size_t length, const int destination, const int tag) {
+    send<S>(data, length, std::set<int>({destination}), tag);
+}
+
+/* recv */
+
+template <typename R>
+inline void recv(std::vector<R>& data, Status& status) {
+    static_assert(std::is_trivially_copyable<R>::value, "values are received as they are in memory");
+    detail::Payload payload(detail::take(status->MPI_SOURCE, status->MPI_TAG));
+    data.resize(payload.size() / sizeof(R));
+    if (!data.empty()) {
+        std::memcpy(&data[0], payload.begin(), data.size() * sizeof(R));
+    }
+}
+
+inline void recv(std::string& data, Status& status) {
+    detail::Payload payload(detail::take(status->MPI_SOURCE, status->MPI_TAG));
+    data.assign(payload.begin(), payload.size());
+}
+
+inline void recv(std::vector<std::string>& data, Status& status) {
+    detail::Payload payload(detail::take(status->MPI_SOURCE, status->MPI_TAG));
+    const char* position = payload.begin();
+    std::size_t count;
+    detail::read(position, count);
+    data.clear();
+    data.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t length;
+        detail::read(position, length);
+        data.emplace_back(position, length);
+        position += length;
+    }
+}
+
+template <typename R>
+inline void recv(R& data, Status& status) {
+    std::vector<R> newData;
+    recv(newData, status);
+    data = newData.at(0);
+}
+
+template <typename R>
+inline void recv(R& data, const int source, const int tag) {
+    auto status = probe(source, tag);
+    recv(data, status);
+}
+
+inline void recv(const int source, const int tag) {
+    detail::Payload payload(detail::take(source, tag));
+}
+
+inline void recv(Status& status) {
+    recv(status->MPI_SOURCE, status->MPI_TAG);
+}
+
+/** Receives the tuples of a relation sent by send, inserting them straight from the payload */
+template <typename R, typename T>
+inline void recv(T& data, const std::size_t length, Status& status) {
+    detail::Payload payload(detail::take(status->MPI_SOURCE, status->MPI_TAG));
+    if (length == 0) {
+        if (*payload.begin() != 0) {
+            auto element = std::unique_ptr<R[]>(new R[1]());
+            const auto* ptr = element.get();
+            data.insert(ptr);
+        }
+        return;
+    }
+    const char* position = payload.begin();
+    std::size_t count;
+    detail::read(position, count);
+    auto element = std::unique_ptr<R[]>(new R[length]());
+    const auto* ptr = element.get();
+    for (std::size_t i = 0; i < count; ++i) {
+        std::memcpy(element.get(), position, length * sizeof(R));
+        position += length * sizeof(R);
+        data.insert(ptr);
+    }
+}
+
+template <typename R, typename T>
+inline void recv(T& data, const std::size_t length, const int source, const int tag) {
+    auto status = probe(source, tag);
+    recv<R>(data, length, status);
+}
+
+}  // namespace shm
+
+}  // namespace souffle
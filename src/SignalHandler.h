@@ -43,12 +43,12 @@ public:
     void enableLogging() {
         logMessages = true;
     }
-    // set signal message
+    // set signal message; strata running concurrently set it under a lock, such that the
+    // message is the one of the rule started last
     void setMsg(const char* m) {
+        std::lock_guard<std::mutex> guard(msgLock);
         if (logMessages && m != nullptr) {
-            static std::mutex outputMutex;
             static bool sameLine = false;
-            std::lock_guard<std::mutex> guard(outputMutex);
             if (msg != nullptr && strcmp(m, msg) == 0) {
                 std::cout << ".";
                 sameLine = true;
@@ -135,6 +135,9 @@ private:
     // signal context information
     std::atomic<const char*> msg;
 
+    // lock for setting the signal context information
+    std::mutex msgLock;
+
     // state of signal handler
     bool isSet = false;
 
@@ -20,9 +20,17 @@
 #include "RamTypes.h"
 #include "Util.h"
 
+#if defined(USE_MPI) || defined(USE_SHM)
 #ifdef USE_MPI
 #include "Mpi.h"
+#else
+#include "Shm.h"
+#endif
+#include <array>
+#include <map>
+#include <set>
 #include <thread>
+#include <unordered_set>
 #endif
 
 #include <cassert>
@@ -34,6 +42,15 @@
 
 namespace souffle {
 
+#if defined(USE_MPI) || defined(USE_SHM)
+/** The message passing of the engine the program is compiled for */
+#ifdef USE_MPI
+namespace ipc = mpi;
+#else
+namespace ipc = shm;
+#endif
+#endif
+
 /**
  * @class SymbolTable
  *
@@ -42,9 +59,8 @@ namespace souffle {
  * SymbolTable stores Datalog symbols and converts them to numbers and vice versa.
  */
 class SymbolTable {
-#ifdef USE_MPI
-
 private:
+    /** The tags of the messages sent to rank 0 by the processes of the mpi and shm engines */
     enum {
         EXIT = 0,
         INSERT_STRING = 1,
@@ -58,97 +74,175 @@ private:
         UNSAFE_RESOLVE = 9
     };
 
-    mutable std::unordered_map<std::string, size_t> strToNumCache;
-    mutable std::unordered_map<size_t, std::string> numToStrCache;
+#if defined(USE_MPI) || defined(USE_SHM)
 
-    RamDomain cacheLookup(const std::string& symbol, const int tag) const {
-        auto lease = access.acquire();
+    /** The number of shards of the symbols cached by a worker process */
+    static constexpr size_t CACHE_SHARDS = 16;
+
+    /** A shard of the cache mapping strings to indices */
+    struct StrToNumShard {
+        Lock access;
+        std::unordered_map<std::string, RamDomain> map;
+    };
+
+    /** A shard of the cache mapping indices to strings */
+    struct NumToStrShard {
+        Lock access;
+        std::unordered_map<RamDomain, std::string> map;
+    };
+
+    /** The symbols known to a worker process, sharded to not serialize the threads looking them up */
+    mutable std::array<StrToNumShard, CACHE_SHARDS> strToNumCache;
+    mutable std::array<NumToStrShard, CACHE_SHARDS> numToStrCache;
+
+    /** A lock to serialize the requests of the threads of a worker process to rank 0 */
+    mutable Lock exchange;
+
+    /** The symbols already sent to each destination along with relations */
+    mutable std::map<int, std::unordered_set<RamDomain>> sentSymbols;
+    mutable Lock sentAccess;
+
+    StrToNumShard& getShard(const std::string& symbol) const {
+        return strToNumCache[std::hash<std::string>()(symbol) % CACHE_SHARDS];
+    }
+
+    NumToStrShard& getShard(const RamDomain index) const {
+        return numToStrCache[static_cast<size_t>(index) % CACHE_SHARDS];
+    }
+
+    /** Add a symbol to the cache, returning the cached string */
+    const std::string& cache(const RamDomain index, const std::string& symbol) const {
+        {
+            auto& shard = getShard(symbol);
+            auto lease = shard.access.acquire();
+            (void)lease;  // avoid warning;
+            shard.map.insert(std::make_pair(symbol, index));
+        }
+        auto& shard = getShard(index);
+        auto lease = shard.access.acquire();
         (void)lease;  // avoid warning;
-        auto it = strToNumCache.find(symbol);
-        if (it != strToNumCache.end()) {
-            return it->second;
+        return shard.map.insert(std::make_pair(index, symbol)).first->second;
+    }
+
+    /** Find a symbol in the cache, returning nullptr if it is not there */
+    const std::string* findCached(const RamDomain index) const {
+        auto& shard = getShard(index);
+        auto lease = shard.access.acquire();
+        (void)lease;  // avoid warning;
+        auto it = shard.map.find(index);
+        return (it != shard.map.end()) ? &it->second : nullptr;
+    }
+
+    RamDomain cacheLookup(const std::string& symbol, const int tag) const {
+        {
+            auto& shard = getShard(symbol);
+            auto lease = shard.access.acquire();
+            (void)lease;  // avoid warning;
+            auto it = shard.map.find(symbol);
+            if (it != shard.map.end()) {
+                return it->second;
+            }
         }
-        mpi::send(symbol, 0, tag);
         RamDomain index;
-        mpi::recv(index, 0, tag);
-        strToNumCache.insert(std::pair<std::string, size_t>(symbol, index));
-        return numToStrCache.insert(std::pair<size_t, std::string>(index, symbol)).first->first;
+        {
+            auto lease = exchange.acquire();
+            (void)lease;  // avoid warning;
+            ipc::send(symbol, 0, tag);
+            ipc::recv(index, 0, tag);
+        }
+        cache(index, symbol);
+        return index;
     }
+
     const std::string& cacheResolve(const RamDomain index, const int tag) const {
-        auto lease = access.acquire();
-        (void)lease;  // avoid warning;
-        auto it = numToStrCache.find(index);
-        if (it != numToStrCache.end()) {
-            return it->second;
+        if (const std::string* symbol = findCached(index)) {
+            return *symbol;
         }
-        mpi::send(index, 0, tag);
         std::string symbol;
-        mpi::recv(symbol, 0, tag);
-        numToStrCache.insert(std::pair<size_t, std::string>(index, symbol));
-        return strToNumCache.insert(std::pair<std::string, size_t>(symbol, index)).first->first;
+        {
+            auto lease = exchange.acquire();
+            (void)lease;  // avoid warning;
+            ipc::send(index, 0, tag);
+            ipc::recv(symbol, 0, tag);
+        }
+        return cache(index, symbol);
+    }
+
+    /** Collect the values of the symbol columns of a relation */
+    template <typename T>
+    static std::vector<RamDomain> getSymbols(const T& relation, const std::vector<bool>& symbolMask) {
+        std::vector<RamDomain> indices;
+        for (const auto& tuple : relation) {
+            for (size_t i = 0; i < symbolMask.size(); ++i) {
+                if (symbolMask[i]) {
+                    indices.push_back(tuple[i]);
+                }
+            }
+        }
+        return indices;
     }
 
 public:
     void handleMpiMessages(const size_t count) {
-        assert(mpi::commRank() == 0);
+        assert(ipc::commRank() == 0);
         auto semaphor = count;
         while (semaphor) {
-            auto status = mpi::probe();
+            auto status = ipc::probe();
             switch (status->MPI_TAG) {
                 case EXIT: {
-                    mpi::recv(status->MPI_SOURCE, EXIT);
+                    ipc::recv(status->MPI_SOURCE, EXIT);
                     --semaphor;
                     break;
                 }
                 case LOOKUP: {
                     std::string symbol;
-                    mpi::recv(symbol, status);
-                    mpi::send(lookup(symbol), status);
+                    ipc::recv(symbol, status);
+                    ipc::send(lookup(symbol), status);
                     break;
                 }
                 case LOOKUP_EXISTING: {
                     std::string symbol;
-                    mpi::recv(symbol, status);
-                    mpi::send(lookupExisting(symbol), status);
+                    ipc::recv(symbol, status);
+                    ipc::send(lookupExisting(symbol), status);
                     break;
                 }
                 case UNSAFE_LOOKUP: {
                     std::string symbol;
-                    mpi::recv(symbol, status);
-                    mpi::send(unsafeLookup(symbol), status);
+                    ipc::recv(symbol, status);
+                    ipc::send(unsafeLookup(symbol), status);
                     break;
                 }
                 case RESOLVE: {
                     RamDomain index;
-                    mpi::recv(index, status);
-                    mpi::send(resolve(index), status);
+                    ipc::recv(index, status);
+                    ipc::send(resolve(index), status);
                     break;
                 }
                 case UNSAFE_RESOLVE: {
                     RamDomain index;
-                    mpi::recv(index, status);
-                    mpi::send(unsafeResolve(index), status);
+                    ipc::recv(index, status);
+                    ipc::send(unsafeResolve(index), status);
                     break;
                 }
                 case SIZE: {
-                    mpi::recv(status);
-                    mpi::send(size(), status);
+                    ipc::recv(status);
+                    ipc::send(size(), status);
                     break;
                 }
                 case PRINT: {
-                    mpi::recv(status);
+                    ipc::recv(status);
                     print(std::cout);
                     break;
                 }
                 case INSERT_STRING: {
                     std::string symbol;
-                    mpi::recv(symbol, status);
+                    ipc::recv(symbol, status);
                     insert(symbol);
                     break;
                 }
                 case INSERT_VECTOR_STRING: {
                     std::vector<std::string> symbols;
-                    mpi::recv(symbols, status);
+                    ipc::recv(symbols, status);
                     insert(symbols);
                     break;
                 }
@@ -159,10 +253,63 @@ public:
             }
         }
         for (size_t i = 0; i < count; ++i) {
-            mpi::send(i + 1, EXIT);
+            ipc::send(i + 1, EXIT);
+        }
+    }
+
+    /**
+     * Send the symbols of a relation sent to the given destinations before, such that they can resolve
+     * them without asking rank 0. Only the symbols this process knows and did not send to a destination
+     * yet are sent, as a list of indices followed by a list of strings. Rank 0 is skipped.
+     */
+    template <typename T>
+    void sendSymbols(const T& relation, const std::vector<bool>& symbolMask,
+            const std::set<int>& destinations, const int tag) const {
+        const auto indices = getSymbols(relation, symbolMask);
+        auto lease = sentAccess.acquire();
+        (void)lease;  // avoid warning;
+        for (const auto destination : destinations) {
+            // rank 0 holds all symbols, it only receives the output relations
+            if (destination == 0) {
+                continue;
+            }
+            auto& sent = sentSymbols[destination];
+            std::vector<RamDomain> delta;
+            std::vector<std::string> symbols;
+            for (const RamDomain index : indices) {
+                if (sent.count(index) != 0) {
+                    continue;
+                }
+                const std::string* symbol =
+                        (ipc::commRank() == 0) ? &numToStr[static_cast<size_t>(index)] : findCached(index);
+                if (symbol != nullptr) {
+                    sent.insert(index);
+                    delta.push_back(index);
+                    symbols.push_back(*symbol);
+                }
+            }
+            ipc::send(delta, destination, tag);
+            ipc::send(symbols, destination, tag);
         }
     }
 
+    /** Receive the symbols sent along with a relation by sendSymbols, which sends none to rank 0 */
+    void recvSymbols(const int source, const int tag) const {
+        if (ipc::commRank() == 0) {
+            return;
+        }
+        std::vector<RamDomain> indices;
+        ipc::recv(indices, source, tag);
+        std::vector<std::string> symbols;
+        ipc::recv(symbols, source, tag);
+        for (size_t i = 0; i < indices.size(); ++i) {
+            cache(indices[i], symbols[i]);
+        }
+    }
+
+#endif
+
+public:
     static int numberOfTags() {
         // ok, so this looks stupid, but it just gives the size of the enum at the top
         return 10;
@@ -172,8 +319,6 @@ public:
         return (int)EXIT;
     }
 
-#endif
-
 private:
     /** A lock to synchronize parallel accesses */
     mutable Lock access;
@@ -250,8 +395,8 @@ public:
     /** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
      * already. */
     RamDomain lookup(const std::string& symbol) {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
             return cacheLookup(symbol, LOOKUP);
         } else
 #endif
@@ -264,8 +409,8 @@ public:
 
     /** Finds the index of a symbol in the table, giving an error if it's not found */
     RamDomain lookupExisting(const std::string& symbol) const {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
             return cacheLookup(symbol, LOOKUP_EXISTING);
         } else
 #endif
@@ -284,8 +429,8 @@ public:
     /** Find the index of a symbol in the table, inserting a new symbol if it does not exist there
      * already. */
     RamDomain unsafeLookup(const std::string& symbol) {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
             return cacheLookup(symbol, UNSAFE_LOOKUP);
         } else
 #endif
@@ -296,8 +441,8 @@ public:
      * bounds.
      */
     const std::string& resolve(const RamDomain index) const {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
             return cacheResolve(index, RESOLVE);
         } else
 #endif
@@ -315,8 +460,8 @@ public:
     }
 
     const std::string& unsafeResolve(const RamDomain index) const {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
             return cacheResolve(index, UNSAFE_RESOLVE);
         } else
 #endif
@@ -325,11 +470,11 @@ public:
 
     /* Return the size of the symbol table, being the number of symbols it currently holds. */
     size_t size() const {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
-            mpi::send(0, SIZE);
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
+            ipc::send(0, SIZE);
             size_t size;
-            mpi::recv(size, 0, SIZE);
+            ipc::recv(size, 0, SIZE);
             return size;
         } else
 #endif
@@ -340,9 +485,9 @@ public:
      * inserts
      * of single symbols. */
     void insert(const std::vector<std::string>& symbols) {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
-            mpi::send(symbols, 0, INSERT_VECTOR_STRING);
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
+            ipc::send(symbols, 0, INSERT_VECTOR_STRING);
         } else
 #endif
         {
@@ -359,9 +504,9 @@ public:
      * symbols
      * in bulk. */
     void insert(const std::string& symbol) {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
-            mpi::send(symbol, 0, INSERT_STRING);
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
+            ipc::send(symbol, 0, INSERT_STRING);
         } else
 #endif
         {
@@ -373,9 +518,9 @@ public:
 
     /** Print the symbol table to the given stream. */
     void print(std::ostream& out) const {
-#ifdef USE_MPI
-        if (mpi::commRank() != 0) {
-            mpi::send(0, PRINT);
+#if defined(USE_MPI) || defined(USE_SHM)
+        if (ipc::commRank() != 0) {
+            ipc::send(0, PRINT);
         } else
 #endif
         {
@@ -26,6 +26,7 @@
 #include "RamOperation.h"
 #include "RamProgram.h"
 #include "RamRelation.h"
+#include "RamStratumDependencyAnalysis.h"
 #include "RamTranslationUnit.h"
 #include "RamVisitor.h"
 #include "RelationRepresentation.h"
@@ -36,6 +37,7 @@
 #include <cassert>
 #include <cctype>
 #include <cstdlib>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <sstream>
@@ -141,8 +143,68 @@ void Synthesiser::generateRelationTypeStruct(
     }
     typeCache.insert(relationType->getTypeName());
 
-    // Generate the type struct for the relation
-    relationType->generateTypeStruct(out);
+    // Generate the type struct for the relation; the provenance updaters nested in the
+    // struct would make its indexes dependent types if the struct were a template
+    if (!splitUnits || relationType->hasProvenance()) {
+        relationType->generateTypeStruct(out);
+        return;
+    }
+
+    // In split mode, the struct becomes a class template with a single instance, such
+    // that the header may declare the instance extern and the main unit instantiates
+    // the indexes used by the relation only once. The extern declaration does not keep
+    // the other units from instantiating methods defined in the class, as these are
+    // inline, so the methods operating on the indexes are only declared in the class
+    // and defined in the main unit.
+    std::stringstream type;
+    relationType->generateTypeStruct(type);
+    const std::string& name = relationType->getTypeName();
+    const std::string head = "struct " + name + " {";
+    std::string code = type.str();
+    if (code.compare(0, head.size(), head) != 0) {
+        out << code;
+        return;
+    }
+    out << "template <int> struct " << name << "_impl;\n";
+    out << "using " << name << " = " << name << "_impl<0>;\n";
+    out << "template <int> struct " << name << "_impl {\n";
+
+    // the struct has a line per statement, so a method starts with a line ending its head
+    std::stringstream lines(code.substr(head.size()));
+    std::stringstream definitions;
+    std::string line;
+    std::string previous;
+    int depth = 1;
+    for (std::getline(lines, line); std::getline(lines, line); previous = line) {
+        const size_t open = line.find('(');
+        const bool isMethodHead = depth == 1 && open != std::string::npos &&
+                                  line.compare(0, 7, "struct ") != 0 && endsWith(line, " {") &&
+                                  previous.compare(0, 9, "template ") != 0;
+        const size_t nameStart = line.rfind(' ', open) + 1;
+        const std::string method = line.substr(nameStart, open - nameStart);
+        const bool usesIndexes = line.find("context& h)") != std::string::npos || method == "insertAll" ||
+                                 method == "partition" || method == "purge" ||
+                                 method == "getMemoryUsageByIndex" || method == "printHintStatistics";
+        if (!isMethodHead || nameStart == 0 || !usesIndexes) {
+            out << line << "\n";
+            depth += std::count(line.begin(), line.end(), '{') - std::count(line.begin(), line.end(), '}');
+            continue;
+        }
+
+        // declare the method in the class, with a trailing return type outside of it
+        const std::string returnType = line.substr(0, nameStart - 1);
+        const std::string signature = line.substr(nameStart, line.size() - 2 - nameStart);
+        out << returnType << " " << signature << ";\n";
+        definitions << "template <int I>\nauto " << name << "_impl<I>::" << signature << " -> " << returnType
+                    << " {\n";
+        for (int body = 1; body > 0 && std::getline(lines, line);) {
+            body += std::count(line.begin(), line.end(), '{') - std::count(line.begin(), line.end(), '}');
+            definitions << line << "\n";
+        }
+    }
+    out << "extern template struct " << name << "_impl<0>;\n";
+    instantiatedTypes.push_back(name);
+    instantiatedMethods += definitions.str();
 }
 
 /* Convert SearchColums to a template index */
@@ -207,6 +269,70 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
         std::ostringstream preamble;
         bool preambleIssued = false;
 
+        /** the outermost operation of the current query */
+        const RamOperation* outerOperation = nullptr;
+
+        /** the inner scan of a collapsible loop nest, whose body is emitted as a lambda */
+        const RamRelationOperation* collapsedScan = nullptr;
+
+        /**
+         * Determine whether the tuples of the given relation are partitioned between the
+         * processes of a data-parallel run, i.e., whether it holds the delta of a recursive
+         * relation. Every process only evaluates the rules for the delta tuples it owns.
+         */
+        bool isPartitioned(const RamRelation& rel) const {
+            return Global::config().has("data-parallel") && rel.getName().compare(0, 7, "@delta_") == 0;
+        }
+
+        /**
+         * The relations computed by the fixpoint loop being emitted, if they are partitioned between
+         * the processes of a data-parallel run. Each process then only holds the tuples it owns of the
+         * tuples derived by the loop, which is possible if no rule of the loop reads the relations
+         * beyond the delta, apart from testing whether a derived tuple is new.
+         */
+        std::vector<const RamRelation*> partitionedRelations;
+
+        /** Determine the relations of a fixpoint loop which may be partitioned in a data-parallel run */
+        std::vector<const RamRelation*> getPartitionedRelations(const RamLoop& loop) const {
+            const RamProgram& prog = *synthesiser.getTranslationUnit().getProgram();
+            std::vector<const RamRelation*> relations;
+            visitDepthFirst(loop, [&](const RamExit& exit) {
+                visitDepthFirst(exit.getCondition(), [&](const RamEmptinessCheck& emptiness) {
+                    const std::string& name = emptiness.getRelation().getName();
+                    if (name.compare(0, 5, "@new_") == 0) {
+                        relations.push_back(prog.getRelation(name.substr(5)));
+                    }
+                });
+            });
+            auto isComputed = [&](const RamRelation& rel) {
+                return std::find(relations.begin(), relations.end(), &rel) != relations.end();
+            };
+            bool partitionable = true;
+            for (const RamRelation* rel : relations) {
+                partitionable = partitionable && rel != nullptr &&
+                                rel->getRepresentation() != RelationRepresentation::EQREL;
+            }
+            std::set<const RamNode*> negated;
+            visitDepthFirst(
+                    loop, [&](const RamNegation& negation) { negated.insert(&negation.getOperand()); });
+            visitDepthFirst(loop, [&](const RamNode& node) {
+                if (const auto* scan = dynamic_cast<const RamRelationOperation*>(&node)) {
+                    partitionable = partitionable && !isComputed(scan->getRelation());
+                } else if (const auto* exists = dynamic_cast<const RamAbstractExistenceCheck*>(&node)) {
+                    partitionable = partitionable &&
+                                    (negated.count(exists) > 0 || !isComputed(exists->getRelation()));
+                }
+            });
+            return partitionable ? relations : std::vector<const RamRelation*>();
+        }
+
+        /** Emit the conjunct testing whether the tuple bound by the operation is owned by this process */
+        void emitOwnership(const RamRelationOperation& op, std::ostream& out) {
+            if (isPartitioned(op.getRelation())) {
+                out << "souffle::mpi::isOwner(env" << op.getTupleId() << ") && ";
+            }
+        }
+
     public:
         CodeEmitter(Synthesiser& syn)
                 : synthesiser(syn), isa(syn.getTranslationUnit().getAnalysis<RamIndexAnalysis>()) {
@@ -244,6 +370,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
                 out << "}\n";
                 out << "IODirectives ioDirectives(directiveMap);\n";
+                // an intermediate relation is reloaded by a later stratum of the file engine
+                out << synthesiser.getRelationName(load.getRelation()) << "->unfreeze();\n";
                 out << "IOSystem::getInstance().getReader(";
                 out << "std::vector<bool>({" << join(symbolMask) << "})";
                 out << ", symTable, ioDirectives";
@@ -259,7 +387,12 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitStore(const RamStore& store, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
-            out << "if (performIO) {\n";
+            // all processes of a data-parallel run hold the same relations, the first one writes them
+            if (Global::config().has("data-parallel")) {
+                out << "if (performIO && souffle::mpi::commRank() == 0) {\n";
+            } else {
+                out << "if (performIO) {\n";
+            }
             std::vector<bool> symbolMask;
             for (auto& cur : store.getRelation().getAttributeTypeQualifiers()) {
                 symbolMask.push_back(cur[0] == 's');
@@ -333,6 +466,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             preamble.str("");
             preamble.clear();
             preambleIssued = false;
+            outerOperation = next;
 
             // create operation contexts for this operation
             for (const RamRelation* rel : synthesiser.getReferencedRelations(query.getOperation())) {
@@ -423,6 +557,14 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visitLogMemory(const RamLogMemory& memory, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            out << "ProfileEventSingleton::instance().makeMemoryEvent( R\"(";
+            out << memory.getMessage() << ")\",";
+            out << synthesiser.getRelationName(memory.getRelation()) << "->getMemoryUsageByIndex(),iter);";
+            PRINT_END_COMMENT(out);
+        }
+
         // -- control flow statements --
 
         void visitSequence(const RamSequence& seq, std::ostream& out) override {
@@ -469,12 +611,21 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitLoop(const RamLoop& loop, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
+            if (Global::config().has("data-parallel")) {
+                partitionedRelations = getPartitionedRelations(loop);
+            }
             out << "iter = 0;\n";
             out << "for(;;) {\n";
             visit(loop.getBody(), out);
             out << "iter++;\n";
             out << "}\n";
             out << "iter = 0;\n";
+            // processes of a data-parallel run share the tuples they own of partitioned relations
+            for (const RamRelation* rel : partitionedRelations) {
+                out << "souffle::mpi::allGather<RamDomain>(*" << synthesiser.getRelationName(*rel) << ", "
+                    << rel->getArity() << ", true);\n";
+            }
+            partitionedRelations.clear();
             PRINT_END_COMMENT(out);
         }
 
@@ -489,9 +640,32 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitExit(const RamExit& exit, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
-            out << "if(";
+            // processes of a data-parallel run send the tuples derived in this iteration to their
+            // owners, which keep the new ones. Unless the relations are partitioned, the owners share
+            // them with all processes, such that they all hold the same relations.
+            const bool partitioned = !partitionedRelations.empty();
+            if (Global::config().has("data-parallel")) {
+                const RamProgram& prog = *synthesiser.getTranslationUnit().getProgram();
+                visitDepthFirst(exit.getCondition(), [&](const RamEmptinessCheck& emptiness) {
+                    const auto& rel = emptiness.getRelation();
+                    if (rel.getName().compare(0, 5, "@new_") != 0) {
+                        return;
+                    }
+                    const RamRelation& full = *prog.getRelation(rel.getName().substr(5));
+                    if (full.getRepresentation() != RelationRepresentation::EQREL) {
+                        out << "souffle::mpi::exchange<RamDomain>(*" << synthesiser.getRelationName(rel)
+                            << ", *" << synthesiser.getRelationName(full) << ", " << rel.getArity() << ");\n";
+                    }
+                    if (!partitioned) {
+                        out << "souffle::mpi::allGather<RamDomain>(*" << synthesiser.getRelationName(rel)
+                            << ", " << rel.getArity() << ");\n";
+                    }
+                });
+            }
+            // processes holding partitioned relations agree on the end of the fixpoint
+            out << (partitioned ? "if(souffle::mpi::allTrue(" : "if(");
             visit(exit.getCondition(), out);
-            out << ") break;\n";
+            out << (partitioned ? ")) break;\n" : ") break;\n");
             PRINT_END_COMMENT(out);
         }
 
@@ -505,8 +679,15 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             const auto& rel = timer.getRelation();
             auto relName = synthesiser.getRelationName(rel);
 
-            out << "\tLogger logger(R\"_(" << timer.getMessage() << ")_\",iter, [&](){return " << relName
-                << "->size();});\n";
+            if (Global::config().has("profile-sampling")) {
+                // only mark the frame of the timer as the one the thread works on
+                out << "\tstatic auto& frame = ProfileSampler::instance().getFrame(R\"_("
+                    << timer.getMessage() << ")_\");\n";
+                out << "\tProfileSampler::Scope sampled(frame, [&](){return " << relName << "->size();});\n";
+            } else {
+                out << "\tLogger logger(R\"_(" << timer.getMessage() << ")_\",iter, [&](){return " << relName
+                    << "->size();});\n";
+            }
             // insert statement to be measured
             visit(timer.getStatement(), out);
 
@@ -559,10 +740,140 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
         void visitTupleOperation(const RamTupleOperation& search, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
+            if (&search == collapsedScan) {
+                out << "collapsedBody(env0, env" << search.getTupleId() << ");\n";
+                PRINT_END_COMMENT(out);
+                return;
+            }
+            // choices test the ownership of tuples in their condition
+            const auto* scan = dynamic_cast<const RamRelationOperation*>(&search);
+            const bool owned = scan != nullptr && isPartitioned(scan->getRelation()) &&
+                               (dynamic_cast<const RamScan*>(scan) != nullptr ||
+                                       dynamic_cast<const RamIndexScan*>(scan) != nullptr);
+            if (owned) {
+                out << "if (souffle::mpi::isOwner(env" << scan->getTupleId() << ")) {\n";
+            }
             visitNestedOperation(search, out);
+            if (owned) {
+                out << "}\n";
+            }
             PRINT_END_COMMENT(out);
         }
 
+        /**
+         * Get the scan nested behind filters in an outer-most parallel loop, which may be
+         * parallelised instead when the outer loop is too small to keep all threads busy.
+         * @return the inner scan, or nullptr if the loop nest cannot be collapsed
+         */
+        const RamRelationOperation* getCollapsibleScan(
+                const RamRelationOperation& outer, std::vector<const RamFilter*>& filters) {
+            // the profiler counts the outer tuples, which are visited by every thread when collapsed
+            if (Global::config().has("profile") && !Global::config().has("profile-sampling")) {
+                return nullptr;
+            }
+
+            const RamOperation* next = &outer.getOperation();
+            while (const auto* filter = dynamic_cast<const RamFilter*>(next)) {
+                filters.push_back(filter);
+                next = &filter->getOperation();
+            }
+            const auto* inner = dynamic_cast<const RamRelationOperation*>(next);
+            if (inner == nullptr || inner->getTupleId() != 1 || inner->getRelation().getArity() == 0 ||
+                    (dynamic_cast<const RamScan*>(inner) == nullptr &&
+                            dynamic_cast<const RamIndexScan*>(inner) == nullptr)) {
+                return nullptr;
+            }
+
+            // all threads must take the same path through the filters and partition the inner
+            // relation in the same way, hence none of them may be modified by the loop nest
+            std::set<const RamRelation*> modified;
+            visitDepthFirst(
+                    outer, [&](const RamProject& project) { modified.insert(&project.getRelation()); });
+            bool readsModified = modified.count(&inner->getRelation()) > 0;
+            for (const auto* filter : filters) {
+                visitDepthFirst(filter->getCondition(), [&](const RamRelationReference& ref) {
+                    readsModified = readsModified || modified.count(ref.get()) > 0;
+                });
+            }
+            return readsModified ? nullptr : inner;
+        }
+
+        /**
+         * Emit the body of a collapsible loop nest as a lambda, shared by the loop nest
+         * parallelised on the outer scan and the one parallelised on the inner scan.
+         */
+        void emitCollapsedBody(const RamRelationOperation& outer, const RamRelationOperation& inner,
+                std::ostream& out) {
+            auto tupleType = [&](const RamRelationOperation& scan) {
+                return "const std::remove_reference<decltype(*" +
+                       synthesiser.getRelationName(scan.getRelation()) + ")>::type::t_tuple&";
+            };
+            out << "auto collapsedBody = [&](" << tupleType(outer) << " env0, " << tupleType(inner)
+                << " env" << inner.getTupleId() << ") {\n";
+            // an unpacked null record skips the tuple by a continue
+            out << "do {\n";
+            visitTupleOperation(inner, out);
+            out << "} while(false);\n";
+            out << "};\n";
+            collapsedScan = &inner;
+        }
+
+        /**
+         * Emit the loop nest collapsed into the inner scan for a single outer tuple. The iterations of
+         * the inner scan are shared among the threads, which all visit every outer tuple.
+         */
+        void emitCollapsedScan(const std::vector<const RamFilter*>& filters,
+                const RamRelationOperation& inner, std::ostream& out) {
+            const auto& rel = inner.getRelation();
+            auto relName = synthesiser.getRelationName(rel);
+            auto arity = rel.getArity();
+
+            for (const auto* filter : filters) {
+                out << "if( ";
+                visit(filter->getCondition(), out);
+                out << ") {\n";
+            }
+
+            if (const auto* iscan = dynamic_cast<const RamIndexScan*>(&inner)) {
+                auto keys = isa->getSearchSignature(iscan);
+                const auto& rangePattern = iscan->getRangePattern();
+
+                out << "const Tuple<RamDomain," << arity << "> key({{";
+                for (size_t i = 0; i < arity; i++) {
+                    if (!isRamUndefValue(rangePattern[i])) {
+                        visit(rangePattern[i], out);
+                    } else {
+                        out << "0";
+                    }
+                    if (i + 1 < arity) {
+                        out << ",";
+                    }
+                }
+                out << "}});\n";
+
+                auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(rel) + ")";
+
+                out << "auto range = " << relName << "->"
+                    << "equalRange_" << keys << "(key," << ctxName << ");\n";
+                out << "auto innerPart = range.partition();\n";
+            } else {
+                out << "auto innerPart = " << relName << "->partition();\n";
+            }
+            out << "pfor_range_nowait(it1, innerPart.begin(), innerPart.end()) {\n";
+            out << "try{\n";
+            out << "for(const auto& env1 : *it1) {\n";
+
+            visitTupleOperation(inner, out);
+
+            out << "}\n";
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
+
+            for (size_t i = 0; i < filters.size(); i++) {
+                out << "}\n";
+            }
+        }
+
         void visitParallelScan(const RamParallelScan& pscan, std::ostream& out) override {
             const auto& rel = pscan.getRelation();
             const auto& relName = synthesiser.getRelationName(rel);
@@ -576,10 +887,22 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
             PRINT_BEGIN_COMMENT(out);
 
+            std::vector<const RamFilter*> filters;
+            const auto* inner = getCollapsibleScan(pscan, filters);
+
             out << "auto part = " << relName << "->partition();\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            if (inner != nullptr) {
+                emitCollapsedBody(pscan, *inner, out);
+                // too few outer partitions for all threads => parallelise the inner loop instead
+                out << "if (part.size() < (size_t)MAX_THREADS) {\n";
+                out << "for(const auto& env0 : *" << relName << ") {\n";
+                emitCollapsedScan(filters, *inner, out);
+                out << "}\n";
+                out << "} else {\n";
+            }
+            out << "pfor_range(it, part.begin(), part.end()) {\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -588,6 +911,10 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "}\n";
             out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
+            if (inner != nullptr) {
+                out << "}\n";
+            }
+            collapsedScan = nullptr;
 
             PRINT_END_COMMENT(out);
         }
@@ -623,6 +950,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "for(const auto& env" << identifier << " : "
                 << "*" << relName << ") {\n";
             out << "if( ";
+            emitOwnership(choice, out);
 
             visit(choice.getCondition(), out);
 
@@ -653,10 +981,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "auto part = " << relName << "->partition();\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end();++it){\n";
+            out << "pfor_range(it, part.begin(), part.end()) {\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
+            emitOwnership(pchoice, out);
 
             visit(pchoice.getCondition(), out);
 
@@ -726,6 +1055,9 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
 
             PRINT_BEGIN_COMMENT(out);
 
+            std::vector<const RamFilter*> filters;
+            const auto* inner = getCollapsibleScan(piscan, filters);
+
             out << "const Tuple<RamDomain," << arity << "> key({{";
             for (size_t i = 0; i < arity; i++) {
                 if (!isRamUndefValue(rangePattern[i])) {
@@ -745,7 +1077,16 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "auto part = range.partition();\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            if (inner != nullptr) {
+                emitCollapsedBody(piscan, *inner, out);
+                // too few outer partitions for all threads => parallelise the inner loop instead
+                out << "if (part.size() < (size_t)MAX_THREADS) {\n";
+                out << "for(const auto& env0 : range) {\n";
+                emitCollapsedScan(filters, *inner, out);
+                out << "}\n";
+                out << "} else {\n";
+            }
+            out << "pfor_range(it, part.begin(), part.end()) {\n";
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -754,6 +1095,10 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "}\n";
             out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
             out << "}\n";
+            if (inner != nullptr) {
+                out << "}\n";
+            }
+            collapsedScan = nullptr;
 
             PRINT_END_COMMENT(out);
         }
@@ -789,6 +1134,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 << "equalRange_" << keys << "(key," << ctxName << ");\n";
             out << "for(const auto& env" << identifier << " : range) {\n";
             out << "if( ";
+            emitOwnership(ichoice, out);
 
             visit(ichoice.getCondition(), out);
 
@@ -839,10 +1185,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "auto part = range.partition();\n";
             out << "PARALLEL_START;\n";
             out << preamble.str();
-            out << "pfor(auto it = part.begin(); it<part.end(); ++it) { \n";
+            out << "pfor_range(it, part.begin(), part.end()) {\n";
             out << "try{";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
+            emitOwnership(pichoice, out);
 
             visit(pichoice.getCondition(), out);
 
@@ -883,6 +1230,64 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        /**
+         * Emit the head of the loop over the tuples to be aggregated, declaring the result
+         * variable. A parallel reduction accumulates a result per thread over the partition
+         * of the tuples, with operation contexts of its own.
+         */
+        void emitAggregateLoopStart(const std::string& source, const std::string& partition, bool parallel,
+                int identifier, const std::string& init, std::ostream& out) {
+            if (!parallel) {
+                out << "RamDomain res" << identifier << " = " << init << ";\n";
+                out << "for(const auto& env" << identifier << " : " << source << ") {\n";
+                return;
+            }
+            out << "std::atomic<RamDomain> shared" << identifier << "(" << init << ");\n";
+            out << "auto part" << identifier << " = " << partition << ";\n";
+            out << "PARALLEL_START {\n";
+            out << preamble.str();
+            out << "RamDomain res" << identifier << " = " << init << ";\n";
+            out << "pfor_range_nowait(it, part" << identifier << ".begin(), part" << identifier
+                << ".end()) {\n";
+            out << "try{\n";
+            out << "for(const auto& env" << identifier << " : *it) {\n";
+        }
+
+        /**
+         * Emit the end of the loop over the tuples to be aggregated. A parallel reduction
+         * combines the results of the threads into the result variable.
+         */
+        void emitAggregateLoopEnd(AggregateFunction fun, bool parallel, int identifier, std::ostream& out) {
+            out << "}\n";
+            if (!parallel) {
+                return;
+            }
+            out << "} catch(std::exception &e) { SignalHandler::instance()->error(e.what());}\n";
+            out << "}\n";
+
+            const std::string shared = "shared" + toString(identifier);
+            const std::string res = "res" + toString(identifier);
+            switch (fun) {
+                case souffle::MIN:
+                    out << "for(RamDomain cur = " << shared << "; " << res << " < cur && !" << shared
+                        << ".compare_exchange_weak(cur, " << res << ");) {}\n";
+                    break;
+                case souffle::MAX:
+                    out << "for(RamDomain cur = " << shared << "; " << res << " > cur && !" << shared
+                        << ".compare_exchange_weak(cur, " << res << ");) {}\n";
+                    break;
+                case souffle::COUNT:
+                case souffle::SUM:
+                    out << shared << " += " << res << ";\n";
+                    break;
+                default:
+                    abort();
+            }
+            out << "}\n";
+            out << "PARALLEL_END\n";
+            out << "RamDomain " << res << " = " << shared << ";\n";
+        }
+
         void visitIndexAggregate(const RamIndexAggregate& aggregate, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             // get some properties
@@ -912,6 +1317,11 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 return;
             }
 
+            // special case: counting the elements of a range of a relation with order statistics
+            const bool countRange = aggregate.getFunction() == souffle::COUNT &&
+                                    dynamic_cast<const RamTrue*>(&aggregate.getCondition()) != nullptr &&
+                                    synthesiser.countedRelations.count(rel.getName()) > 0;
+
             // init result
             std::string init;
             switch (aggregate.getFunction()) {
@@ -930,12 +1340,13 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 default:
                     abort();
             }
-            out << "RamDomain res" << identifier << " = " << init << ";\n";
+            // an outermost aggregate is reduced in parallel
+            const bool parallel = (&aggregate == outerOperation);
 
             // check whether there is an index to use
             if (keys == 0) {
-                out << "for(const auto& env" << identifier << " : "
-                    << "*" << relName << ") {\n";
+                emitAggregateLoopStart(
+                        "*" + relName, relName + "->partition()", parallel, identifier, init, out);
             } else {
                 // a lambda for printing boundary key values
                 auto printKeyTuple = [&]() {
@@ -956,11 +1367,21 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 out << "const " << tuple_type << " key({{";
                 printKeyTuple();
                 out << "}});\n";
+
+                // shortcut: count the range without iterating it
+                if (countRange) {
+                    out << "env" << identifier << "[0] = " << relName << "->"
+                        << "countRange_" << keys << "(key," << ctxName << ");\n";
+                    visitTupleOperation(aggregate, out);
+                    PRINT_END_COMMENT(out);
+                    return;
+                }
+
                 out << "auto range = " << relName << "->"
                     << "equalRange_" << keys << "(key," << ctxName << ");\n";
 
                 // aggregate result
-                out << "for(const auto& env" << identifier << " : range) {\n";
+                emitAggregateLoopStart("range", "range.partition()", parallel, identifier, init, out);
             }
 
             // produce condition inside the loop
@@ -995,7 +1416,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "}\n";
 
             // end aggregator loop
-            out << "}\n";
+            emitAggregateLoopEnd(aggregate.getFunction(), parallel, identifier, out);
 
             // write result into environment tuple
             out << "env" << identifier << "[0] = res" << identifier << ";\n";
@@ -1052,11 +1473,9 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
                 default:
                     abort();
             }
-            out << "RamDomain res" << identifier << " = " << init << ";\n";
-
-            // check whether there is an index to use
-            out << "for(const auto& env" << identifier << " : "
-                << "*" << relName << ") {\n";
+            // an outermost aggregate is reduced in parallel
+            const bool parallel = (&aggregate == outerOperation);
+            emitAggregateLoopStart("*" + relName, relName + "->partition()", parallel, identifier, init, out);
 
             // produce condition inside the loop
             out << "if( ";
@@ -1090,7 +1509,7 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             out << "}\n";
 
             // end aggregator loop
-            out << "}\n";
+            emitAggregateLoopEnd(aggregate.getFunction(), parallel, identifier, out);
 
             // write result into environment tuple
             out << "env" << identifier << "[0] = res" << identifier << ";\n";
@@ -1283,7 +1702,8 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             auto arity = rel.getArity();
             assert(arity > 0 && "AstTranslator failed");
             std::string before, after;
-            if (Global::config().has("profile") && !exists.getRelation().isTemp()) {
+            if (Global::config().has("profile") && !Global::config().has("profile-sampling") &&
+                    !exists.getRelation().isTemp()) {
                 out << R"_((reads[)_" << synthesiser.lookupReadIdx(rel.getName()) << R"_(]++,)_";
                 after = ")";
             }
@@ -1625,20 +2045,32 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             }
         }
 
-#ifdef USE_MPI
+        // -- message passing statements of the mpi and shm engines --
 
-        // -- mpi statements --
+        /** the columns of a relation holding symbols */
+        static std::vector<bool> getSymbolMask(const RamRelation& rel) {
+            std::vector<bool> symbolMask;
+            for (auto& cur : rel.getAttributeTypeQualifiers()) {
+                symbolMask.push_back(cur[0] == 's');
+            }
+            return symbolMask;
+        }
+
+        static bool hasSymbols(const RamRelation& rel) {
+            const auto symbolMask = getSymbolMask(rel);
+            return std::find(symbolMask.begin(), symbolMask.end(), true) != symbolMask.end();
+        }
 
         void visitRecv(const RamRecv& recv, std::ostream& os) override {
-            os << "\n#ifdef USE_MPI\n";
+            os << "\n#if defined(USE_MPI) || defined(USE_SHM)\n";
             os << "{";
-            os << "auto status = souffle::mpi::probe(";
+            os << "auto status = souffle::ipc::probe(";
             // source
             os << recv.getSourceStratum() + 1 << ", ";
             // tag
             os << "tag_" << synthesiser.getRelationName(recv.getRelation());
             os << ");";
-            os << "souffle::mpi::recv<RamDomain>(";
+            os << "souffle::ipc::recv<RamDomain>(";
             // data
             os << "*" << synthesiser.getRelationName(recv.getRelation()) << ", ";
             // arity
@@ -1646,55 +2078,69 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
             // status
             os << "status";
             os << ");";
+            // the symbols of the relation follow its tuples
+            if (hasSymbols(recv.getRelation())) {
+                os << "symTable.recvSymbols(" << recv.getSourceStratum() + 1 << ", ";
+                os << "tag_" << synthesiser.getRelationName(recv.getRelation()) << ");";
+            }
             os << "}";
             os << "\n#endif\n";
         }
 
         void visitSend(const RamSend& send, std::ostream& os) override {
-            os << "\n#ifdef USE_MPI\n";
-            os << "{";
-            os << "souffle::mpi::send<RamDomain>(";
-            // data
-            os << "*" << synthesiser.getRelationName(send.getRelation()) << ", ";
-            // arity
-            os << send.getRelation().getArity() << ", ";
+            os << "\n#if defined(USE_MPI) || defined(USE_SHM)\n";
             // destinations
+            std::stringstream destinations;
             const auto& destinationStrata = send.getDestinationStrata();
             auto it = destinationStrata.begin();
-            os << "std::set<int>(";
+            destinations << "std::set<int>(";
             if (it != destinationStrata.end()) {
-                os << "{" << *it + 1;
+                destinations << "{" << *it + 1;
                 ++it;
                 while (it != destinationStrata.end()) {
-                    os << ", " << *it + 1;
+                    destinations << ", " << *it + 1;
                     ++it;
                 }
-                os << "}";
+                destinations << "}";
             } else {
-                os << "0";
+                destinations << "0";
             }
-            os << "), ";
+            destinations << ")";
+            os << "{";
+            os << "souffle::ipc::send<RamDomain>(";
+            // data
+            os << "*" << synthesiser.getRelationName(send.getRelation()) << ", ";
+            // arity
+            os << send.getRelation().getArity() << ", ";
+            os << destinations.str() << ", ";
             // tag
             os << "tag_" << synthesiser.getRelationName(send.getRelation());
             os << ");";
+            // the symbols of the relation known to this process, such that the destinations need not
+            // request them one by one from rank 0
+            if (hasSymbols(send.getRelation())) {
+                os << "symTable.sendSymbols(*" << synthesiser.getRelationName(send.getRelation()) << ", ";
+                os << "std::vector<bool>({" << join(getSymbolMask(send.getRelation())) << "}), ";
+                os << destinations.str() << ", ";
+                os << "tag_" << synthesiser.getRelationName(send.getRelation()) << ");";
+            }
             os << "}";
             os << "\n#endif\n";
         }
 
         void visitNotify(const RamNotify&, std::ostream& os) override {
-            os << "\n#ifdef USE_MPI\n";
-            os << "mpi::send(0, SymbolTable::exitTag());";
-            os << "mpi::recv(0, SymbolTable::exitTag());";
+            os << "\n#if defined(USE_MPI) || defined(USE_SHM)\n";
+            os << "souffle::ipc::send(0, SymbolTable::exitTag());";
+            os << "souffle::ipc::recv(0, SymbolTable::exitTag());";
             os << "\n#endif\n";
         }
 
         void visitWait(const RamWait& wait, std::ostream& os) override {
-            os << "\n#ifdef USE_MPI\n";
+            os << "\n#if defined(USE_MPI) || defined(USE_SHM)\n";
             os << "symTable.handleMpiMessages(" << wait.getCount() << ");";
             os << "\n#endif\n";
         }
 
-#endif
         // -- safety net --
 
         void visitUndefValue(const RamUndefValue& undef, std::ostream& /*out*/) override {
@@ -1711,7 +2157,83 @@ void Synthesiser::emitCode(std::ostream& out, const RamStatement& stmt) {
     CodeEmitter(*this).visit(stmt, out);
 }
 
+void Synthesiser::generatePreamble(std::ostream& out) {
+#ifdef USE_MPI
+    // turn off mpi support if not enabled as the execution engine
+    if (Global::config().get("engine") != "mpi") {
+        out << "#undef USE_MPI\n";
+    }
+#endif
+    if (Global::config().get("engine") == "shm") {
+        out << "#define USE_SHM\n";
+    }
+
+    // generate C++ program
+    out << "\n#include \"souffle/CompiledSouffle.h\"\n";
+    if (Global::config().has("data-parallel")) {
+        out << "#include \"souffle/Mpi.h\"\n";
+    }
+    if (Global::config().has("provenance")) {
+        out << "#include <mutex>\n";
+        out << "#include \"souffle/Explain.h\"\n";
+    }
+
+    if (Global::config().has("live-profile")) {
+        out << "#include <thread>\n";
+        out << "#include \"souffle/profile/Tui.h\"\n";
+    }
+}
+
 void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary) {
+    generateProgram(os, os, id, withSharedLibrary);
+}
+
+std::vector<std::string> Synthesiser::generateUnits(const std::string& baseFilename, const std::string& id,
+        bool& withSharedLibrary, size_t numUnits) {
+    splitUnits = true;
+    std::stringstream header;
+    std::stringstream mainUnit;
+    generateProgram(header, mainUnit, id, withSharedLibrary);
+
+    // each unit includes the runtime first, such that a precompiled runtime header can be used;
+    // the header relies on these includes
+    std::stringstream preamble;
+    generatePreamble(preamble);
+    preamble << "#include \"" << baseName(baseFilename) << ".h\"\n\n";
+    preamble << "namespace souffle {\n";
+
+    std::ofstream(baseFilename + ".h") << "#pragma once\n" << header.str();
+
+    std::vector<std::string> sources{baseFilename + ".cpp"};
+    std::ofstream os(sources.back());
+    os << preamble.str();
+    os << instantiatedMethods;
+    for (const auto& type : instantiatedTypes) {
+        os << "template struct " << type << "_impl<0>;\n";
+    }
+    os << mainUnit.str();
+
+    // group consecutive strata, such that the fixed cost of compiling a unit is only paid a few times
+    size_t totalSize = 0;
+    for (const auto& cur : stratumUnits) {
+        totalSize += cur.size();
+    }
+    const size_t unitSize = (totalSize + numUnits - 1) / std::max<size_t>(numUnits, 1);
+    std::string code;
+    for (size_t i = 0; i < stratumUnits.size(); i++) {
+        code += stratumUnits[i];
+        if (code.size() < unitSize && i + 1 < stratumUnits.size()) {
+            continue;
+        }
+        sources.push_back(baseFilename + "_strata_" + std::to_string(sources.size() - 1) + ".cpp");
+        std::ofstream(sources.back()) << preamble.str() << code << "}\n";
+        code.clear();
+    }
+    return sources;
+}
+
+void Synthesiser::generateProgram(
+        std::ostream& os, std::ostream& mainUnit, const std::string& id, bool& withSharedLibrary) {
     // ---------------------------------------------------------------
     //                      Auto-Index Generation
     // ---------------------------------------------------------------
@@ -1727,23 +2249,9 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     std::string classname = "Sf_" + id;
 
-#ifdef USE_MPI
-    // turn off mpi support if not enabled as the execution engine
-    if (Global::config().get("engine") != "mpi") {
-        os << "#undef USE_MPI\n";
-    }
-#endif
-
-    // generate C++ program
-    os << "\n#include \"souffle/CompiledSouffle.h\"\n";
-    if (Global::config().has("provenance")) {
-        os << "#include <mutex>\n";
-        os << "#include \"souffle/Explain.h\"\n";
-    }
-
-    if (Global::config().has("live-profile")) {
-        os << "#include <thread>\n";
-        os << "#include \"souffle/profile/Tui.h\"\n";
+    // in split mode, the units include the runtime before the header
+    if (!splitUnits) {
+        generatePreamble(os);
     }
     os << "\n";
     // produce external definitions for user-defined functors
@@ -1780,14 +2288,29 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "namespace souffle {\n";
     os << "using namespace ram;\n";
 
+    // relations counted by aggregates over an index range get indexes supporting order statistics
+    std::set<std::string> countCandidates;
+    visitDepthFirst(*(prog.getMain()), [&](const RamIndexAggregate& aggregate) {
+        if (aggregate.getFunction() == souffle::COUNT && idxAnalysis->getSearchSignature(&aggregate) != 0 &&
+                dynamic_cast<const RamTrue*>(&aggregate.getCondition()) != nullptr) {
+            const std::string& name = aggregate.getRelation().getName();
+            countCandidates.insert(name);
+            countCandidates.insert("@delta_" + name);
+            countCandidates.insert("@new_" + name);
+        }
+    });
+
     visitDepthFirst(*(prog.getMain()), [&](const RamCreate& create) {
         // get some table details
         const RamRelation& rel = create.getRelation();
         const std::string& raw_name = rel.getName();
 
         bool isProvInfo = raw_name.find("@info") != std::string::npos;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                rel, idxAnalysis->getIndexes(rel), Global::config().has("provenance") && !isProvInfo);
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(rel, idxAnalysis->getIndexes(rel),
+                Global::config().has("provenance") && !isProvInfo, countCandidates.count(raw_name) > 0);
+        if (relationType->hasOrderStatistics()) {
+            countedRelations.insert(raw_name);
+        }
 
         generateRelationTypeStruct(os, std::move(relationType));
     });
@@ -1828,10 +2351,9 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     os << "   } return result;\n";
     os << "}\n";
 
-// if using mpi...
-#ifdef USE_MPI
-    if (Global::config().get("engine") == "mpi") {
-        os << "\n#ifdef USE_MPI\n";
+// if passing messages between processes...
+    if (Global::config().get("engine") == "mpi" || Global::config().get("engine") == "shm") {
+        os << "\n#if defined(USE_MPI) || defined(USE_SHM)\n";
 
         // create an enum of message tags, one for each relation
         {
@@ -1851,7 +2373,6 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         }
         os << "\n#endif\n";
     }
-#endif
 
     if (Global::config().has("profile")) {
         os << "std::string profiling_fname;\n";
@@ -1876,12 +2397,12 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         os << "private:\n";
         size_t numFreq = 0;
         visitDepthFirst(*(prog.getMain()), [&](const RamStatement& node) { numFreq++; });
-        os << "  size_t freqs[" << numFreq << "]{};\n";
+        os << "  ProfileFrequencyCounters freqs{" << numFreq << "};\n";
         size_t numRead = 0;
         visitDepthFirst(*(prog.getMain()), [&](const RamCreate& node) {
             if (!node.getRelation().isTemp()) numRead++;
         });
-        os << "  size_t reads[" << numRead << "]{};\n";
+        os << "  ProfileFrequencyCounters reads{" << numRead << "};\n";
     }
 
     // print relation definitions
@@ -1906,8 +2427,8 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         // ensure that the type of the new knowledge is the same as that of the delta knowledge
         bool isDelta = rel.isTemp() && raw_name.find("@delta") != std::string::npos;
         bool isProvInfo = raw_name.find("@info") != std::string::npos;
-        auto relationType = SynthesiserRelation::getSynthesiserRelation(
-                rel, idxAnalysis->getIndexes(rel), Global::config().has("provenance") && !isProvInfo);
+        auto relationType = SynthesiserRelation::getSynthesiserRelation(rel, idxAnalysis->getIndexes(rel),
+                Global::config().has("provenance") && !isProvInfo, countedRelations.count(raw_name) > 0);
         tempType = isDelta ? relationType->getTypeName() : tempType;
         const std::string& type = (rel.isTemp()) ? tempType : relationType->getTypeName();
 
@@ -1954,65 +2475,96 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
         }
     });
 
+    // Emit the head of a method given its declaration in the class and the head of its
+    // definition outside of the class. The method is defined in the class unless the
+    // program is split into several translation units, in which case the class only
+    // declares it and the main unit defines it. Returns the stream receiving the body.
+    auto beginMethod = [&](const std::string& declaration, const std::string& definition,
+                               const std::string& initializers) -> std::ostream& {
+        if (!splitUnits) {
+            os << declaration << initializers << " {\n";
+            return os;
+        }
+        os << declaration << ";\n";
+        mainUnit << definition << initializers << " {\n";
+        return mainUnit;
+    };
+
     os << "public:\n";
 
     // -- constructor --
 
-    os << classname;
-    if (Global::config().has("profile")) {
-        os << "(std::string pf=\"profile.log\") : profiling_fname(pf)";
-        if (!initCons.empty()) {
-            os << ",\n" << initCons;
+    {
+        std::string params;
+        std::string defaults;
+        std::string initializers;
+        if (Global::config().has("profile")) {
+            params = "std::string pf";
+            defaults = "std::string pf=\"profile.log\"";
+            initializers = " : profiling_fname(pf)";
+            if (!initCons.empty()) {
+                initializers += ",\n" + initCons;
+            }
+        } else if (!initCons.empty()) {
+            initializers = " : " + initCons;
         }
-    } else {
-        os << "()";
-        if (!initCons.empty()) {
-            os << " : " << initCons;
+        std::ostream& out = beginMethod(classname + "(" + defaults + ")",
+                classname + "::" + classname + "(" + params + ")", initializers);
+        if (Global::config().has("profile")) {
+            out << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
         }
+        out << registerRel;
+        out << "}\n";
     }
-    os << "{\n";
-    if (Global::config().has("profile")) {
-        os << "ProfileEventSingleton::instance().setOutputFile(profiling_fname);\n";
-    }
-    os << registerRel;
-    os << "}\n";
     // -- destructor --
 
-    os << "~" << classname << "() {\n";
-    os << "}\n";
+    beginMethod("~" + classname + "()", classname + "::~" + classname + "()", "") << "}\n";
 
     // -- run function --
-    os << "private:\nvoid runFunction(std::string inputDirectory = \".\", "
-          "std::string outputDirectory = \".\", size_t stratumIndex = (size_t) -1, bool performIO = false) "
-          "{\n";
-
-    os << "SignalHandler::instance()->set();\n";
+    os << "private:\n";
+    std::ostream& out = beginMethod(
+            "void runFunction(std::string inputDirectory = \".\", std::string outputDirectory = \".\", "
+            "size_t stratumIndex = (size_t) -1, bool performIO = false)",
+            "void " + classname +
+                    "::runFunction(std::string inputDirectory, std::string outputDirectory, "
+                    "size_t stratumIndex, bool performIO)",
+            "");
+
+    out << "SignalHandler::instance()->set();\n";
     if (Global::config().has("verbose")) {
-        os << "SignalHandler::instance()->enableLogging();\n";
+        out << "SignalHandler::instance()->enableLogging();\n";
     }
 
     bool hasIncrement = false;
     visitDepthFirst(*(prog.getMain()), [&](const RamAutoIncrement& inc) { hasIncrement = true; });
     // initialize counter
     if (hasIncrement) {
-        os << "// -- initialize counter --\n";
-        os << "std::atomic<RamDomain> ctr(0);\n\n";
+        out << "// -- initialize counter --\n";
+        out << "std::atomic<RamDomain> ctr(0);\n\n";
     }
-    os << "std::atomic<size_t> iter(0);\n\n";
+    out << "std::atomic<size_t> iter(0);\n\n";
 
     // set default threads (in embedded mode)
     if (std::stoi(Global::config().get("jobs")) > 1) {
-        os << "#if defined(__EMBEDDED_SOUFFLE__) && defined(_OPENMP)\n";
-        os << "omp_set_num_threads(" << std::stoi(Global::config().get("jobs")) << ");\n";
-        os << "#endif\n\n";
+        out << "#if defined(__EMBEDDED_SOUFFLE__) && defined(SOUFFLE_WORK_STEALING)\n";
+        out << "WorkStealingPool::setNumThreads(" << std::stoi(Global::config().get("jobs")) << ");\n";
+        out << "#elif defined(__EMBEDDED_SOUFFLE__) && defined(_OPENMP)\n";
+        out << "omp_set_num_threads(" << std::stoi(Global::config().get("jobs")) << ");\n";
+        out << "#endif\n\n";
     }
 
     // add actual program body
-    os << "// -- query evaluation --\n";
+    out << "// -- query evaluation --\n";
     if (Global::config().has("profile")) {
-        os << "ProfileEventSingleton::instance().startTimer();\n";
-        os << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
-        os << "{\n"
+        out << "ProfileEventSingleton::instance().startTimer();\n";
+        out << R"_(ProfileEventSingleton::instance().makeTimeEvent("@time;starttime");)_" << '\n';
+        if (Global::config().has("profile-sampling")) {
+            out << "ProfileSampler::instance().start(" << Global::config().get("profile-sampling") << ");\n";
+        }
+        if (Global::config().has("profile-counters")) {
+            out << "HardwareCounters::instance().start();\n";
+        }
+        out << "{\n"
            << R"_(Logger logger("@runtime;", 0);)_" << '\n';
         // Store count of relations
         size_t relationCount = 0;
@@ -2020,10 +2572,10 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             if (create.getRelation().getName()[0] != '@') ++relationCount;
         });
         // Store configuration
-        os << R"_(ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string()_"
+        out << R"_(ProfileEventSingleton::instance().makeConfigRecord("relationCount", std::to_string()_"
            << relationCount << "));";
         // Outline stratum records for faster compilation
-        os << "[](){\n";
+        out << "[](){\n";
 
         // Record relations created in each stratum
         visitDepthFirst(*(prog.getMain()), [&](const RamStratum& stratum) {
@@ -2036,13 +2588,13 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
                 if (cur.first[0] == '@') {
                     continue;
                 }
-                os << "ProfileEventSingleton::instance().makeStratumRecord(" << stratum.getIndex()
+                out << "ProfileEventSingleton::instance().makeStratumRecord(" << stratum.getIndex()
                    << R"_(, "relation", ")_" << cur.first << R"_(", "arity", ")_" << cur.second << R"_(");)_"
                    << '\n';
             }
         });
         // End stratum record outlining
-        os << "}();\n";
+        out << "}();\n";
     }
 
     if (Global::config().has("engine")) {
@@ -2055,58 +2607,120 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
             ss << "case " << i << ":\ngoto STRATUM_" << i << ";\nbreak;\n";
         });
         if (hasAtLeastOneStrata) {
-            os << "switch (stratumIndex) {\n";
+            out << "switch (stratumIndex) {\n";
             {
                 // otherwise use stratum 0 if index is -1
-                os << "case (size_t) -1:\ngoto STRATUM_0;\nbreak;\n";
+                out << "case (size_t) -1:\ngoto STRATUM_0;\nbreak;\n";
             }
-            os << ss.str();
-            os << "}\n";
+            out << ss.str();
+            out << "}\n";
         }
     }
 
+    // strata are run as a graph of tasks following their dependencies, unless the
+    // communication engine selects a single stratum to run or the processes of a
+    // data-parallel run have to exchange tuples in the same order
+    const bool scheduleStrata = !Global::config().has("engine") && !Global::config().has("data-parallel");
+    auto* stratumAnalysis = translationUnit.getAnalysis<RamStratumDependencyAnalysis>();
+    if (scheduleStrata) {
+        out << "TaskGraph strata;\n";
+    }
+
     // Set up stratum
+    size_t stratumPos = 0;
     visitDepthFirst(*(prog.getMain()), [&](const RamStratum& stratum) {
-        os << "/* BEGIN STRATUM " << stratum.getIndex() << " */\n";
+        // relations computed by this stratum; these are read-only once the stratum completes
+        std::set<std::string> computedRelations;
+        visitDepthFirst(stratum, [&](const RamCreate& create) {
+            if (!create.getRelation().isTemp()) {
+                computedRelations.insert(getRelationName(create.getRelation()));
+            }
+        });
+
+        out << "/* BEGIN STRATUM " << stratum.getIndex() << " */\n";
         if (Global::config().has("engine")) {
             // go to the stratum with the max value for int as a suffix if calling the master stratum
             auto i = stratum.getIndex();
-            os << "STRATUM_" << i << ":\n";
+            out << "STRATUM_" << i << ":\n";
+        }
+        if (scheduleStrata) {
+            out << "strata.addTask([&]() {\n";
+        }
+        // in split mode, the stratum is evaluated by a method defined in a unit of its own
+        std::stringstream unit;
+        std::ostream& body = splitUnits ? unit : out;
+        if (splitUnits) {
+            std::string params = "const std::string& inputDirectory, const std::string& outputDirectory, ";
+            params += hasIncrement ? "bool performIO, std::atomic<RamDomain>& ctr" : "bool performIO";
+            const std::string method = "stratum_" + std::to_string(stratum.getIndex());
+            os << "void " << method << "(" << params << ");\n";
+            out << method << "(inputDirectory, outputDirectory, performIO" << (hasIncrement ? ", ctr" : "")
+                << ");\n";
+            unit << "void " << classname << "::" << method << "(" << params << ") {\n";
+        }
+        if (scheduleStrata || splitUnits) {
+            // each stratum counts its own iterations
+            body << "std::atomic<size_t> iter(0);\n";
+        }
+        // relations may still be frozen from a previous run of the program
+        for (const auto& relName : computedRelations) {
+            body << relName << "->unfreeze();\n";
+        }
+        body << "[&]() {\n";
+        emitCode(body, stratum.getBody());
+        body << "}();\n";
+        // switch computed relations into read-only mode for all subsequent strata
+        for (const auto& relName : computedRelations) {
+            body << relName << "->freeze();\n";
+        }
+        if (splitUnits) {
+            unit << "}\n";
+            stratumUnits.push_back(unit.str());
+        }
+        if (scheduleStrata) {
+            out << "}, {" << join(stratumAnalysis->getPredecessors(stratumPos)) << "});\n";
         }
-        os << "[&]() {\n";
-        emitCode(os, stratum.getBody());
-        os << "}();\n";
         if (Global::config().has("engine")) {
-            os << "if (stratumIndex != (size_t) -1) goto EXIT;\n";
+            out << "if (stratumIndex != (size_t) -1) goto EXIT;\n";
         }
-        os << "/* END STRATUM " << stratum.getIndex() << " */\n";
+        out << "/* END STRATUM " << stratum.getIndex() << " */\n";
+        ++stratumPos;
     });
+    if (scheduleStrata) {
+        out << "strata.run();\n";
+    }
 
     if (Global::config().has("engine")) {
-        os << "EXIT:{}";
+        out << "EXIT:{}";
     }
 
     if (Global::config().has("profile")) {
-        os << "}\n";
-        os << "ProfileEventSingleton::instance().stopTimer();\n";
-        os << "dumpFreqs();\n";
+        out << "}\n";
+        if (Global::config().has("profile-sampling")) {
+            out << "ProfileSampler::instance().stop();\n";
+        }
+        if (Global::config().has("profile-counters")) {
+            out << "HardwareCounters::instance().stop();\n";
+        }
+        out << "ProfileEventSingleton::instance().stopTimer();\n";
+        out << "dumpFreqs();\n";
     }
 
     // add code printing hint statistics
-    os << "\n// -- relation hint statistics --\n";
-    os << "if(isHintsProfilingEnabled()) {\n";
-    os << "std::cout << \" -- Operation Hint Statistics --\\n\";\n";
+    out << "\n// -- relation hint statistics --\n";
+    out << "if(isHintsProfilingEnabled()) {\n";
+    out << "std::cout << \" -- Operation Hint Statistics --\\n\";\n";
     visitDepthFirst(*(prog.getMain()), [&](const RamCreate& create) {
         auto name = getRelationName(create.getRelation());
-        os << "std::cout << \"Relation " << name << ":\\n\";\n";
-        os << name << "->printHintStatistics(std::cout,\"  \");\n";
-        os << "std::cout << \"\\n\";\n";
+        out << "std::cout << \"Relation " << name << ":\\n\";\n";
+        out << name << "->printHintStatistics(std::cout,\"  \");\n";
+        out << "std::cout << \"\\n\";\n";
     });
-    os << "}\n";
+    out << "}\n";
 
-    os << "SignalHandler::instance()->reset();\n";
+    out << "SignalHandler::instance()->reset();\n";
 
-    os << "}\n";  // end of runFunction() method
+    out << "}\n";  // end of runFunction() method
 
     // add methods to run with and without performing IO (mainly for the interface)
     os << "public:\nvoid run(size_t stratumIndex = (size_t) -1) override { runFunction(\".\", \".\", "
@@ -2125,117 +2739,133 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
 
     // issue printAll method
     os << "public:\n";
-    os << "void printAll(std::string outputDirectory = \".\") override {\n";
-    visitDepthFirst(*(prog.getMain()), [&](const RamStatement& node) {
-        if (auto store = dynamic_cast<const RamStore*>(&node)) {
-            std::vector<bool> symbolMask;
-            for (auto& cur : store->getRelation().getAttributeTypeQualifiers()) {
-                symbolMask.push_back(cur[0] == 's');
-            }
-            for (IODirectives ioDirectives : store->getIODirectives()) {
-                os << "try {";
-                os << "std::map<std::string, std::string> directiveMap(" << ioDirectives << ");\n";
-                os << R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
-                os << "directiveMap[\"filename\"].front() != '/') {";
-                os << R"_(directiveMap["filename"] = outputDirectory + "/" + directiveMap["filename"];)_";
-                os << "}\n";
-                os << "IODirectives ioDirectives(directiveMap);\n";
-                os << "IOSystem::getInstance().getWriter(";
-                os << "std::vector<bool>({" << join(symbolMask) << "})";
-                os << ", symTable, ioDirectives, " << (Global::config().has("provenance") ? "true" : "false");
-                os << ")->writeAll(*" << getRelationName(store->getRelation()) << ");\n";
-
-                os << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+    {
+        std::ostream& body = beginMethod("void printAll(std::string outputDirectory = \".\") override",
+                "void " + classname + "::printAll(std::string outputDirectory)", "");
+        visitDepthFirst(*(prog.getMain()), [&](const RamStatement& node) {
+            if (auto store = dynamic_cast<const RamStore*>(&node)) {
+                std::vector<bool> symbolMask;
+                for (auto& cur : store->getRelation().getAttributeTypeQualifiers()) {
+                    symbolMask.push_back(cur[0] == 's');
+                }
+                for (IODirectives ioDirectives : store->getIODirectives()) {
+                    body << "try {";
+                    body << "std::map<std::string, std::string> directiveMap(" << ioDirectives << ");\n";
+                    body << R"_(if (!outputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+                    body << "directiveMap[\"filename\"].front() != '/') {";
+                    body << R"_(directiveMap["filename"] = outputDirectory + "/" + )_";
+                    body << R"_(directiveMap["filename"];)_";
+                    body << "}\n";
+                    body << "IODirectives ioDirectives(directiveMap);\n";
+                    body << "IOSystem::getInstance().getWriter(";
+                    body << "std::vector<bool>({" << join(symbolMask) << "})";
+                    body << ", symTable, ioDirectives, "
+                         << (Global::config().has("provenance") ? "true" : "false");
+                    body << ")->writeAll(*" << getRelationName(store->getRelation()) << ");\n";
+
+                    body << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+                }
             }
-        }
-    });
-    os << "}\n";  // end of printAll() method
+        });
+        body << "}\n";  // end of printAll() method
+    }
 
     // dumpFreqs method
     if (Global::config().has("profile")) {
         os << "private:\n";
-        os << "void dumpFreqs() {\n";
+        std::ostream& body = beginMethod("void dumpFreqs()", "void " + classname + "::dumpFreqs()", "");
         for (auto const& cur : idxMap) {
-            os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(" << cur.first << ")_\", freqs["
-               << cur.second << "],0);\n";
+            body << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(" << cur.first
+                 << ")_\", freqs.sum(" << cur.second << "),0);\n";
         }
         for (auto const& cur : neIdxMap) {
-            os << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;" << cur.first
-               << ")_\", reads[" << cur.second << "],0);\n";
+            body << "\tProfileEventSingleton::instance().makeQuantityEvent(R\"_(@relation-reads;" << cur.first
+                 << ")_\", reads.sum(" << cur.second << "),0);\n";
         }
-        os << "}\n";  // end of dumpFreqs() method
+        body << "}\n";  // end of dumpFreqs() method
     }
 
     // issue loadAll method
     os << "public:\n";
-    os << "void loadAll(std::string inputDirectory = \".\") override {\n";
-    visitDepthFirst(*(prog.getMain()), [&](const RamLoad& load) {
-        // get some table details
-        std::vector<bool> symbolMask;
-        for (auto& cur : load.getRelation().getAttributeTypeQualifiers()) {
-            symbolMask.push_back(cur[0] == 's');
-        }
-        for (IODirectives ioDirectives : load.getIODirectives()) {
-            os << "try {";
-            os << "std::map<std::string, std::string> directiveMap(";
-            os << ioDirectives << ");\n";
-            os << R"_(if (!inputDirectory.empty() && directiveMap["IO"] == "file" && )_";
-            os << "directiveMap[\"filename\"].front() != '/') {";
-            os << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
-            os << "}\n";
-            os << "IODirectives ioDirectives(directiveMap);\n";
-            os << "IOSystem::getInstance().getReader(";
-            os << "std::vector<bool>({" << join(symbolMask) << "})";
-            os << ", symTable, ioDirectives";
-            os << ", " << (Global::config().has("provenance") ? "true" : "false");
-            os << ")->readAll(*" << getRelationName(load.getRelation());
-            os << ");\n";
-            os << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() << "
-                  "'\\n';}\n";
-        }
-    });
-    os << "}\n";  // end of loadAll() method
+    {
+        std::ostream& body = beginMethod("void loadAll(std::string inputDirectory = \".\") override",
+                "void " + classname + "::loadAll(std::string inputDirectory)", "");
+        visitDepthFirst(*(prog.getMain()), [&](const RamLoad& load) {
+            // get some table details
+            std::vector<bool> symbolMask;
+            for (auto& cur : load.getRelation().getAttributeTypeQualifiers()) {
+                symbolMask.push_back(cur[0] == 's');
+            }
+            for (IODirectives ioDirectives : load.getIODirectives()) {
+                body << "try {";
+                body << "std::map<std::string, std::string> directiveMap(";
+                body << ioDirectives << ");\n";
+                body << R"_(if (!inputDirectory.empty() && directiveMap["IO"] == "file" && )_";
+                body << "directiveMap[\"filename\"].front() != '/') {";
+                body << R"_(directiveMap["filename"] = inputDirectory + "/" + directiveMap["filename"];)_";
+                body << "}\n";
+                body << "IODirectives ioDirectives(directiveMap);\n";
+                body << getRelationName(load.getRelation()) << "->unfreeze();\n";
+                body << "IOSystem::getInstance().getReader(";
+                body << "std::vector<bool>({" << join(symbolMask) << "})";
+                body << ", symTable, ioDirectives";
+                body << ", " << (Global::config().has("provenance") ? "true" : "false");
+                body << ")->readAll(*" << getRelationName(load.getRelation());
+                body << ");\n";
+                body << "} catch (std::exception& e) {std::cerr << \"Error loading data: \" << e.what() << "
+                        "'\\n';}\n";
+            }
+        });
+        body << "}\n";  // end of loadAll() method
+    }
 
     // issue dump methods
-    auto dumpRelation = [&](const std::string& name, const std::vector<std::string>& mask, size_t arity) {
+    auto dumpRelation = [&](std::ostream& body, const std::string& name, const std::vector<std::string>& mask,
+                                size_t arity) {
         auto relName = name;
         std::vector<bool> symbolMask;
         for (auto& cur : mask) {
             symbolMask.push_back(cur[0] == 's');
         }
 
-        os << "try {";
-        os << "IODirectives ioDirectives;\n";
-        os << "ioDirectives.setIOType(\"stdout\");\n";
-        os << "ioDirectives.setRelationName(\"" << name << "\");\n";
-        os << "IOSystem::getInstance().getWriter(";
-        os << "std::vector<bool>({" << join(symbolMask) << "})";
-        os << ", symTable, ioDirectives, " << (Global::config().has("provenance") ? "true" : "false");
-        os << ")->writeAll(*" << relName << ");\n";
-        os << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
+        body << "try {";
+        body << "IODirectives ioDirectives;\n";
+        body << "ioDirectives.setIOType(\"stdout\");\n";
+        body << "ioDirectives.setRelationName(\"" << name << "\");\n";
+        body << "IOSystem::getInstance().getWriter(";
+        body << "std::vector<bool>({" << join(symbolMask) << "})";
+        body << ", symTable, ioDirectives, " << (Global::config().has("provenance") ? "true" : "false");
+        body << ")->writeAll(*" << relName << ");\n";
+        body << "} catch (std::exception& e) {std::cerr << e.what();exit(1);}\n";
     };
 
     // dump inputs
     os << "public:\n";
-    os << "void dumpInputs(std::ostream& out = std::cout) override {\n";
-    visitDepthFirst(*(prog.getMain()), [&](const RamLoad& load) {
-        auto& name = getRelationName(load.getRelation());
-        auto& mask = load.getRelation().getAttributeTypeQualifiers();
-        size_t arity = load.getRelation().getArity();
-        dumpRelation(name, mask, arity);
-    });
-    os << "}\n";  // end of dumpInputs() method
+    {
+        std::ostream& body = beginMethod("void dumpInputs(std::ostream& out = std::cout) override",
+                "void " + classname + "::dumpInputs(std::ostream& out)", "");
+        visitDepthFirst(*(prog.getMain()), [&](const RamLoad& load) {
+            auto& name = getRelationName(load.getRelation());
+            auto& mask = load.getRelation().getAttributeTypeQualifiers();
+            size_t arity = load.getRelation().getArity();
+            dumpRelation(body, name, mask, arity);
+        });
+        body << "}\n";  // end of dumpInputs() method
+    }
 
     // dump outputs
     os << "public:\n";
-    os << "void dumpOutputs(std::ostream& out = std::cout) override {\n";
-    visitDepthFirst(*(prog.getMain()), [&](const RamStore& store) {
-        auto& name = getRelationName(store.getRelation());
-        auto& mask = store.getRelation().getAttributeTypeQualifiers();
-        size_t arity = store.getRelation().getArity();
-        dumpRelation(name, mask, arity);
-    });
-    os << "}\n";  // end of dumpOutputs() method
+    {
+        std::ostream& body = beginMethod("void dumpOutputs(std::ostream& out = std::cout) override",
+                "void " + classname + "::dumpOutputs(std::ostream& out)", "");
+        visitDepthFirst(*(prog.getMain()), [&](const RamStore& store) {
+            auto& name = getRelationName(store.getRelation());
+            auto& mask = store.getRelation().getAttributeTypeQualifiers();
+            size_t arity = store.getRelation().getArity();
+            dumpRelation(body, name, mask, arity);
+        });
+        body << "}\n";  // end of dumpOutputs() method
+    }
 
     os << "public:\n";
     os << "SymbolTable& getSymbolTable() override {\n";
@@ -2245,128 +2875,152 @@ void Synthesiser::generateCode(std::ostream& os, const std::string& id, bool& wi
     // TODO: generate code for subroutines
     if (Global::config().has("provenance")) {
         // generate subroutine adapter
-        os << "void executeSubroutine(std::string name, const std::vector<RamDomain>& args, "
-              "std::vector<RamDomain>& ret, std::vector<bool>& err) override {\n";
+        const std::string params =
+                "const std::vector<RamDomain>& args, std::vector<RamDomain>& ret, std::vector<bool>& err";
+        std::ostream& adapter =
+                beginMethod("void executeSubroutine(std::string name, " + params + ") override",
+                        "void " + classname + "::executeSubroutine(std::string name, " + params + ")", "");
 
         // subroutine number
         size_t subroutineNum = 0;
         for (auto& sub : prog.getSubroutines()) {
-            os << "if (name == \"" << sub.first << "\") {\n"
-               << "subproof_" << subroutineNum
-               << "(args, ret, err);\n"  // subproof_i to deal with special characters in relation names
-               << "}\n";
+            adapter << "if (name == \"" << sub.first << "\") {\n"
+                    << "subproof_" << subroutineNum
+                    << "(args, ret, err);\n"  // subproof_i to deal with special characters in relation names
+                    << "}\n";
             subroutineNum++;
         }
-        os << "}\n";  // end of executeSubroutine
+        adapter << "}\n";  // end of executeSubroutine
 
         // generate method for each subroutine
         subroutineNum = 0;
         for (auto& sub : prog.getSubroutines()) {
             // method header
-            os << "void "
-               << "subproof_" << subroutineNum
-               << "(const std::vector<RamDomain>& args, "
-                  "std::vector<RamDomain>& ret, std::vector<bool>& err) {\n";
+            const std::string method = "subproof_" + std::to_string(subroutineNum);
+            std::ostream& body = beginMethod("void " + method + "(" + params + ")",
+                    "void " + classname + "::" + method + "(" + params + ")", "");
 
             // a lock is needed when filling the subroutine return vectors
-            os << "std::mutex lock;\n";
+            body << "std::mutex lock;\n";
 
             // generate code for body
-            emitCode(os, *sub.second);
+            emitCode(body, *sub.second);
 
-            os << "return;\n";
-            os << "}\n";  // end of subroutine
+            body << "return;\n";
+            body << "}\n";  // end of subroutine
             subroutineNum++;
         }
     }
 
     os << "};\n";  // end of class declaration
+    if (splitUnits) {
+        // the header ends with the class, the main unit continues within the namespace
+        os << "}\n";
+    }
 
     // hidden hooks
-    os << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
-    os << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
-       << "*>(p)->symTable;}\n";
-
-    os << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
-    os << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
-    os << "SouffleProgram *newInstance() {\n";
-    os << "return new " << classname << "();\n";
-    os << "};\n";
-    os << "public:\n";
-    os << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
-    os << "};\n";
-    os << "static factory_" << classname << " __factory_" << classname << "_instance;\n";
-    os << "}\n";
-    os << "#else\n";
-    os << "}\n";
-    os << "int main(int argc, char** argv)\n{\n";
-    os << "try{\n";
+    mainUnit << "SouffleProgram *newInstance_" << id << "(){return new " << classname << ";}\n";
+    mainUnit << "SymbolTable *getST_" << id << "(SouffleProgram *p){return &reinterpret_cast<" << classname
+             << "*>(p)->symTable;}\n";
+
+    mainUnit << "\n#ifdef __EMBEDDED_SOUFFLE__\n";
+    mainUnit << "class factory_" << classname << ": public souffle::ProgramFactory {\n";
+    mainUnit << "SouffleProgram *newInstance() {\n";
+    mainUnit << "return new " << classname << "();\n";
+    mainUnit << "};\n";
+    mainUnit << "public:\n";
+    mainUnit << "factory_" << classname << "() : ProgramFactory(\"" << id << "\"){}\n";
+    mainUnit << "};\n";
+    mainUnit << "static factory_" << classname << " __factory_" << classname << "_instance;\n";
+    mainUnit << "}\n";
+    mainUnit << "#else\n";
+    mainUnit << "}\n";
+    mainUnit << "int main(int argc, char** argv)\n{\n";
+    mainUnit << "try{\n";
 
     // parse arguments
-    os << "souffle::CmdOptions opt(";
-    os << "R\"(" << Global::config().get("") << ")\",\n";
-    os << "R\"(.)\",\n";
-    os << "R\"(.)\",\n";
+    mainUnit << "souffle::CmdOptions opt(";
+    mainUnit << "R\"(" << Global::config().get("") << ")\",\n";
+    mainUnit << "R\"(.)\",\n";
+    mainUnit << "R\"(.)\",\n";
     if (Global::config().has("profile")) {
-        os << "true,\n";
-        os << "R\"(" << Global::config().get("profile") << ")\",\n";
+        mainUnit << "true,\n";
+        mainUnit << "R\"(" << Global::config().get("profile") << ")\",\n";
     } else {
-        os << "false,\n";
-        os << "R\"()\",\n";
+        mainUnit << "false,\n";
+        mainUnit << "R\"()\",\n";
+    }
+    mainUnit << std::stoi(Global::config().get("jobs")) << ",\n";
+    mainUnit << "-1";
+    mainUnit << ");\n";
+
+    mainUnit << "if (!opt.parse(argc,argv)) return 1;\n";
+
+    if (Global::config().get("engine") == "shm") {
+        // fork the worker processes before the program starts any threads, the master process waits
+        // for one worker process per stratum
+        int workers = 0;
+        visitDepthFirst(*(prog.getMain()), [&](const RamWait& wait) { workers += wait.getCount(); });
+        mainUnit << "souffle::shm::init(" << workers + 1 << ");\n";
     }
-    os << std::stoi(Global::config().get("jobs")) << ",\n";
-    os << "-1";
-    os << ");\n";
-
-    os << "if (!opt.parse(argc,argv)) return 1;\n";
 
-    os << "#if defined(_OPENMP) \n";
-    os << "omp_set_nested(true);\n";
-    os << "\n#endif\n";
+    mainUnit << "#if defined(_OPENMP) \n";
+    mainUnit << "omp_set_nested(true);\n";
+    mainUnit << "\n#endif\n";
 
-    os << "souffle::";
+    mainUnit << "souffle::";
     if (Global::config().has("profile")) {
-        os << classname + " obj(opt.getProfileName());\n";
+        mainUnit << classname + " obj(opt.getProfileName());\n";
     } else {
-        os << classname + " obj;\n";
+        mainUnit << classname + " obj;\n";
     }
 
     if (Global::config().has("profile")) {
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
-           << '\n';
-        os << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
-           << Global::config().get("version") << R"_(");)_" << '\n';
+        mainUnit << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("", opt.getSourceFileName());)_"
+                 << '\n';
+        mainUnit << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("fact-dir", opt.getInputFileDir());)_"
+                 << '\n';
+        mainUnit << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("jobs", std::to_string(opt.getNumJobs()));)_"
+                 << '\n';
+        mainUnit << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("output-dir", opt.getOutputFileDir());)_"
+                 << '\n';
+        mainUnit << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
+                 << Global::config().get("version") << R"_(");)_" << '\n';
+    }
+    if (Global::config().get("engine") == "shm") {
+        mainUnit << "int rank = souffle::shm::commRank();";
+        mainUnit << "int stratum = (rank == 0) ? " << std::numeric_limits<int>::max() << " : rank - 1;";
+        mainUnit << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir(), stratum);\n";
+        mainUnit << "souffle::shm::finalize();";
     }
 #ifdef USE_MPI
-    if (Global::config().get("engine") == "mpi") {
-        os << "\n#ifdef USE_MPI\n";
-        os << "souffle::mpi::init(argc, argv);";
-        os << "int rank = souffle::mpi::commRank();";
-        os << "int stratum = (rank == 0) ? " << std::numeric_limits<int>::max() << " : rank - 1;";
-        os << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir(), stratum);\n";
-        os << "souffle::mpi::finalize();";
-        os << "\n#endif\n";
-    } else
+    else if (Global::config().get("engine") == "mpi") {
+        mainUnit << "\n#ifdef USE_MPI\n";
+        mainUnit << "souffle::mpi::init(argc, argv);";
+        mainUnit << "int rank = souffle::mpi::commRank();";
+        mainUnit << "int stratum = (rank == 0) ? " << std::numeric_limits<int>::max() << " : rank - 1;";
+        mainUnit << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir(), stratum);\n";
+        mainUnit << "souffle::mpi::finalize();";
+        mainUnit << "\n#endif\n";
+    } else if (Global::config().has("data-parallel")) {
+        mainUnit << "souffle::mpi::init(argc, argv);";
+        mainUnit << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir(), opt.getStratumIndex());\n";
+        mainUnit << "souffle::mpi::finalize();";
+    }
 #endif
-    {
-        os << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir(), opt.getStratumIndex());\n";
+    else {
+        mainUnit << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir(), opt.getStratumIndex());\n";
     }
 
     if (Global::config().get("provenance") == "explain") {
-        os << "explain(obj, false);\n";
+        mainUnit << "explain(obj, false);\n";
     } else if (Global::config().get("provenance") == "explore") {
-        os << "explain(obj, true);\n";
+        mainUnit << "explain(obj, true);\n";
     }
-    os << "return 0;\n";
-    os << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
-    os << "}\n";
-    os << "\n#endif\n";
+    mainUnit << "return 0;\n";
+    mainUnit << "} catch(std::exception &e) { souffle::SignalHandler::instance()->error(e.what());}\n";
+    mainUnit << "}\n";
+    mainUnit << "\n#endif\n";
 }
 
 }  // end of namespace souffle
@@ -23,6 +23,7 @@
 #include <ostream>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace souffle {
 
@@ -51,6 +52,21 @@ private:
     /** Cache for generated types for relations */
     std::set<std::string> typeCache;
 
+    /** Relations whose types count ranges in logarithmic time */
+    std::set<std::string> countedRelations;
+
+    /** Whether the program is split into several translation units */
+    bool splitUnits = false;
+
+    /** Relation types instantiated explicitly in the main translation unit */
+    std::vector<std::string> instantiatedTypes;
+
+    /** Definitions of the methods of the relation types that only the main translation unit sees */
+    std::string instantiatedMethods;
+
+    /** Code of the methods evaluating the strata */
+    std::vector<std::string> stratumUnits;
+
 protected:
     /** Convert RAM identifier */
     const std::string convertRamIdent(const std::string& name);
@@ -79,6 +95,16 @@ protected:
     /** Generate code */
     void emitCode(std::ostream& out, const RamStatement& stmt);
 
+    /** Generate the includes shared by all translation units */
+    void generatePreamble(std::ostream& out);
+
+    /**
+     * Generate the program, writing the relation types and the program class to
+     * the header stream and the remaining definitions to the main unit stream
+     */
+    void generateProgram(std::ostream& os, std::ostream& mainUnit, const std::string& id,
+            bool& withSharedLibrary);
+
     /** Lookup frequency counter */
     unsigned lookupFreqIdx(const std::string& txt);
 
@@ -96,5 +122,18 @@ public:
 
     /** Generate code */
     void generateCode(std::ostream& os, const std::string& id, bool& withSharedLibrary);
+
+    /**
+     * Generate code split into translation units which can be compiled in parallel:
+     * the header <base>.h declares the relation types and the program class, the
+     * main unit <base>.cpp instantiates the relation types and defines the larger
+     * methods, and the units <base>_strata_<i>.cpp evaluate the strata. Each stratum
+     * is a method of its own; consecutive strata are grouped into at most the given
+     * number of units of similar size.
+     *
+     * @return the names of the source files, starting with the main unit
+     */
+    std::vector<std::string> generateUnits(const std::string& baseFilename, const std::string& id,
+            bool& withSharedLibrary, size_t numUnits);
 };
 }  // end of namespace souffle
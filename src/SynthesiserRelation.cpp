@@ -17,8 +17,8 @@
 
 namespace souffle {
 
-std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(
-        const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance) {
+std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation(const RamRelation& ramRel,
+        const MinIndexSelection& indexSet, bool isProvenance, bool isCounted) {
     SynthesiserRelation* rel;
 
     // Handle the qualifier in souffle code
@@ -26,18 +26,21 @@ std::unique_ptr<SynthesiserRelation> SynthesiserRelation::getSynthesiserRelation
         rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.isNullary()) {
         rel = new SynthesiserNullaryRelation(ramRel, indexSet, isProvenance);
-    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE) {
-        rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
+    } else if (ramRel.getRepresentation() == RelationRepresentation::BTREE ||
+               ramRel.getRepresentation() == RelationRepresentation::HASH) {
+        rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance, isCounted);
     } else if (ramRel.getRepresentation() == RelationRepresentation::BRIE) {
         rel = new SynthesiserBrieRelation(ramRel, indexSet, isProvenance);
     } else if (ramRel.getRepresentation() == RelationRepresentation::EQREL) {
         rel = new SynthesiserEqrelRelation(ramRel, indexSet, isProvenance);
+    } else if (ramRel.getRepresentation() == RelationRepresentation::BITMAP) {
+        rel = new SynthesiserBitmapRelation(ramRel, indexSet, isProvenance);
     } else {
         // Handle the data structure command line flag
         if (ramRel.getArity() > 6) {
             rel = new SynthesiserIndirectRelation(ramRel, indexSet, isProvenance);
         } else {
-            rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance);
+            rel = new SynthesiserDirectRelation(ramRel, indexSet, isProvenance, isCounted);
         }
     }
 
@@ -81,6 +84,23 @@ void SynthesiserDirectRelation::computeIndices() {
         inds.push_back(fullInd);
     }
 
+    // An index serving a single search is only probed by equality on the columns of
+    // that search, so it does not need to be ordered and is a hash index where the
+    // index analysis counts on one, i.e. with the hash qualifier or if the cost model
+    // found it to pay off. The master index stays a b-tree as it provides the
+    // iteration order and partitioning of the relation.
+    hashKeys = MinIndexSelection::OrderCollection(inds.size());
+    if (!isProvenance) {
+        for (size_t i = 1; i < inds.size(); i++) {
+            if (indices.isHashIndex(i)) {
+                hashKeys[i] = inds[i];
+            }
+        }
+    }
+
+    // with the hash qualifier, existence checks use a hash set of all tuples
+    hasHashSet = !isProvenance && relation.getRepresentation() == RelationRepresentation::HASH;
+
     // expand all search orders to be full
     for (auto& ind : inds) {
         if (ind.size() < getArity()) {
@@ -130,16 +150,21 @@ void SynthesiserDirectRelation::computeIndices() {
 /** Generate type name of a direct indexed relation */
 std::string SynthesiserDirectRelation::getTypeName() {
     std::stringstream res;
-    res << "t_btree_" << getArity();
+    res << (isCounted ? "t_btree_counted_" : "t_btree_") << getArity();
 
-    for (auto& ind : getIndices()) {
-        res << "__" << join(ind, "_");
+    const auto& inds = getIndices();
+    for (size_t i = 0; i < inds.size(); i++) {
+        res << "__" << (hashKeys[i].empty() ? "" : "h") << join(inds[i], "_");
     }
 
     for (auto& search : getMinIndexSelection().getSearches()) {
         res << "__" << search;
     }
 
+    if (hasHashSet) {
+        res << "__hset";
+    }
+
     return res.str();
 }
 
@@ -182,19 +207,32 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
                    "souffle::detail::default_strategy<t_tuple>::type, index_utils::comparator<";
             out << join(ind.begin(), ind.end() - 2) << ">, updater_" << getTypeName() << ">;\n";
 
+            // indices serving a single search are hash indices on the columns of the search
+        } else if (!hashKeys[i].empty()) {
+            out << "using t_ind_" << i << " = HashIndex<t_tuple, " << join(hashKeys[i]) << ">;\n";
+
             // without provenance, some indices may be not full, so we use btree_multiset for those
         } else {
+            const std::string btreeType = isCounted ? "btree_counted_" : "btree_";
             if (ind.size() == arity) {
-                out << "using t_ind_" << i << " = btree_set<t_tuple, index_utils::comparator<" << join(ind)
-                    << ">>;\n";
-            } else {
-                out << "using t_ind_" << i << " = btree_multiset<t_tuple, index_utils::comparator<"
+                out << "using t_ind_" << i << " = " << btreeType << "set<t_tuple, index_utils::comparator<"
                     << join(ind) << ">>;\n";
+            } else {
+                out << "using t_ind_" << i << " = " << btreeType
+                    << "multiset<t_tuple, index_utils::comparator<" << join(ind) << ">>;\n";
             }
         }
         out << "t_ind_" << i << " ind_" << i << ";\n";
     }
 
+    // hash set of all tuples for existence checks
+    if (hasHashSet) {
+        std::vector<int> columns(arity);
+        std::iota(columns.begin(), columns.end(), 0);
+        out << "using t_hash_set = HashIndex<t_tuple, " << join(columns) << ">;\n";
+        out << "t_hash_set hash_set;\n";
+    }
+
     // typedef master index iterator to be struct iterator
     out << "using iterator = t_ind_" << masterIndex << "::iterator;\n";
 
@@ -213,11 +251,19 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "}\n";  // end of insert(t_tuple&)
 
     out << "bool insert(const t_tuple& t, context& h) {\n";
-    out << "if (ind_" << masterIndex << ".insert(t, h.hints_" << masterIndex << ")) {\n";
-    for (size_t i = 0; i < numIndexes; i++) {
-        if (i != masterIndex) {
+    if (hasHashSet) {
+        // the hash set eliminates duplicates before any of the indices is touched
+        out << "if (hash_set.insert(t)) {\n";
+        for (size_t i = 0; i < numIndexes; i++) {
             out << "ind_" << i << ".insert(t, h.hints_" << i << ");\n";
         }
+    } else {
+        out << "if (ind_" << masterIndex << ".insert(t, h.hints_" << masterIndex << ")) {\n";
+        for (size_t i = 0; i < numIndexes; i++) {
+            if (i != masterIndex) {
+                out << "ind_" << i << ".insert(t, h.hints_" << i << ");\n";
+            }
+        }
     }
     out << "return true;\n";
     out << "} else return false;\n";
@@ -253,11 +299,18 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     for (size_t i = 0; i < numIndexes; i++) {
         out << "ind_" << i << ".insertAll(other.ind_" << i << ");\n";
     }
+    if (hasHashSet) {
+        out << "hash_set.insertAll(other.hash_set);\n";
+    }
     out << "}\n";  // end of insertAll(relationType& other)
 
     // contains methods
     out << "bool contains(const t_tuple& t, context& h) const {\n";
-    out << "return ind_" << masterIndex << ".contains(t, h.hints_" << masterIndex << ");\n";
+    if (hasHashSet) {
+        out << "return hash_set.contains(t);\n";
+    } else {
+        out << "return ind_" << masterIndex << ".contains(t, h.hints_" << masterIndex << ");\n";
+    }
     out << "}\n";
 
     out << "bool contains(const t_tuple& t) const {\n";
@@ -294,9 +347,6 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         auto lexOrder = getMinIndexSelection().getLexOrder(search);
         size_t indNum = indexToNumMap[lexOrder];
 
-        out << "range<t_ind_" << indNum << "::iterator> equalRange_" << search;
-        out << "(const t_tuple& t, context& h) const {\n";
-
         // count size of search pattern
         size_t indSize = 0;
         for (size_t column = 0; column < arity; column++) {
@@ -305,8 +355,20 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
             }
         }
 
-        // use the more efficient find() method if the search pattern is full
-        if (indSize == arity) {
+        // full searches are answered by the hash set, if there is one
+        const bool useHashSet = hasHashSet && indSize == arity;
+        const std::string indType = useHashSet ? "t_hash_set" : "t_ind_" + std::to_string(indNum);
+
+        out << "range<" << indType << "::iterator> equalRange_" << search;
+        out << "(const t_tuple& t, context& h) const {\n";
+
+        if (useHashSet) {
+            out << "return hash_set.equalRange(t);\n";
+        } else if (!hashKeys[indNum].empty()) {
+            // hash indices find the tuples with the same key directly
+            out << "return ind_" << indNum << ".equalRange(t);\n";
+        } else if (indSize == arity) {
+            // use the more efficient find() method if the search pattern is full
             out << "auto pos = ind_" << indNum << ".find(t, h.hints_" << indNum << ");\n";
             out << "auto fin = ind_" << indNum << ".end();\n";
             out << "if (pos != fin) {fin = pos; ++fin;}\n";
@@ -327,11 +389,24 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
         }
         out << "}\n";
 
-        out << "range<t_ind_" << indNum << "::iterator> equalRange_" << search;
+        out << "range<" << indType << "::iterator> equalRange_" << search;
         out << "(const t_tuple& t) const {\n";
         out << "context h;\n";
         out << "return equalRange_" << search << "(t, h);\n";
         out << "}\n";
+
+        // count the tuples of a range in logarithmic time while frozen
+        if (isCounted) {
+            out << "std::size_t countRange_" << search << "(const t_tuple& t, context& h) const {\n";
+            out << "auto r = equalRange_" << search << "(t, h);\n";
+            if (useHashSet || !hashKeys[indNum].empty()) {
+                // the tuples of a hash bucket are stored contiguously
+                out << "return r.end() - r.begin();\n";
+            } else {
+                out << "return ind_" << indNum << ".count(r.begin(), r.end());\n";
+            }
+            out << "}\n";
+        }
     }
 
     // empty method
@@ -349,6 +424,22 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     for (size_t i = 0; i < numIndexes; i++) {
         out << "ind_" << i << ".clear();\n";
     }
+    if (hasHashSet) {
+        out << "hash_set.clear();\n";
+    }
+    out << "}\n";
+
+    // freeze and unfreeze methods for read-only phases
+    out << "void freeze() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".freeze();\n";
+    }
+    out << "}\n";
+
+    out << "void unfreeze() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".unfreeze();\n";
+    }
     out << "}\n";
 
     // begin and end iterators
@@ -360,9 +451,26 @@ void SynthesiserDirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return ind_" << masterIndex << ".end();\n";
     out << "}\n";
 
+    // getMemoryUsageByIndex method
+    out << "std::map<std::string, std::size_t> getMemoryUsageByIndex() const {\n";
+    out << "std::map<std::string, std::size_t> res;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res[\"" << inds[i] << "\"] = ind_" << i << ".getMemoryUsage();\n";
+    }
+    if (hasHashSet) {
+        out << "res[\"hash set\"] = hash_set.getMemoryUsage();\n";
+    }
+    out << "return res;\n";
+    out << "}\n";
+
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
+        if (!hashKeys[i].empty()) {
+            out << "o << prefix << \"arity " << getArity() << " direct hash index " << hashKeys[i]
+                << ": no hints\\n\";\n";
+            continue;
+        }
         out << "const auto& stats_" << i << " = ind_" << i << ".getHintStatistics();\n";
         out << "o << prefix << \"arity " << getArity() << " direct b-tree index " << inds[i]
             << ": (hits/misses/total)\\n\";\n";
@@ -649,6 +757,19 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "dataTable.clear();\n";
     out << "}\n";
 
+    // freeze and unfreeze methods for read-only phases
+    out << "void freeze() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".freeze();\n";
+    }
+    out << "}\n";
+
+    out << "void unfreeze() {\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "ind_" << i << ".unfreeze();\n";
+    }
+    out << "}\n";
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return ind_" << masterIndex << ".begin();\n";
@@ -658,6 +779,16 @@ void SynthesiserIndirectRelation::generateTypeStruct(std::ostream& out) {
     out << "return ind_" << masterIndex << ".end();\n";
     out << "}\n";
 
+    // getMemoryUsageByIndex method, the tuples are stored once for all indexes
+    out << "std::map<std::string, std::size_t> getMemoryUsageByIndex() const {\n";
+    out << "std::map<std::string, std::size_t> res;\n";
+    out << "res[\"tuples\"] = dataTable.getMemoryUsage();\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res[\"" << inds[i] << "\"] = ind_" << i << ".getMemoryUsage();\n";
+    }
+    out << "return res;\n";
+    out << "}\n";
+
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
@@ -943,6 +1074,10 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // freeze and unfreeze methods, no read-only mode for this representation
+    out << "void freeze() {}\n";
+    out << "void unfreeze() {}\n";
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".begin());\n";
@@ -952,6 +1087,15 @@ void SynthesiserBrieRelation::generateTypeStruct(std::ostream& out) {
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".end());\n";
     out << "}\n";
 
+    // getMemoryUsageByIndex method
+    out << "std::map<std::string, std::size_t> getMemoryUsageByIndex() const {\n";
+    out << "std::map<std::string, std::size_t> res;\n";
+    for (size_t i = 0; i < numIndexes; i++) {
+        out << "res[\"" << inds[i] << "\"] = ind_" << i << ".getMemoryUsage();\n";
+    }
+    out << "return res;\n";
+    out << "}\n";
+
     // TODO: finish printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     for (size_t i = 0; i < numIndexes; i++) {
@@ -1175,6 +1319,10 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     }
     out << "}\n";
 
+    // freeze and unfreeze methods, no read-only mode for this representation
+    out << "void freeze() {}\n";
+    out << "void unfreeze() {}\n";
+
     // begin and end iterators
     out << "iterator begin() const {\n";
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".begin());\n";
@@ -1184,6 +1332,11 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     out << "return iterator_" << masterIndex << "(ind_" << masterIndex << ".end());\n";
     out << "}\n";
 
+    // getMemoryUsageByIndex method, the other orders are views of the equivalence relation
+    out << "std::map<std::string, std::size_t> getMemoryUsageByIndex() const {\n";
+    out << "return {{\"" << inds[masterIndex] << "\", ind_" << masterIndex << ".getMemoryUsage()}};\n";
+    out << "}\n";
+
     // printHintStatistics method
     out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
     out << "o << \"eqrel index: no hint statistics supported\\n\";\n";
@@ -1214,6 +1367,156 @@ void SynthesiserEqrelRelation::generateTypeStruct(std::ostream& out) {
     out << "};\n";
 }
 
+// -------- Bitmap Relation --------
+
+/** Generate index set for a bitmap relation */
+void SynthesiserBitmapRelation::computeIndices() {
+    assert(!isProvenance && "bitmap cannot be used with provenance");
+    assert(getArity() == 1 && "bitmap relation not unary");
+
+    masterIndex = 0;
+    // a unary relation has a single order only
+    computedIndices = {{0}};
+}
+
+/** Generate type name of a bitmap relation */
+std::string SynthesiserBitmapRelation::getTypeName() {
+    return "t_bitmap";
+}
+
+/** Generate type struct of a bitmap relation */
+void SynthesiserBitmapRelation::generateTypeStruct(std::ostream& out) {
+    // struct definition
+    out << "struct " << getTypeName() << " {\n";
+
+    // the unary trie is a thin layer on top of a sparse bit-map
+    out << "using t_ind_" << masterIndex << " = Trie<1>;\n";
+    out << "t_ind_" << masterIndex << " ind_" << masterIndex << ";\n";
+    out << "using t_tuple = t_ind_" << masterIndex << "::entry_type;\n";
+    out << "using iterator = t_ind_" << masterIndex << "::iterator;\n";
+
+    // hints struct
+    out << "struct context {\n";
+    out << "t_ind_" << masterIndex << "::op_context hints_" << masterIndex << ";\n";
+    out << "};\n";
+    out << "context createContext() { return context(); }\n";
+
+    // insert methods
+    out << "bool insert(const t_tuple& t) {\n";
+    out << "context h;\n";
+    out << "return insert(t, h);\n";
+    out << "}\n";
+
+    out << "bool insert(const t_tuple& t, context& h) {\n";
+    out << "return ind_" << masterIndex << ".insert(t, h.hints_" << masterIndex << ");\n";
+    out << "}\n";
+
+    out << "bool insert(const RamDomain* ramDomain) {\n";
+    out << "const t_tuple& tuple = reinterpret_cast<const t_tuple&>(*ramDomain);\n";
+    out << "context h;\n";
+    out << "return insert(tuple, h);\n";
+    out << "}\n";
+
+    out << "bool insert(RamDomain a0) {\n";
+    out << "RamDomain data[1] = {a0};\n";
+    out << "return insert(data);\n";
+    out << "}\n";
+
+    // insertAll method
+    out << "template <typename T>\n";
+    out << "void insertAll(T& other) {\n";
+    out << "for (auto const& cur : other) {\n";
+    out << "insert(cur);\n";
+    out << "}\n";
+    out << "}\n";
+
+    // insertAll merging the bit-maps word by word
+    out << "void insertAll(" << getTypeName() << "& other) {\n";
+    out << "ind_" << masterIndex << ".insertAll(other.ind_" << masterIndex << ");\n";
+    out << "}\n";
+
+    // contains methods
+    out << "bool contains(const t_tuple& t, context& h) const {\n";
+    out << "return ind_" << masterIndex << ".contains(t, h.hints_" << masterIndex << ");\n";
+    out << "}\n";
+
+    out << "bool contains(const t_tuple& t) const {\n";
+    out << "context h;\n";
+    out << "return contains(t, h);\n";
+    out << "}\n";
+
+    // size method, counting the set bits
+    out << "std::size_t size() const {\n";
+    out << "return ind_" << masterIndex << ".size();\n";
+    out << "}\n";
+
+    // empty equalRange method
+    out << "range<iterator> equalRange_0(const t_tuple& t, context& h) const {\n";
+    out << "return range<iterator>(ind_" << masterIndex << ".begin(),ind_" << masterIndex << ".end());\n";
+    out << "}\n";
+
+    out << "range<iterator> equalRange_0(const t_tuple& t) const {\n";
+    out << "return range<iterator>(ind_" << masterIndex << ".begin(),ind_" << masterIndex << ".end());\n";
+    out << "}\n";
+
+    // equalRange methods
+    for (int64_t search : getMinIndexSelection().getSearches()) {
+        if (search == 0) continue;
+        out << "range<iterator> equalRange_" << search;
+        out << "(const t_tuple& t, context& h) const {\n";
+        out << "return ind_" << masterIndex << ".template getBoundaries<1>(t, h.hints_" << masterIndex
+            << ");\n";
+        out << "}\n";
+
+        out << "range<iterator> equalRange_" << search;
+        out << "(const t_tuple& t) const {\n";
+        out << "context h; return equalRange_" << search << "(t, h);\n";
+        out << "}\n";
+    }
+
+    // empty method
+    out << "bool empty() const {\n";
+    out << "return ind_" << masterIndex << ".empty();\n";
+    out << "}\n";
+
+    // partition method
+    out << "std::vector<range<iterator>> partition() const {\n";
+    out << "return ind_" << masterIndex << ".partition(10000);\n";
+    out << "}\n";
+
+    // purge method
+    out << "void purge() {\n";
+    out << "ind_" << masterIndex << ".clear();\n";
+    out << "}\n";
+
+    // freeze and unfreeze methods, no read-only mode for this representation
+    out << "void freeze() {}\n";
+    out << "void unfreeze() {}\n";
+
+    // begin and end iterators
+    out << "iterator begin() const {\n";
+    out << "return ind_" << masterIndex << ".begin();\n";
+    out << "}\n";
+
+    out << "iterator end() const {\n";
+    out << "return ind_" << masterIndex << ".end();\n";
+    out << "}\n";
+
+    // getMemoryUsageByIndex method
+    out << "std::map<std::string, std::size_t> getMemoryUsageByIndex() const {\n";
+    out << "return {{\"" << getIndices()[masterIndex] << "\", ind_" << masterIndex
+        << ".getMemoryUsage()}};\n";
+    out << "}\n";
+
+    // printHintStatistics method
+    out << "void printHintStatistics(std::ostream& o, const std::string prefix) const {\n";
+    out << "o << \"bitmap index: no hint statistics supported\\n\";\n";
+    out << "}\n";
+
+    // end class
+    out << "};\n";
+}
+
 // -------- Rbtset Relation --------
 
 }  // end of namespace souffle
@@ -61,9 +61,22 @@ public:
     /** Generate relation type struct */
     virtual void generateTypeStruct(std::ostream& out) = 0;
 
-    /** Factory method to generate a SynthesiserRelation */
-    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(
-            const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance);
+    /** Check whether the type maintains provenance annotations */
+    bool hasProvenance() const {
+        return isProvenance;
+    }
+
+    /** Check whether the type provides countRange methods counting in logarithmic time */
+    bool hasOrderStatistics() const {
+        return isCounted;
+    }
+
+    /**
+     * Factory method to generate a SynthesiserRelation
+     * @param isCounted request indexes supporting order statistics, if available for the representation
+     */
+    static std::unique_ptr<SynthesiserRelation> getSynthesiserRelation(const RamRelation& ramRel,
+            const MinIndexSelection& indexSet, bool isProvenance, bool isCounted = false);
 
 protected:
     /** Ram relation referred to by this */
@@ -83,6 +96,9 @@ protected:
 
     /** Is this relation used with provenance */
     const bool isProvenance;
+
+    /** Are the indexes of this relation supporting order statistics */
+    bool isCounted = false;
 };
 
 class SynthesiserNullaryRelation : public SynthesiserRelation {
@@ -98,12 +114,22 @@ public:
 
 class SynthesiserDirectRelation : public SynthesiserRelation {
 public:
-    SynthesiserDirectRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
-            : SynthesiserRelation(ramRel, indexSet, isProvenance) {}
+    SynthesiserDirectRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance,
+            bool isCounted = false)
+            : SynthesiserRelation(ramRel, indexSet, isProvenance) {
+        this->isCounted = isCounted && !isProvenance;
+    }
 
     void computeIndices() override;
     std::string getTypeName() override;
     void generateTypeStruct(std::ostream& out) override;
+
+protected:
+    /** Key columns of each index, if it is a hash index, or empty for b-tree indices */
+    MinIndexSelection::OrderCollection hashKeys;
+
+    /** Whether existence checks are answered by a hash set of all tuples */
+    bool hasHashSet = false;
 };
 
 class SynthesiserIndirectRelation : public SynthesiserRelation {
@@ -137,4 +163,14 @@ public:
     void generateTypeStruct(std::ostream& out) override;
 };
 
+class SynthesiserBitmapRelation : public SynthesiserRelation {
+public:
+    SynthesiserBitmapRelation(const RamRelation& ramRel, const MinIndexSelection& indexSet, bool isProvenance)
+            : SynthesiserRelation(ramRel, indexSet, isProvenance) {}
+
+    void computeIndices() override;
+    std::string getTypeName() override;
+    void generateTypeStruct(std::ostream& out) override;
+};
+
 }  // end of namespace souffle
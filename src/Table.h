@@ -101,6 +101,15 @@ public:
         return count;
     }
 
+    /** The number of bytes allocated by this table */
+    std::size_t getMemoryUsage() const {
+        std::size_t res = sizeof(*this);
+        for (Block* cur = head; cur != nullptr; cur = cur->next) {
+            res += sizeof(Block);
+        }
+        return res;
+    }
+
     const T& insert(const T& element) {
         // check whether the head is initialized
         if (!head) {
@@ -0,0 +1,165 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file TaskGraph.h
+ *
+ * A graph of tasks executed concurrently as soon as the tasks they depend
+ * on have completed. Used for running independent strata in parallel.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <queue>
+#include <vector>
+
+#ifdef IS_PARALLEL
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace souffle {
+
+/**
+ * A directed acyclic graph of tasks. A task may only depend on tasks added
+ * before it, hence the order of insertion is a valid sequential schedule.
+ *
+ * Running the graph starts each task once all of its predecessors have
+ * completed. The threads of the parallel region are divided among the tasks
+ * running at the time a task starts, such that a single task on the critical
+ * path still utilises all threads.
+ */
+class TaskGraph {
+public:
+    /**
+     * Add a task to the graph
+     * @param task the task to be run
+     * @param predecessors the identifiers of the tasks that have to complete first
+     * @return the identifier of the new task
+     */
+    size_t addTask(std::function<void()> task, const std::vector<size_t>& predecessors = {}) {
+        const size_t id = tasks.size();
+        tasks.push_back(std::move(task));
+        successors.emplace_back();
+        numPredecessors.push_back(predecessors.size());
+        for (size_t pred : predecessors) {
+            assert(pred < id && "task depends on a later task");
+            successors[pred].push_back(id);
+        }
+        return id;
+    }
+
+    /** Run all tasks, respecting their dependencies */
+    void run() {
+#ifdef IS_PARALLEL
+        const size_t numThreads = std::min<size_t>(MAX_THREADS, tasks.size());
+        if (numThreads > 1) {
+            runParallel(numThreads);
+            return;
+        }
+#endif
+        for (auto& task : tasks) {
+            task();
+        }
+    }
+
+private:
+    /** the tasks in order of insertion */
+    std::vector<std::function<void()>> tasks;
+
+    /** the tasks depending on each task */
+    std::vector<std::vector<size_t>> successors;
+
+    /** the number of tasks each task depends on */
+    std::vector<size_t> numPredecessors;
+
+#ifdef IS_PARALLEL
+    void runParallel(size_t numThreads) {
+#if defined(_OPENMP) && !defined(SOUFFLE_WORK_STEALING)
+        const size_t maxThreads = MAX_THREADS;
+#endif
+        std::vector<size_t> pending(numPredecessors);
+
+        // ready tasks, preferring those earlier in the sequential order
+        std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+        for (size_t id = 0; id < tasks.size(); ++id) {
+            if (pending[id] == 0) {
+                ready.push(id);
+            }
+        }
+
+        std::mutex lock;
+        std::condition_variable changed;
+        size_t running = 0;
+        size_t completed = 0;
+        std::exception_ptr failure;
+
+        auto worker = [&]() {
+            std::unique_lock<std::mutex> guard(lock);
+            while (true) {
+                changed.wait(guard, [&]() { return !ready.empty() || completed == tasks.size() || failure; });
+                if (ready.empty() || failure) {
+                    return;
+                }
+                const size_t id = ready.top();
+                ready.pop();
+                ++running;
+
+#if defined(_OPENMP) && !defined(SOUFFLE_WORK_STEALING)
+                // share the threads among the currently running tasks
+                omp_set_num_threads(std::max<size_t>(1, maxThreads / running));
+#endif
+
+                guard.unlock();
+                try {
+                    tasks[id]();
+                } catch (...) {
+                    guard.lock();
+                    failure = std::current_exception();
+                    changed.notify_all();
+                    return;
+                }
+                guard.lock();
+
+                --running;
+                ++completed;
+                for (size_t succ : successors[id]) {
+                    if (--pending[succ] == 0) {
+                        ready.push(succ);
+                    }
+                }
+                changed.notify_all();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back(worker);
+        }
+        for (auto& cur : workers) {
+            cur.join();
+        }
+
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+#endif
+};
+
+}  // namespace souffle
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "LambdaBTree.h"
+#include "ParallelUtils.h"
 #include "PiggyList.h"
 
 #include <atomic>
@@ -76,6 +77,11 @@ public:
         return sz;
     };
 
+    /** The number of bytes allocated by this disjoint set */
+    size_t getMemoryUsage() const {
+        return sizeof(*this) - sizeof(a_blocks) + a_blocks.getMemoryUsage();
+    }
+
     /**
      * Yield reference to the node by its node index
      * @param node node to be searched
@@ -321,10 +327,31 @@ public:
         ds.unionNodes(toDense(x), toDense(y));
     };
 
+    /**
+     * Union all the given pairs of nodes, adding nodes if not existing.
+     * The pairs are processed in parallel, relying on the lock-free registration
+     * of nodes and the CAS-based union/find of the underlying disjoint set.
+     * @param pairs the pairs of sparse values to be unioned
+     */
+    void unionAll(const std::vector<std::pair<SparseDomain, SparseDomain>>& pairs) {
+        PARALLEL_START {
+            pfor_range(it, pairs.begin(), pairs.end()) {
+                ds.unionNodes(toDense(it->first), toDense(it->second));
+            }
+        }
+        PARALLEL_END
+    }
+
     inline std::size_t size() {
         return ds.size();
     };
 
+    /** The number of bytes allocated by this disjoint set, including the mappings of the values */
+    std::size_t getMemoryUsage() const {
+        return sizeof(*this) - sizeof(ds) - sizeof(sparseToDenseMap) - sizeof(denseToSparseMap) +
+               ds.getMemoryUsage() + sparseToDenseMap.getMemoryUsage() + denseToSparseMap.getMemoryUsage();
+    }
+
     /**
      * Remove all elements from this disjoint set
      */
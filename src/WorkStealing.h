@@ -0,0 +1,398 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WorkStealing.h
+ *
+ * A dependency-free work-stealing backend for the parallel control flow
+ * constructs of ParallelUtils.h, selected by defining SOUFFLE_WORK_STEALING.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ParallelUtils.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A pool of worker threads executing parallel regions.
+ *
+ * The thread starting a region always takes part in it; idle workers join
+ * while the region is open. Every participant executes the body of the region.
+ * The iterations of a loop within the region are split evenly among the slots
+ * of the region up front. A participant running out of iterations steals the
+ * upper half of the remaining iterations of another slot, so the iterations
+ * left over by a skewed slot are split again and again among the idle
+ * participants. Iterations left in the slot of a thread that never joined are
+ * stolen as well. A single iteration is never split: if it is a chunk of a
+ * relation, a heavy chunk runs on one thread.
+ *
+ * Loops do not end with a barrier; the end of the region waits for all
+ * participants. A loop is freed once its iterations are all claimed and no
+ * participant iterates over it any more, so a region may run any number of loops.
+ */
+class WorkStealingPool {
+    /** the iterations of a loop assigned to one slot, padded against false sharing */
+    struct Slot {
+        SpinLock lock;
+        size_t begin = 0;
+        size_t end = 0;
+        char padding[64];
+    };
+
+    /** the shared state of a loop in a region */
+    struct Loop {
+        std::unique_ptr<Slot[]> slots;
+        size_t numSlots;
+        // the number of participants iterating over the loop
+        size_t holders = 0;
+
+        Loop(size_t numIterations, size_t numSlots) : slots(new Slot[numSlots]), numSlots(numSlots) {
+            for (size_t i = 0; i < numSlots; ++i) {
+                slots[i].begin = numIterations * i / numSlots;
+                slots[i].end = numIterations * (i + 1) / numSlots;
+            }
+        }
+
+        /**
+         * Claim the next iteration for the given slot, stealing if the slot is exhausted.
+         * @return false if all iterations of the loop have been claimed
+         */
+        bool claim(size_t slot, size_t& iteration) {
+            Slot& own = slots[slot];
+            own.lock.lock();
+            if (own.begin < own.end) {
+                iteration = own.begin++;
+                own.lock.unlock();
+                return true;
+            }
+            own.lock.unlock();
+
+            for (size_t i = 1; i < numSlots; ++i) {
+                Slot& victim = slots[(slot + i) % numSlots];
+                victim.lock.lock();
+                const size_t left = victim.end - victim.begin;
+                if (left == 0) {
+                    victim.lock.unlock();
+                    continue;
+                }
+                // take the upper half of the remaining iterations
+                const size_t begin = victim.end - (left + 1) / 2;
+                const size_t end = victim.end;
+                victim.end = begin;
+                victim.lock.unlock();
+
+                own.lock.lock();
+                own.begin = begin + 1;
+                own.end = end;
+                own.lock.unlock();
+                iteration = begin;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    /** a parallel region */
+    struct Region {
+        const std::function<void()>& body;
+        std::mutex lock;
+        // the loops from the index firstLoop on; freed loops are null or dropped from the front
+        std::deque<std::unique_ptr<Loop>> loops;
+        size_t firstLoop = 0;
+        size_t numParticipants = 1;
+        size_t active = 1;
+        std::exception_ptr failure;
+
+        explicit Region(const std::function<void()>& body) : body(body) {}
+    };
+
+    /** the region and slot the current thread participates in */
+    struct Context {
+        Region* region;
+        size_t slot;
+        size_t numLoops;
+    };
+
+    static Context*& currentContext() {
+        static thread_local Context* context = nullptr;
+        return context;
+    }
+
+public:
+    /**
+     * The iterations of a loop claimed by the current participant.
+     */
+    template <typename T>
+    class SharedRange {
+        T first;
+        Region* region;
+        size_t index;
+        Loop* loop;
+        size_t slot;
+        size_t numIterations;
+
+    public:
+        class iterator : public std::iterator<std::input_iterator_tag, T> {
+            SharedRange* range;
+            size_t iteration = 0;
+            bool done;
+
+            void next() {
+                if (range->loop != nullptr) {
+                    done = !range->loop->claim(range->slot, iteration);
+                    if (done) {
+                        release(*range->region, range->index);
+                        range->loop = nullptr;
+                    }
+                } else {
+                    done = ++iteration >= range->numIterations;
+                }
+            }
+
+        public:
+            iterator(SharedRange* range, bool end) : range(range), done(end) {
+                if (!done) {
+                    if (range->loop != nullptr) {
+                        next();
+                    } else {
+                        done = range->numIterations == 0;
+                    }
+                }
+            }
+
+            T operator*() const {
+                return range->first + iteration;
+            }
+
+            iterator& operator++() {
+                next();
+                return *this;
+            }
+
+            bool operator==(const iterator& other) const {
+                return done == other.done && (done || iteration == other.iteration);
+            }
+
+            bool operator!=(const iterator& other) const {
+                return !(*this == other);
+            }
+        };
+
+        SharedRange(T first, Region* region, size_t index, Loop* loop, size_t slot, size_t numIterations)
+                : first(first), region(region), index(index), loop(loop), slot(slot),
+                  numIterations(numIterations) {}
+
+        iterator begin() {
+            return iterator(this, false);
+        }
+
+        iterator end() {
+            return iterator(this, true);
+        }
+    };
+
+    static WorkStealingPool& instance() {
+        static WorkStealingPool pool;
+        return pool;
+    }
+
+    /** Set the number of threads executing a parallel region, including the starting thread */
+    static void setNumThreads(size_t numThreads) {
+        instance().resize(std::max<size_t>(1, numThreads));
+    }
+
+    size_t getNumThreads() const {
+        return numThreads;
+    }
+
+    /** Determine whether the current thread is executing a parallel region */
+    static bool inParallel() {
+        return currentContext() != nullptr;
+    }
+
+    /** Execute the given body as a parallel region */
+    void run(const std::function<void()>& body) {
+        Region region(body);
+        if (numThreads > 1) {
+            std::lock_guard<std::mutex> guard(lock);
+            start();
+            open.push_back(&region);
+            wakeup.notify_all();
+        }
+
+        participate(region, 0);
+
+        std::unique_lock<std::mutex> guard(lock);
+        auto pos = std::find(open.begin(), open.end(), &region);
+        if (pos != open.end()) {
+            open.erase(pos);
+        }
+        --region.active;
+        finished.wait(guard, [&]() { return region.active == 0; });
+        guard.unlock();
+
+        if (region.failure) {
+            std::rethrow_exception(region.failure);
+        }
+    }
+
+    /**
+     * Share the iterations from begin to end among the participants of the current
+     * region. Outside of a region all iterations are claimed by the current thread.
+     */
+    template <typename T>
+    static SharedRange<T> share(T begin, T end) {
+        const size_t numIterations = (begin < end) ? end - begin : 0;
+        Context* context = currentContext();
+        if (context == nullptr) {
+            return SharedRange<T>(begin, nullptr, 0, nullptr, 0, numIterations);
+        }
+
+        // the n-th loop of each participant is the n-th loop of the region
+        Region& region = *context->region;
+        const size_t index = context->numLoops++;
+        Loop* loop = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(region.lock);
+            if (index >= region.firstLoop) {
+                if (region.firstLoop + region.loops.size() <= index) {
+                    region.loops.emplace_back(new Loop(numIterations, instance().numThreads));
+                }
+                loop = region.loops[index - region.firstLoop].get();
+            }
+            if (loop == nullptr) {
+                // the loop was freed, all its iterations have been claimed
+                return SharedRange<T>(begin, nullptr, 0, nullptr, 0, 0);
+            }
+            ++loop->holders;
+        }
+        return SharedRange<T>(begin, &region, index, loop, context->slot, numIterations);
+    }
+
+    ~WorkStealingPool() {
+        stop();
+    }
+
+private:
+    /** the number of threads including the thread starting a region */
+    size_t numThreads = 1;
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+    std::deque<Region*> open;
+    bool shutdown = false;
+
+    WorkStealingPool() {
+        resize(std::max<size_t>(1, std::thread::hardware_concurrency()));
+    }
+
+    /** Set the number of threads, the workers are started by the next region */
+    void resize(size_t num) {
+        stop();
+        numThreads = num;
+    }
+
+    /**
+     * Start the workers if they are not running, with the lock held. The workers are started by
+     * the first region rather than up front, so that a program may fork before it has any threads.
+     */
+    void start() {
+        if (!workers.empty()) {
+            return;
+        }
+        shutdown = false;
+        for (size_t i = 1; i < numThreads; ++i) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            shutdown = true;
+            wakeup.notify_all();
+        }
+        for (auto& cur : workers) {
+            cur.join();
+        }
+        workers.clear();
+    }
+
+    /** The loop of a worker, joining open regions until shut down */
+    void work() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            wakeup.wait(guard, [&]() { return shutdown || !open.empty(); });
+            if (shutdown) {
+                return;
+            }
+            Region& region = *open.front();
+            const size_t slot = region.numParticipants++;
+            ++region.active;
+            if (region.numParticipants == numThreads) {
+                open.pop_front();
+            }
+            guard.unlock();
+
+            participate(region, slot);
+
+            guard.lock();
+            if (--region.active == 0) {
+                finished.notify_all();
+            }
+        }
+    }
+
+    /** Stop iterating over the given loop of a region, freeing it if no other participant does */
+    static void release(Region& region, size_t index) {
+        std::lock_guard<std::mutex> guard(region.lock);
+        auto& loop = region.loops[index - region.firstLoop];
+        if (--loop->holders == 0) {
+            loop.reset();
+            while (!region.loops.empty() && !region.loops.front()) {
+                region.loops.pop_front();
+                ++region.firstLoop;
+            }
+        }
+    }
+
+    /** Execute the body of a region in the given slot */
+    void participate(Region& region, size_t slot) {
+        Context context{&region, slot, 0};
+        Context* outer = currentContext();
+        currentContext() = &context;
+        try {
+            region.body();
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(region.lock);
+            if (!region.failure) {
+                region.failure = std::current_exception();
+            }
+        }
+        currentContext() = outer;
+    }
+};
+
+}  // namespace souffle
@@ -30,6 +30,7 @@
 #include "ParserDriver.h"
 #include "RAMI.h"
 #include "RAMIProgInterface.h"
+#include "RamIndexAnalysis.h"
 #include "RamProgram.h"
 #include "RamTransformer.h"
 #include "RamTransforms.h"
@@ -45,20 +46,29 @@
 #include "PrecedenceGraph.h"
 #endif
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
+#include <ctime>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
 namespace souffle {
 /**
  * Executes a binary file.
@@ -79,7 +89,7 @@ void executeBinary(const std::string& binaryFilename
     // run the executable
     int exitCode;
 #ifdef USE_MPI
-    if (Global::config().get("engine") == "mpi") {
+    if (Global::config().get("engine") == "mpi" || Global::config().has("data-parallel")) {
         std::stringstream ss;
         ss << "mpiexec";
         if (Global::config().has("hostfile")) {
@@ -114,9 +124,237 @@ void executeBinary(const std::string& binaryFilename
 }
 
 /**
- * Compiles the given source file to a binary file.
+ * Extends a 64-bit FNV-1a hash by the given data.
+ */
+uint64_t hashData(uint64_t hash, const std::string& data) {
+    // include a terminator such that concatenations of different fields differ
+    for (const char c : data + '\0') {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * Reads the content of a file, or returns the empty string if it cannot be read.
+ */
+std::string readFile(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+/**
+ * Copies a file, making the copy executable.
+ */
+bool copyExecutable(const std::string& from, const std::string& to) {
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    if (!in || !out || !(out << in.rdbuf())) {
+        return false;
+    }
+    out.close();
+    return out && chmod(to.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == 0;
+}
+
+/**
+ * Lists the entries of a directory in lexicographical order, without "." and "..".
+ */
+std::vector<std::string> listDirectory(const std::string& dir) {
+    std::vector<std::string> entries;
+    DIR* handle = opendir(dir.c_str());
+    if (handle == nullptr) {
+        return entries;
+    }
+    while (const dirent* entry = readdir(handle)) {
+        const std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            entries.push_back(name);
+        }
+    }
+    closedir(handle);
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+/**
+ * Extends a hash by the names and contents of all files below the given directory.
+ */
+uint64_t hashDirectory(uint64_t hash, const std::string& dir) {
+    for (const std::string& name : listDirectory(dir)) {
+        const std::string path = dir + "/" + name;
+        hash = hashData(hash, name);
+        hash = existDir(path) ? hashDirectory(hash, path) : hashData(hash, readFile(path));
+    }
+    return hash;
+}
+
+/**
+ * Returns a description of the host processor, as souffle-compile targets it with -march=native.
+ *
+ * On Linux these are the model and the features of the first processor in /proc/cpuinfo,
+ * leaving out the fields varying from boot to boot such as the clock. Elsewhere these are the
+ * brand and the features reported by sysctl.
+ */
+std::string getHostProcessor() {
+    static const std::set<std::string> fields = {"vendor_id", "cpu family", "model", "model name",
+            "stepping", "flags", "CPU implementer", "CPU architecture", "CPU variant", "CPU part",
+            "Features"};
+
+    std::string processor;
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line) && !line.empty()) {
+        std::string field = line.substr(0, line.find(':'));
+        field.erase(field.find_last_not_of(" \t") + 1);
+        if (fields.find(field) != fields.end()) {
+            processor += line + '\n';
+        }
+    }
+    if (!processor.empty()) {
+        return processor;
+    }
+
+    FILE* in = popen(
+            "sysctl -n machdep.cpu.brand_string machdep.cpu.features machdep.cpu.leaf7_features "
+            "hw.cputype hw.cpusubtype 2>/dev/null",
+            "r");
+    if (in != nullptr) {
+        char buffer[256];
+        while (fgets(buffer, sizeof(buffer), in) != nullptr) {
+            processor += buffer;
+        }
+        pclose(in);
+    }
+    return processor;
+}
+
+/**
+ * Returns the file of the compile cache holding the binary of the given source files.
+ *
+ * The key is a hash of the sources along with the header generated for split units, the
+ * compile command, the souffle-compile script, the environment variables read by it, the
+ * runtime headers it compiles against and the host processor, as the binary is tuned for it
+ * and may use instructions other processors lack. The name of a temporary file, which differs
+ * for each run, is masked in the sources, such that runs of the same program share a binary.
+ */
+std::string getCompileCacheFile(
+        const std::string& compileCmd, const std::vector<std::string>& sourceFilenames, bool temporary) {
+    const std::string name = simpleName(sourceFilenames.front());
+    const std::string mask = "__souffle_program__";
+    const std::string compileScript = splitString(compileCmd, ' ').front();
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = hashData(hash, PACKAGE_VERSION);
+    hash = hashData(hash, compileCmd);
+    hash = hashData(hash, readFile(compileScript));
+    for (const char* var : {"CXX", "CPPFLAGS", "CXXFLAGS", "LDFLAGS", "LIBS"}) {
+        const char* value = getenv(var);
+        hash = hashData(hash, value == nullptr ? "" : value);
+    }
+    // souffle-compile finds the headers relative to its own location
+    hash = hashDirectory(hash, dirName(compileScript) + "/../include/souffle");
+    hash = hashData(hash, getHostProcessor());
+
+    std::vector<std::string> generatedFilenames = sourceFilenames;
+    if (sourceFilenames.size() > 1) {
+        const std::string& mainFilename = sourceFilenames.front();
+        generatedFilenames.push_back(mainFilename.substr(0, mainFilename.size() - 4) + ".h");
+    }
+    for (const std::string& sourceFilename : generatedFilenames) {
+        std::string source = readFile(sourceFilename);
+        for (const std::string& id : {name, identifier(name)}) {
+            for (size_t pos = source.find(id); temporary && pos != std::string::npos;
+                    pos = source.find(id, pos)) {
+                source.replace(pos, id.size(), mask);
+                pos += mask.size();
+            }
+        }
+        hash = hashData(hash, source);
+    }
+
+    std::string dir;
+    if (getenv("SOUFFLE_CACHE_DIR") != nullptr) {
+        dir = getenv("SOUFFLE_CACHE_DIR");
+    } else if (getenv("XDG_CACHE_HOME") != nullptr) {
+        dir = std::string(getenv("XDG_CACHE_HOME")) + "/souffle";
+    } else {
+        dir = std::string(getenv("HOME") == nullptr ? "." : getenv("HOME")) + "/.cache/souffle";
+    }
+
+    std::stringstream file;
+    file << dir << "/bin/" << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return file.str();
+}
+
+/**
+ * Evicts binaries from the given directory of the compile cache, starting with the least
+ * recently used, until it holds at most the given number of bytes. Binaries unused for 30
+ * days are evicted regardless.
+ */
+void evictCompileCacheFiles(const std::string& dir, uint64_t capacity) {
+    const time_t expiry = time(nullptr) - 30 * 24 * 60 * 60;
+
+    // the cached binaries, most recently used first
+    std::vector<std::pair<time_t, std::string>> files;
+    for (const std::string& name : listDirectory(dir)) {
+        struct stat status;
+        if (stat((dir + "/" + name).c_str(), &status) == 0 && S_ISREG(status.st_mode)) {
+            files.emplace_back(status.st_mtime, name);
+        }
+    }
+    std::sort(files.rbegin(), files.rend());
+
+    uint64_t size = 0;
+    for (const auto& file : files) {
+        const std::string path = dir + "/" + file.second;
+        struct stat status;
+        if (stat(path.c_str(), &status) != 0) {
+            continue;
+        }
+        size += status.st_size;
+        if (size > capacity || file.first < expiry) {
+            remove(path.c_str());
+        }
+    }
+}
+
+/**
+ * Stores a binary in the compile cache. Failures are ignored, as the cache is an optimisation only.
  */
-void compileToBinary(std::string compileCmd, const std::string& sourceFilename) {
+void storeCompileCacheFile(const std::string& binaryFilename, const std::string& cacheFilename) {
+    // create the cache directory and its parents
+    const std::string dir = dirName(cacheFilename);
+    size_t pos = 0;
+    do {
+        pos = dir.find('/', pos + 1);
+        mkdir(dir.substr(0, pos).c_str(), S_IRWXU | S_IRWXG | S_IRWXO);
+    } while (pos != std::string::npos);
+
+    // rename a private copy, such that concurrent runs never see a partial binary
+    const std::string tmpFilename = cacheFilename + "." + std::to_string(getpid());
+    if (!copyExecutable(binaryFilename, tmpFilename) ||
+            rename(tmpFilename.c_str(), cacheFilename.c_str()) != 0) {
+        remove(tmpFilename.c_str());
+    }
+
+    // bound the size of the cache, given in MiB
+    const char* capacity = getenv("SOUFFLE_CACHE_SIZE");
+    const uint64_t megabytes =
+            (capacity != nullptr && isNumber(capacity) && atoll(capacity) > 0) ? atoll(capacity) : 1024;
+    evictCompileCacheFiles(dir, megabytes << 20);
+}
+
+/**
+ * Compiles the given source files to a binary file.
+ *
+ * The binary is named after the first source file. If the compile cache is enabled, a binary
+ * compiled before from the same sources and flags is reused instead of compiling them again.
+ * The sources of temporary programs are named after a temporary file.
+ */
+void compileToBinary(
+        std::string compileCmd, const std::vector<std::string>& sourceFilenames, bool temporary) {
     // add source code
     compileCmd += ' ';
     for (const std::string& path : splitString(Global::config().get("library-dir"), ' ')) {
@@ -134,11 +372,33 @@ void compileToBinary(std::string compileCmd, const std::string& sourceFilename)
         compileCmd += "-l" + library + ' ';
     }
 
-    compileCmd += sourceFilename;
+    const std::string binaryFilename =
+            sourceFilenames.front().substr(0, sourceFilenames.front().size() - 4);
+
+    std::string cacheFilename;
+    if (Global::config().has("compile-cache")) {
+        cacheFilename = getCompileCacheFile(compileCmd, sourceFilenames, temporary);
+        if (existFile(cacheFilename) && copyExecutable(cacheFilename, binaryFilename)) {
+            // record the use, such that the binary is evicted last
+            utime(cacheFilename.c_str(), nullptr);
+            if (Global::config().has("verbose")) {
+                std::cout << "Using cached binary <" << cacheFilename << ">\n";
+            }
+            return;
+        }
+    }
+
+    for (const std::string& sourceFilename : sourceFilenames) {
+        compileCmd += sourceFilename + ' ';
+    }
 
     // run executable
     if (system(compileCmd.c_str()) != 0) {
-        throw std::invalid_argument("failed to compile C++ source <" + sourceFilename + ">");
+        throw std::invalid_argument("failed to compile C++ source <" + sourceFilenames.front() + ">");
+    }
+
+    if (!cacheFilename.empty()) {
+        storeCompileCacheFile(binaryFilename, cacheFilename);
     }
 }
 
@@ -201,16 +461,32 @@ int main(int argc, char** argv) {
                 {"dl-program", 'o', "FILE", "", false,
                         "Generate C++ source code, written to <FILE>, and compile this to a "
                         "binary executable (without executing it)."},
+                {"split-units", '\5', "N", "", false,
+                        "Split the generated C++ code into at most N translation units holding whole "
+                        "strata, which are compiled in parallel."},
+                {"compile-cache", '\6', "", "", false,
+                        "Reuse the binary compiled before from identical C++ code and compiler flags, "
+                        "cached in $SOUFFLE_CACHE_DIR (default: ~/.cache/souffle). The least recently "
+                        "used binaries are evicted beyond $SOUFFLE_CACHE_SIZE MiB (default: 1024)."},
                 {"live-profile", '\4', "", "", false, "Enable live profiling."},
                 {"profile", 'p', "FILE", "", false, "Enable profiling, and write profile data to <FILE>."},
+                {"profile-sampling", '\10', "N", "", false,
+                        "Profile by sampling the evaluated rule every N microseconds of CPU time, "
+                        "instead of timing each rule."},
+                {"profile-counters", '\11', "", "", false,
+                        "Record the hardware performance counters of each rule in the profile. The counters "
+                        "count the whole process, so rules evaluated in parallel count each other's events."},
                 {"profile-use", 'u', "FILE", "", false,
                         "Use profile log-file <FILE> for profile-guided optimization."},
                 {"debug-report", 'r', "FILE", "", false, "Write HTML debug report to <FILE>."},
                 {"pragma", 'P', "OPTIONS", "", false, "Set pragma options."},
                 {"provenance", 't', "[ none | explain | explore ]", "", false,
                         "Enable provenance instrumentation and interaction."},
-                {"engine", 'e', "[ file | mpi ]", "", false,
+                {"engine", 'e', "[ file | mpi | shm ]", "", false,
                         "Specify communication engine for distributed execution."},
+                {"data-parallel", '\7', "N", "", false,
+                        "Run N MPI processes, which share the evaluation of recursive strata by "
+                        "partitioning the tuples they derive by their hash value."},
                 {"interpreter", '\1', "[ RAMI | LVM ]", "LVM", false, "Switch interpreter implementation."},
                 {"hostfile", '\2', "FILE", "", false,
                         "Specify --hostfile option for call to mpiexec when using mpi as "
@@ -334,9 +610,14 @@ int main(int argc, char** argv) {
                 throw std::invalid_argument("Error: Use of engine option not yet available for interpreter.");
             }
             const auto& engine = Global::config().get("engine");
-            if (engine != "file" && engine != "mpi") {
+            if (engine != "file" && engine != "mpi" && engine != "shm") {
                 throw std::invalid_argument("Error: Use of engine '" + engine + "' is not supported.");
             }
+            // the profile of each worker process would only be recorded by the process itself
+            if (engine == "shm" && Global::config().has("profile")) {
+                throw std::invalid_argument(
+                        "Error: Use of engine '" + engine + "' requires no profile option.");
+            }
 #ifndef USE_MPI
             if (engine == "mpi") {
                 throw std::invalid_argument("Error: Use of engine '" + engine +
@@ -344,7 +625,7 @@ int main(int argc, char** argv) {
             }
             if (Global::config().has("hostfile")) {
                 throw std::invalid_argument(
-                        "Error: Use of hostfile option requires configure option '--enable-" + engine + "'.");
+                        "Error: Use of hostfile option requires configure option '--enable-mpi'.");
             }
 #else
             if (engine != "mpi" && Global::config().has("hostfile")) {
@@ -354,9 +635,66 @@ int main(int argc, char** argv) {
 #endif
         }
 
+        /* ensure that data-parallel execution is compiled and does not mix with other modes */
+        if (Global::config().has("data-parallel")) {
+            if (!(Global::config().has("compile") || Global::config().has("generate"))) {
+                throw std::invalid_argument(
+                        "Error: Use of data-parallel option not yet available for interpreter.");
+            }
+            if (Global::config().has("engine")) {
+                throw std::invalid_argument("Error: Use of data-parallel option requires no engine option.");
+            }
+            if (Global::config().has("provenance") || Global::config().has("profile") ||
+                    Global::config().has("live-profile")) {
+                throw std::runtime_error(
+                        "provenance and profiling cannot be enabled with data-parallel execution.");
+            }
+            const std::string& processes = Global::config().get("data-parallel");
+            if (!isNumber(processes.c_str()) || std::stoi(processes) < 1) {
+                throw std::runtime_error(
+                        "Number of processes in the --data-parallel option must be greater than zero!");
+            }
+#ifndef USE_MPI
+            throw std::invalid_argument(
+                    "Error: Use of data-parallel option requires configure option '--enable-mpi'.");
+#endif
+        }
+
+        /* the generated code is split into at least one translation unit besides the main unit */
+        if (Global::config().has("split-units")) {
+            const std::string& units = Global::config().get("split-units");
+            if (!isNumber(units.c_str()) || std::stoi(units) < 1) {
+                throw std::runtime_error(
+                        "Number of units in the --split-units option must be greater than zero!");
+            }
+        }
+
         if (Global::config().has("live-profile") && !Global::config().has("profile")) {
             Global::config().set("profile");
         }
+
+        /* sampling replaces the timers of a profile, which is written at the end of the run */
+        if (Global::config().has("profile-sampling")) {
+            if (!Global::config().has("profile") || Global::config().has("live-profile")) {
+                throw std::invalid_argument(
+                        "Error: Use of profile-sampling option requires the profile option and no live "
+                        "profiling.");
+            }
+            const std::string& interval = Global::config().get("profile-sampling");
+            if (!isNumber(interval.c_str()) || std::stoi(interval) < 1) {
+                throw std::runtime_error(
+                        "Sampling interval in the --profile-sampling option must be greater than zero!");
+            }
+        }
+
+        /* the counters are read by the timers of a profile */
+        if (Global::config().has("profile-counters")) {
+            if (!Global::config().has("profile") || Global::config().has("profile-sampling")) {
+                throw std::invalid_argument(
+                        "Error: Use of profile-counters option requires the profile option and no profile "
+                        "sampling.");
+            }
+        }
     } catch (std::exception& e) {
         std::cerr << e.what() << std::endl;
         exit(1);
@@ -519,6 +857,14 @@ int main(int argc, char** argv) {
         std::cerr << ramTranslationUnit->getErrorReport();
     }
 
+    // report the selected indexes and their estimated costs
+    if (!Global::config().get("debug-report").empty()) {
+        std::stringstream indexAnalysis;
+        ramTranslationUnit->getAnalysis<RamIndexAnalysis>()->print(indexAnalysis);
+        ramTranslationUnit->getDebugReport().addSection(DebugReporter::getCodeSection(
+                "ram-index-analysis", "RAM Index Analysis", indexAnalysis.str()));
+    }
+
     if (!ramTranslationUnit->getProgram()->getMain()) {
         return 0;
     };
@@ -582,6 +928,7 @@ int main(int argc, char** argv) {
         try {
             // Find the base filename for code generation and execution
             std::string baseFilename;
+            bool temporary = false;
             if (Global::config().has("dl-program")) {
                 baseFilename = Global::config().get("dl-program");
             } else if (Global::config().has("generate")) {
@@ -592,18 +939,25 @@ int main(int argc, char** argv) {
                 }
             } else {
                 baseFilename = tempFile();
+                temporary = true;
             }
             if (baseName(baseFilename) == "/" || baseName(baseFilename) == ".") {
                 baseFilename = tempFile();
+                temporary = true;
             }
 
             std::string baseIdentifier = identifier(simpleName(baseFilename));
-            std::string sourceFilename = baseFilename + ".cpp";
+            std::vector<std::string> sourceFilenames;
 
             bool withSharedLibrary;
-            std::ofstream os(sourceFilename);
-            synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
-            os.close();
+            if (Global::config().has("split-units")) {
+                sourceFilenames = synthesiser->generateUnits(baseFilename, baseIdentifier, withSharedLibrary,
+                        std::stoi(Global::config().get("split-units")));
+            } else {
+                sourceFilenames.push_back(baseFilename + ".cpp");
+                std::ofstream os(sourceFilenames.back());
+                synthesiser->generateCode(os, baseIdentifier, withSharedLibrary);
+            }
 
             if (withSharedLibrary) {
                 if (!Global::config().has("libraries")) {
@@ -616,7 +970,14 @@ int main(int argc, char** argv) {
 
             if (Global::config().has("compile")) {
                 auto start = std::chrono::high_resolution_clock::now();
-                compileToBinary(compileCmd, sourceFilename);
+                compileToBinary(compileCmd, sourceFilenames, temporary);
+                // the main unit is removed along with the binary after running it
+                if (Global::config().has("split-units") && !Global::config().has("dl-program")) {
+                    remove((baseFilename + ".h").c_str());
+                    for (size_t i = 1; i < sourceFilenames.size(); i++) {
+                        remove(sourceFilenames[i].c_str());
+                    }
+                }
                 /* Report overall run-time in verbose mode */
                 if (Global::config().has("verbose")) {
                     auto end = std::chrono::high_resolution_clock::now();
@@ -628,7 +989,9 @@ int main(int argc, char** argv) {
                     executeBinary(baseFilename
 #ifdef USE_MPI
                             ,
-                            ((int)astTranslationUnit->getAnalysis<SCCGraph>()->getNumberOfSCCs()) + 1
+                            Global::config().has("data-parallel")
+                                    ? std::stoi(Global::config().get("data-parallel"))
+                                    : (int)astTranslationUnit->getAnalysis<SCCGraph>()->getNumberOfSCCs() + 1
 #endif
                     );
                 }
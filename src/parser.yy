@@ -185,7 +185,7 @@
             <std::string, std::string>>>    non_empty_key_value_pairs
 %type <AstRecordType *>                     non_empty_record_type_list
 %type <AstPragma *>                         pragma
-%type <uint32_t>                            qualifiers
+%type <uint32_t>                            qualifier
 %type <std::vector<AstRelation *>>          relation_decl
 %type <std::vector<AstRelation *>>          relation_list
 %type <std::vector<AstClause *>>            rule
@@ -225,7 +225,7 @@
 %destructor { }                                             non_empty_key_value_pairs
 %destructor { delete $$; }                                  non_empty_record_type_list
 %destructor { delete $$; }                                  pragma
-%destructor { }                                             qualifiers
+%destructor { }                                             qualifier
 %destructor { for (auto* cur : $$) { delete cur; } }        relation_decl
 %destructor { for (auto* cur : $$) { delete cur; } }        relation_list
 %destructor { for (auto* cur : $$) { delete cur; } }        rule
@@ -271,12 +271,19 @@ unit
         $functor_decl = nullptr;
     }
   | unit relation_decl {
+        std::vector<AstRelation*> declared;
         for (auto* cur : $relation_decl) {
-            driver.addRelation(std::unique_ptr<AstRelation>(cur));
+            if (auto* rel = driver.addRelation(std::unique_ptr<AstRelation>(cur))) {
+                declared.push_back(rel);
+            }
         }
+        driver.declareRelations(declared, @relation_decl, true);
 
         $relation_decl.clear();
     }
+  | unit[prev] qualifier {
+        driver.addQualifier($qualifier, @qualifier, @prev);
+    }
   | unit load_head {
         for (auto* cur : $load_head) {
             driver.addLoad(std::unique_ptr<AstLoad>(cur));
@@ -417,19 +424,15 @@ union_type_list
  * Relations
  */
 
-/* Relation declaration */
+/* Relation declaration, the qualifiers following it are read by qualifier */
 relation_decl
-  : DECL relation_list LPAREN RPAREN qualifiers {
-        for (auto* rel : $relation_list) {
-            rel->setQualifier($qualifiers);
-        }
+  : DECL relation_list LPAREN RPAREN {
         $$ = $relation_list;
 
         $relation_list.clear();
     }
-  | DECL relation_list LPAREN non_empty_attributes RPAREN qualifiers {
+  | DECL relation_list LPAREN non_empty_attributes RPAREN {
         for (auto* rel : $relation_list) {
-            rel->setQualifier($qualifiers);
             for (auto* attr : $non_empty_attributes) {
                 rel->addAttribute(std::unique_ptr<AstAttribute>(attr->clone()));
             }
@@ -483,50 +486,46 @@ non_empty_attributes
     }
   ;
 
-/* Relation qualifiers */
-qualifiers
-  : qualifiers OUTPUT_QUALIFIER {
-        if($1 & OUTPUT_RELATION)
-            driver.error(@2, "output qualifier already set");
-        $$ = $1 | OUTPUT_RELATION;
-    }
-  | qualifiers INPUT_QUALIFIER {
-        if($1 & INPUT_RELATION)
-            driver.error(@2, "input qualifier already set");
-        $$ = $1 | INPUT_RELATION;
-    }
-  | qualifiers PRINTSIZE_QUALIFIER {
-        if($1 & PRINTSIZE_RELATION)
-            driver.error(@2, "printsize qualifier already set");
-        $$ = $1 | PRINTSIZE_RELATION;
-    }
-  | qualifiers OVERRIDABLE_QUALIFIER {
-        if($1 & OVERRIDABLE_RELATION)
-            driver.error(@2, "overridable qualifier already set");
-        $$ = $1 | OVERRIDABLE_RELATION;
-    }
-  | qualifiers INLINE_QUALIFIER {
-        if($1 & INLINE_RELATION)
-            driver.error(@2, "inline qualifier already set");
-        $$ = $1 | INLINE_RELATION;
-    }
-  | qualifiers BRIE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
-        $$ = $1 | BRIE_RELATION;
-    }
-  | qualifiers BTREE_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
-        $$ = $1 | BTREE_RELATION;
-    }
-  | qualifiers EQREL_QUALIFIER {
-        if($1 & (BRIE_RELATION|BTREE_RELATION|EQREL_RELATION))
-            driver.error(@2, "btree/brie/eqrel qualifier already set");
-        $$ = $1 | EQREL_RELATION;
+/*
+ * Relation qualifier. The qualifiers of a declaration are read as statements of their
+ * own, so that an identifier following a declaration may be a qualifier as well as the
+ * start of a clause, telling them apart by the next token.
+ */
+qualifier
+  : OUTPUT_QUALIFIER {
+        $$ = OUTPUT_RELATION;
     }
-  | %empty {
-        $$ = 0;
+  | INPUT_QUALIFIER {
+        $$ = INPUT_RELATION;
+    }
+  | PRINTSIZE_QUALIFIER {
+        $$ = PRINTSIZE_RELATION;
+    }
+  | OVERRIDABLE_QUALIFIER {
+        $$ = OVERRIDABLE_RELATION;
+    }
+  | INLINE_QUALIFIER {
+        $$ = INLINE_RELATION;
+    }
+  | BRIE_QUALIFIER {
+        $$ = BRIE_RELATION;
+    }
+  | BTREE_QUALIFIER {
+        $$ = BTREE_RELATION;
+    }
+  | EQREL_QUALIFIER {
+        $$ = EQREL_RELATION;
+    }
+  | IDENT {
+        /* qualifiers that are not keywords, so that they may name relations */
+        if ($IDENT == "bitmap") {
+            $$ = BITMAP_RELATION;
+        } else if ($IDENT == "hash") {
+            $$ = HASH_RELATION;
+        } else {
+            driver.error(@IDENT, "unknown relation qualifier " + $IDENT);
+            $$ = 0;
+        }
     }
   ;
 
@@ -1360,10 +1359,17 @@ component_body
         for (auto* rel : $relation_decl) {
             $$->addRelation(std::unique_ptr<AstRelation>(rel));
         }
+        driver.declareRelations($relation_decl, @relation_decl, false);
 
         $comp = nullptr;
         $relation_decl.clear();
     }
+  | component_body[comp] qualifier {
+        $$ = $comp;
+        driver.addQualifier($qualifier, @qualifier, @comp);
+
+        $comp = nullptr;
+    }
   | component_body[comp] load_head {
         $$ = $comp;
         for (auto* io : $load_head) {
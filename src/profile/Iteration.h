@@ -10,6 +10,7 @@
 
 #include "Rule.h"
 #include <chrono>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -32,6 +33,9 @@ private:
 
     std::unordered_map<std::string, std::shared_ptr<Rule>> rules;
 
+    /** bytes allocated by each index of the relation at the end of the iteration */
+    std::map<std::string, size_t> memory;
+
 public:
     Iteration() : rules() {}
 
@@ -75,6 +79,14 @@ public:
         this->numTuples = numTuples;
     }
 
+    void setMemory(const std::string& index, size_t bytes) {
+        memory[index] = bytes;
+    }
+
+    const std::map<std::string, size_t>& getMemory() const {
+        return memory;
+    }
+
     std::chrono::microseconds getCopytime() const {
         return copytime;
     }
@@ -17,6 +17,7 @@
 #include "Rule.h"
 #include "StringUtils.h"
 #include "Table.h"
+#include <cmath>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -52,6 +53,29 @@ public:
     Table getVersions(std::string strRel, std::string strRul) const;
 
     Table getVersionAtoms(std::string strRel, std::string strRul, int version) const;
+
+private:
+    /** add the hardware counts of a rule to the count columns of a row, starting at the given column */
+    static void addCounts(Row& row, size_t column, const Rule& rule) {
+        if (!rule.hasCounts()) {
+            return;
+        }
+        for (const std::string event : {"cycles", "instructions", "llc-misses"}) {
+            long count = rule.getCount(event);
+            if (row[column] != nullptr) {
+                count += row[column]->getLongVal();
+            }
+            row[column++] = std::make_shared<Cell<long>>(count);
+        }
+    }
+
+    /** set the instructions per cycle from the count columns of a row, starting at the given column */
+    static void setInstructionsPerCycle(Row& row, size_t column) {
+        if (row[column] != nullptr && row[column]->getLongVal() != 0) {
+            const double ipc = static_cast<double>(row[column + 1]->getLongVal()) / row[column]->getLongVal();
+            row[column + 3] = std::make_shared<Cell<double>>(std::round(ipc * 100) / 100);
+        }
+    }
 };
 
 /*
@@ -114,6 +138,10 @@ Table inline OutputProcessor::getRelTable() const {
  * ROW[8] = PERFOR
  * ROW[9] = VER
  * ROW[10]= REL_NAME
+ * ROW[11]= CYCLES
+ * ROW[12]= INSTRUCTIONS
+ * ROW[13]= LLC_MISSES
+ * ROW[14]= IPC
  */
 Table inline OutputProcessor::getRulTable() const {
     const std::unordered_map<std::string, std::shared_ptr<Relation>>& relationMap =
@@ -122,7 +150,7 @@ Table inline OutputProcessor::getRulTable() const {
 
     for (auto& rel : relationMap) {
         for (auto& current : rel.second->getRuleMap()) {
-            Row row(11);
+            Row row(15);
             std::shared_ptr<Rule> rule = current.second;
             row[0] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
             row[1] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
@@ -134,6 +162,7 @@ Table inline OutputProcessor::getRulTable() const {
             row[7] = std::make_shared<Cell<std::string>>(rel.second->getName());
             row[8] = std::make_shared<Cell<long>>(0);
             row[10] = std::make_shared<Cell<std::string>>(rule->getLocator());
+            addCounts(row, 11, *rule);
             ruleMap.emplace(rule->getName(), std::make_shared<Row>(row));
         }
         for (auto& iter : rel.second->getIterations()) {
@@ -146,9 +175,10 @@ Table inline OutputProcessor::getRulTable() const {
                     row[4] = std::make_shared<Cell<long>>(row[4]->getLongVal() + rule->size());
                     row[0] = std::make_shared<Cell<std::chrono::microseconds>>(
                             row[0]->getTimeVal() + rule->getRuntime());
+                    addCounts(row, 11, *rule);
                     ruleMap[rule->getName()] = std::make_shared<Row>(row);
                 } else {
-                    Row row(11);
+                    Row row(15);
                     row[0] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
                     row[1] = std::make_shared<Cell<std::chrono::microseconds>>(std::chrono::microseconds(0));
                     row[2] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
@@ -159,6 +189,7 @@ Table inline OutputProcessor::getRulTable() const {
                     row[7] = std::make_shared<Cell<std::string>>(rel.second->getName());
                     row[8] = std::make_shared<Cell<long>>(rule->getVersion());
                     row[10] = std::make_shared<Cell<std::string>>(rule->getLocator());
+                    addCounts(row, 11, *rule);
                     ruleMap[rule->getName()] = std::make_shared<Row>(row);
                 }
             }
@@ -175,6 +206,7 @@ Table inline OutputProcessor::getRulTable() const {
             } else {
                 t[9] = std::make_shared<Cell<double>>(t[4]->getLongVal() / 1.0);
             }
+            setInstructionsPerCycle(t, 11);
             current.second = std::make_shared<Row>(t);
         }
     }
@@ -265,10 +297,13 @@ Table inline OutputProcessor::getSubrulTable(std::string strRel, std::string str
  * ROW[4] = TUPLES
  * ROW[5] = RUL NAME
  * ROW[6] = ID
- * ROW[7] = SRC
- * ROW[8] = PERFOR
- * ROW[9] = VER
- * ROW[10]= REL_NAME
+ * ROW[7] = REL_NAME
+ * ROW[8] = VER
+ * ROW[9] = SRC
+ * ROW[10]= CYCLES
+ * ROW[11]= INSTRUCTIONS
+ * ROW[12]= LLC_MISSES
+ * ROW[13]= IPC
  */
 Table inline OutputProcessor::getVersions(std::string strRel, std::string strRul) const {
     const std::unordered_map<std::string, std::shared_ptr<Relation>>& relationMap =
@@ -300,9 +335,10 @@ Table inline OutputProcessor::getVersions(std::string strRel, std::string strRul
                             row[2]->getTimeVal() + rule->getRuntime());
                     row[4] = std::make_shared<Cell<long>>(row[4]->getLongVal() + rule->size());
                     row[0] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
+                    addCounts(row, 10, *rule);
                     ruleMap[strTemp] = std::make_shared<Row>(row);
                 } else {
-                    Row row(10);
+                    Row row(14);
                     row[1] = std::make_shared<Cell<std::chrono::microseconds>>(std::chrono::microseconds(0));
                     row[2] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
                     row[3] = std::make_shared<Cell<std::chrono::microseconds>>(std::chrono::microseconds(0));
@@ -313,6 +349,7 @@ Table inline OutputProcessor::getVersions(std::string strRel, std::string strRul
                     row[8] = std::make_shared<Cell<long>>(rule->getVersion());
                     row[9] = std::make_shared<Cell<std::string>>(rule->getLocator());
                     row[0] = std::make_shared<Cell<std::chrono::microseconds>>(rule->getRuntime());
+                    addCounts(row, 10, *rule);
                     ruleMap[strTemp] = std::make_shared<Row>(row);
                 }
             }
@@ -323,6 +360,7 @@ Table inline OutputProcessor::getVersions(std::string strRel, std::string strRul
         Row t = *row.second;
         t[0] = std::make_shared<Cell<std::chrono::microseconds>>(
                 t[1]->getTimeVal() + t[2]->getTimeVal() + t[3]->getTimeVal());
+        setInstructionsPerCycle(t, 10);
         ruleMap[row.first] = std::make_shared<Row>(t);
     }
 
@@ -15,13 +15,18 @@
 #include "Relation.h"
 #include "Rule.h"
 #include "StringUtils.h"
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -87,7 +92,7 @@ private:
 
 /**
  * Visit ProfileDB recursive rule.
- * ruleversion: {DSN}
+ * ruleversion: {DSN, counters: {}}
  */
 class RecursiveRuleVisitor : public DSNVisitor<Rule> {
 public:
@@ -98,6 +103,10 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            for (const auto& key : directory.getKeys()) {
+                base.setCount(key, dynamic_cast<SizeEntry*>(directory.readEntry(key))->getSize());
+            }
         }
     }
 };
@@ -132,7 +141,7 @@ protected:
 
 /**
  * Visit ProfileDB non-recursive rule.
- * rule: {DSN}
+ * rule: {DSN, counters: {}}
  */
 class NonRecursiveRuleVisitor : public DSNVisitor<Rule> {
 public:
@@ -143,6 +152,10 @@ public:
             for (auto& key : directory.getKeys()) {
                 directory.readDirectoryEntry(key)->accept(atomFrequenciesVisitor);
             }
+        } else if (directory.getKey() == "counters") {
+            for (const auto& key : directory.getKeys()) {
+                base.setCount(key, dynamic_cast<SizeEntry*>(directory.readEntry(key))->getSize());
+            }
         }
     }
 };
@@ -194,6 +207,11 @@ public:
             relation.setPreMaxRSS(preMaxRSS->getSize());
             relation.setPostMaxRSS(postMaxRSS->getSize());
         }
+        if (directory.getKey() == "memory") {
+            for (const auto& key : directory.getKeys()) {
+                base.setMemory(key, dynamic_cast<SizeEntry*>(directory.readEntry(key))->getSize());
+            }
+        }
     }
 
 protected:
@@ -239,8 +257,16 @@ public:
     }
     void visit(DirectoryEntry& directory) override {
         if (directory.getKey() == "iteration") {
-            IterationsVisitor iterationsVisitor(base);
+            // visit the iterations in order, rather than in the lexical order of their numbers
+            std::vector<std::string> keys;
             for (const auto& key : directory.getKeys()) {
+                keys.push_back(key);
+            }
+            std::stable_sort(keys.begin(), keys.end(), [](const std::string& a, const std::string& b) {
+                return a.size() < b.size();
+            });
+            IterationsVisitor iterationsVisitor(base);
+            for (const auto& key : keys) {
                 directory.readEntry(key)->accept(iterationsVisitor);
             }
         } else if (directory.getKey() == "non-recursive-rule") {
@@ -253,6 +279,10 @@ public:
             auto* postMaxRSS = dynamic_cast<SizeEntry*>(directory.readEntry("post"));
             base.setPreMaxRSS(preMaxRSS->getSize());
             base.setPostMaxRSS(postMaxRSS->getSize());
+        } else if (directory.getKey() == "memory") {
+            for (const auto& key : directory.getKeys()) {
+                base.setMemory(key, dynamic_cast<SizeEntry*>(directory.readEntry(key))->getSize());
+            }
         }
     }
     void visit(SizeEntry& size) override {
@@ -265,13 +295,134 @@ public:
 };
 }  // namespace
 
+/*
+ * Reader of a binary profile log, adding its entries to a profile database. Each read continues
+ * after the last complete record of the previous one, so that the log of a running program is
+ * followed at the cost of the records appended since.
+ */
+class LogReader {
+private:
+    std::string filename;
+
+    /** offset of the first record not read yet */
+    std::streamoff offset{0};
+
+    /** keys of the log in order of appearance */
+    std::vector<std::string> keys;
+
+    /** read a number, unless it is cut short */
+    static bool readNumber(const std::string& data, size_t& pos, uint64_t& number) {
+        number = 0;
+        for (unsigned shift = 0; pos < data.size() && shift < 64; shift += 7) {
+            const auto byte = static_cast<uint8_t>(data[pos++]);
+            number |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::string& getKey(uint64_t id) const {
+        if (id >= keys.size()) {
+            throw std::runtime_error("Parse error: unknown key in profile log");
+        }
+        return keys[id];
+    }
+
+    /** read the record at the position and move past it, unless it is cut short */
+    bool readRecord(ProfileDatabase& db, const std::string& data, size_t& pos) {
+        const auto kind = static_cast<uint8_t>(data[pos++]);
+        uint64_t length;
+        if (!readNumber(data, pos, length)) {
+            return false;
+        }
+        if (kind == ProfileLog::KEY) {
+            if (data.size() - pos < length) {
+                return false;
+            }
+            keys.push_back(data.substr(pos, length));
+            pos += length;
+            return true;
+        }
+        std::vector<std::string> path;
+        for (uint64_t i = 0; i < length; ++i) {
+            uint64_t id;
+            if (!readNumber(data, pos, id)) {
+                return false;
+            }
+            path.push_back(getKey(id));
+        }
+        uint64_t first;
+        uint64_t second;
+        if (!readNumber(data, pos, first)) {
+            return false;
+        }
+        switch (kind) {
+            case ProfileLog::SIZE:
+                db.addSizeEntry(path, first);
+                break;
+            case ProfileLog::TEXT:
+                db.addTextEntry(path, getKey(first));
+                break;
+            case ProfileLog::DURATION:
+                if (!readNumber(data, pos, second)) {
+                    return false;
+                }
+                db.addDurationEntry(path, microseconds(first), microseconds(second));
+                break;
+            case ProfileLog::TIME:
+                db.addTimeEntry(path, microseconds(first));
+                break;
+            default:
+                throw std::runtime_error("Parse error: unknown record in profile log");
+        }
+        return true;
+    }
+
+public:
+    LogReader(std::string filename) : filename(std::move(filename)) {}
+
+    /** check whether a file is a binary profile log */
+    static bool isLog(const std::string& filename) {
+        const std::string magic(ProfileLog::magic);
+        std::string start(magic.size(), '\0');
+        std::ifstream file(filename, std::ios::binary);
+        file.read(&start[0], start.size());
+        return file && start == magic;
+    }
+
+    /** add the entries of the records appended since the last read to the database */
+    void read(ProfileDatabase& db) {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Log file could not be opened.");
+        }
+        file.seekg(offset);
+        const std::string data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        size_t pos = 0;
+        if (offset == 0) {
+            if (data.compare(0, std::strlen(ProfileLog::magic), ProfileLog::magic) != 0) {
+                throw std::runtime_error("Parse error: not a profile log");
+            }
+            pos = std::strlen(ProfileLog::magic);
+        }
+        // the last record is cut short if the program is still writing it, or was killed doing so
+        size_t next = pos;
+        while (next < data.size() && readRecord(db, data, next)) {
+            pos = next;
+        }
+        offset += pos;
+    }
+};
+
 /*
  * Input reader and processor for log files
  */
 class Reader {
 private:
     std::string file_loc;
-    std::streampos gpos;
+    std::unique_ptr<LogReader> log;
     const ProfileDatabase& db = ProfileEventSingleton::instance().getDB();
     bool loaded = false;
     bool online{true};
@@ -285,7 +436,14 @@ public:
     Reader(std::string filename, std::shared_ptr<ProgramRun> run)
             : file_loc(std::move(filename)), run(std::move(run)) {
         try {
-            ProfileEventSingleton::instance().setDBFromFile(file_loc);
+            if (LogReader::isLog(file_loc)) {
+                log = std::make_unique<LogReader>(file_loc);
+                ProfileEventSingleton::instance().setDB(ProfileDatabase());
+                log->read(ProfileEventSingleton::instance().getDB());
+            } else {
+                // logs written before the binary format
+                ProfileEventSingleton::instance().setDBFromFile(file_loc);
+            }
         } catch (const std::exception& e) {
             std::cerr << e.what() << std::endl;
             exit(1);
@@ -297,6 +455,9 @@ public:
      * Read the contents from file into the class
      */
     void processFile() {
+        if (log != nullptr) {
+            log->read(ProfileEventSingleton::instance().getDB());
+        }
         rel_id = 0;
         relationMap.clear();
         auto programDuration = dynamic_cast<DurationEntry*>(db.lookupEntry({"program", "runtime"}));
@@ -11,6 +11,7 @@
 #include "Iteration.h"
 #include "Rule.h"
 #include <chrono>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -44,6 +45,9 @@ private:
 
     std::unordered_map<std::string, std::shared_ptr<Rule>> ruleMap;
 
+    /** bytes allocated by each index of the relation after its non-recursive evaluation */
+    std::map<std::string, size_t> memory;
+
     bool ready = true;
 
 public:
@@ -115,6 +119,14 @@ public:
         return postMaxRSS - preMaxRSS;
     }
 
+    void setMemory(const std::string& index, size_t bytes) {
+        memory[index] = bytes;
+    }
+
+    const std::map<std::string, size_t>& getMemory() const {
+        return memory;
+    }
+
     size_t getTotalRecursiveRuleSize() const {
         size_t result = 0;
         for (auto& iter : iterations) {
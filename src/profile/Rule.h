@@ -9,6 +9,7 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
@@ -53,6 +54,7 @@ protected:
     std::string identifier;
     std::string locator{};
     std::set<Atom> atoms;
+    std::map<std::string, long> counts;
 
 private:
     bool recursive = false;
@@ -103,6 +105,20 @@ public:
     const std::set<Atom>& getAtoms() const {
         return atoms;
     }
+
+    /** get the hardware count of an event, e.g. of the cycles spent on the rule */
+    long getCount(const std::string& event) const {
+        auto it = counts.find(event);
+        return it == counts.end() ? 0 : it->second;
+    }
+
+    void setCount(const std::string& event, long count) {
+        counts[event] = count;
+    }
+
+    bool hasCounts() const {
+        return !counts.empty();
+    }
     std::string getName() const {
         return name;
     }
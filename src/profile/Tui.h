@@ -18,7 +18,9 @@
 #include <chrono>
 #include <cstdio>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -76,7 +78,9 @@ public:
 
         this->alive = false;
         updateDB();
-        this->loaded = reader->isLoaded();
+        // follow the log of a program still running, reading the records it appends on each command
+        this->alive = live && reader->isLive();
+        this->loaded = reader->isLoaded() || this->alive;
     }
 
     Tui() {
@@ -246,9 +250,17 @@ public:
         ss << R"_({"top":[)_" << (endTime - beginTime).count() / 1000000.0 << "," << run->getTotalSize()
            << "," << run->getTotalLoadtime().count() / 1000000.0 << ","
            << run->getTotalSavetime().count() / 1000000.0 << "]";
+        ss << R"_(, "counters": )_" << (hasCounts() ? "true" : "false");
         return ss;
     }
 
+    /** write the hardware count columns of a row, starting at the given column, to a json array */
+    void genJsonCounts(std::stringstream& ss, Row& row, size_t column) {
+        for (size_t i = column; i < column + 4; ++i) {
+            ss << ", " << (row[i] == nullptr ? "null" : row[i]->toString(-1));
+        }
+    }
+
     std::stringstream& genJsonRelations(std::stringstream& ss, const std::string& name, size_t maxRows) {
         const std::shared_ptr<ProgramRun>& run = out.getProgramRun();
 
@@ -312,7 +324,36 @@ public:
                 comma(firstCol);
                 ss << i->size();
             }
-            ss << "]}]";
+            ss << R"_(], "memory": {)_";
+            // the bytes of each index at the end of each iteration, or after a non-recursive evaluation
+            std::vector<std::map<std::string, size_t>> memory;
+            for (auto& i : iter) {
+                if (!i->getMemory().empty()) {
+                    memory.push_back(i->getMemory());
+                }
+            }
+            if (memory.empty()) {
+                memory.push_back(run->getRelation(row[5]->toString(0))->getMemory());
+            }
+            std::set<std::string> indexes;
+            for (auto& m : memory) {
+                for (auto& cur : m) {
+                    indexes.insert(cur.first);
+                }
+            }
+            bool firstIndex = true;
+            for (auto& index : indexes) {
+                comma(firstIndex);
+                ss << '"' << Tools::cleanJsonOut(index) << R"_(": [)_";
+                firstCol = true;
+                for (auto& m : memory) {
+                    comma(firstCol);
+                    auto it = m.find(index);
+                    ss << (it == m.end() ? 0 : it->second);
+                }
+                ss << ']';
+            }
+            ss << "}}]";
         }
         ss << "}";
 
@@ -385,13 +426,15 @@ public:
                 ss << ver_row[4]->getLongVal() << ", ";
                 ss << '"' << src << R"_(", )_";
                 ss << ver_row[8]->getLongVal();
+                // the counts are at VER_COUNTS of the html script
+                genJsonCounts(ss, ver_row, 10);
                 ss << ']';
             }
 
             ss << "], ";
 
             if (row[6]->toString(0).at(0) != 'C') {
-                ss << "{}, {}]";
+                ss << "{}, {}";
             } else {
                 ss << R"_({"tot_t": [)_";
 
@@ -441,8 +484,11 @@ public:
                     }
                     ss << ']';
                 }
-                ss << "}]";
+                ss << "}";
             }
+            // the counts are at RUL_COUNTS of the html script
+            genJsonCounts(ss, row, 11);
+            ss << "]";
         }
         ss << "\n}";
         return ss;
@@ -1088,9 +1134,13 @@ public:
 
     void rul(size_t limit, bool showLimit = true) {
         ruleTable.sort(sortColumn);
+        const bool counts = hasCounts();
         std::cout << "  ----- Rule Table -----\n";
-        std::printf(
-                "%8s%8s%8s%8s%8s%8s %s\n\n", "TOT_T", "NREC_T", "REC_T", "TUPLES", "TUP/s", "ID", "RELATION");
+        std::printf("%8s%8s%8s%8s%8s", "TOT_T", "NREC_T", "REC_T", "TUPLES", "TUP/s");
+        if (counts) {
+            std::printf("%8s%8s%8s%8s", "CYCLES", "INSTR", "IPC", "LLC_M");
+        }
+        std::printf("%8s %s\n\n", "ID", "RELATION");
         size_t count = 0;
         for (auto& row : Tools::formatTable(ruleTable, precision)) {
             if (++count > limit) {
@@ -1099,9 +1149,24 @@ public:
                 }
                 break;
             }
-            std::printf("%8s%8s%8s%8s%8s%8s %s\n", row[0].c_str(), row[1].c_str(), row[2].c_str(),
-                    row[4].c_str(), row[9].c_str(), row[6].c_str(), row[7].c_str());
+            std::printf("%8s%8s%8s%8s%8s", row[0].c_str(), row[1].c_str(), row[2].c_str(), row[4].c_str(),
+                    row[9].c_str());
+            if (counts) {
+                std::printf(
+                        "%8s%8s%8s%8s", row[11].c_str(), row[12].c_str(), row[14].c_str(), row[13].c_str());
+            }
+            std::printf("%8s %s\n", row[6].c_str(), row[7].c_str());
+        }
+    }
+
+    /** check whether the profile has hardware counts of the rules */
+    bool hasCounts() {
+        for (auto& row : ruleTable.getRows()) {
+            if ((*row)[11] != nullptr) {
+                return true;
+            }
         }
+        return false;
     }
 
     void id(std::string col) {
@@ -1203,21 +1268,38 @@ public:
         }
 
         // Print out the versions of this rule.
+        const bool counts = hasCounts();
         std::cout << "  ----- Rule Versions Table -----\n";
-        std::printf("%8s%8s%8s%16s%6s\n\n", "TOT_T", "NREC_T", "REC_T", "TUPLES", "VER");
+        std::printf("%8s%8s%8s%16s%6s", "TOT_T", "NREC_T", "REC_T", "TUPLES", "VER");
+        if (counts) {
+            std::printf("%8s%8s%8s%8s", "CYCLES", "INSTR", "IPC", "LLC_M");
+        }
+        std::printf("\n\n");
         for (auto& row : formattedRuleTable) {
             if (row[6].compare(str) == 0) {
-                std::printf("%8s%8s%8s%16s%6s\n", row[0].c_str(), row[1].c_str(), row[2].c_str(),
+                std::printf("%8s%8s%8s%16s%6s", row[0].c_str(), row[1].c_str(), row[2].c_str(),
                         row[4].c_str(), "");
+                if (counts) {
+                    std::printf("%8s%8s%8s%8s", row[11].c_str(), row[12].c_str(), row[14].c_str(),
+                            row[13].c_str());
+                }
+                std::printf("\n");
             }
         }
         std::cout << "   ---------------------------------------------\n";
         for (auto& _row : versionTable.rows) {
             Row row = *_row;
 
-            std::printf("%8s%8s%8s%16s%6s\n", row[0]->toString(precision).c_str(),
+            std::printf("%8s%8s%8s%16s%6s", row[0]->toString(precision).c_str(),
                     row[1]->toString(precision).c_str(), row[2]->toString(precision).c_str(),
                     row[4]->toString(precision).c_str(), row[8]->toString(precision).c_str());
+            if (counts) {
+                for (size_t column : {10, 11, 13, 12}) {
+                    const std::string count = row[column] == nullptr ? "-" : row[column]->toString(precision);
+                    std::printf("%8s", count.c_str());
+                }
+            }
+            std::printf("\n");
             Table atom_table = out.getVersionAtoms(strRel, srcLocator, row[8]->getLongVal());
             verAtoms(atom_table);
         }
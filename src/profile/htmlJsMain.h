@@ -60,6 +60,16 @@ function graphRel() {
             data.rel[selected.rel][9].tuples[j]
         )
     }
+    graph_vals.memory = [];
+    var memory = data.rel[selected.rel][9].memory;
+    for (var index in memory) {
+        graph_vals.memory.push(memory[index].map(function (bytes) {
+            return {meta: index, value: bytes};
+        }));
+        for (j = graph_vals.labels.length; j < memory[index].length; j++) {
+            graph_vals.labels.push(j.toString());
+        }
+    }
 
     document.getElementById('chart_tab').click();
     drawGraph();
@@ -85,6 +95,7 @@ function graphIterRul() {
             data.rul[selected.rul][9].tuples[j]
         )
     }
+    graph_vals.memory = [];
 
     document.getElementById('chart_tab').click();
     drawGraph();
@@ -182,6 +193,20 @@ function drawGraph() {
         labels: graph_vals.labels,
         series: [graph_vals.tuples],
     }, options)
+
+    options.axisY = {
+        labelInterpolationFnc: function (value) {
+            return minify_memory(value);
+        }
+    };
+    options.stackBars = true;
+    options.plugins = [Chartist.plugins.tooltip({tooltipFnc: function (meta, value) {
+                return meta + '<br/>' + minify_memory(value);}})]
+
+    new Chartist.Bar(".ct-chart3", {
+        labels: graph_vals.labels,
+        series: graph_vals.memory,
+    }, options)
 }
 
 
@@ -258,6 +283,18 @@ function create_cell(type, value, perc_total) {
         cell.innerHTML = minify_numbers(value);
         cell.setAttribute('data-sort', value);
         cell.className = "int_cell";
+    } else if (type === "count") {
+        // a hardware count or the instructions per cycle, missing if the counters were not available
+        if (value === null || value === undefined) {
+            cell.innerHTML = "-";
+            value = 0;
+        } else if (Number.isInteger(value)) {
+            cell.innerHTML = minify_numbers(value);
+            cell.className = "int_cell";
+        } else {
+            cell.innerHTML = value.toFixed(2);
+        }
+        cell.setAttribute('data-sort', value);
     } else if (type === "perc") {
         div = document.createElement("div");
         div.className = "perc_time";
@@ -339,9 +376,19 @@ function gen_rel_table() {
     "rel");
 }
 
+/* first column of the hardware counts in the json array of a rule and of a rule version */
+var RUL_COUNTS = 10;
+var VER_COUNTS = 8;
+
+/* columns of the cycles, instructions, instructions per cycle and llc misses of a rule, if counted */
+function counter_format(column) {
+    if (!data.counters) return [];
+    return [["count",column],["count",column + 1],["count",column + 3],["count",column + 2]];
+}
+
 function gen_rul_table() {
     generate_table([["text",0],["id",1],["time",2],["time",3],["time",4],
-            ["int",5],["perc","float",2],["perc","int",5],["code_loc",6]],
+            ["int",5],["perc","float",2],["perc","int",5]].concat(counter_format(RUL_COUNTS), [["code_loc",6]]),
         "Rul_table_body",
         "rul");
 }
@@ -355,7 +402,7 @@ function gen_top_rel_table() {
 
 function gen_top_rul_table() {
     generate_table([["text",0],["id",1],["time",2],["time",3],["time",4],
-            ["int",5],["perc","float",2],["perc","int",5],["code_loc",6]],
+            ["int",5],["perc","float",2],["perc","int",5]].concat(counter_format(RUL_COUNTS), [["code_loc",6]]),
         "top_rul_table_body",
         "topRul");
 }
@@ -363,7 +410,7 @@ function gen_top_rul_table() {
 
 function genRulesOfRelations() {
     var data_format = [["text",0],["id",1],["time",2],["time",3],["time",4],
-            ["int",5],["perc","float",2],["perc","int",5],["code_loc",6]];
+            ["int",5],["perc","float",2],["perc","int",5]].concat(counter_format(RUL_COUNTS), [["code_loc",6]]);
     var rules = data.rel[selected.rel][9];
     var perc_totals = [];
     var row, cell, perc_counter, table_body, i, j;
@@ -407,7 +454,7 @@ function genRulesOfRelations() {
 
 function genRulVer() {
     var data_format = [["text",0],["id",1],["time",2],["time",3],["time",4],
-        ["int",5],["int",7],["perc","float",2],["perc","int",5],["code_loc",6]];
+        ["int",5],["int",7],["perc","float",2],["perc","int",5]].concat(counter_format(VER_COUNTS), [["code_loc",6]]);
     var rules = data.rul[selected.rul][7];
     var perc_totals = [];
     var row, cell, perc_counter, table_body, i, j;
@@ -430,6 +477,9 @@ function genRulVer() {
             cell = create_cell("text","-")
         } else if (data_format[i][0] === "perc") {
             cell = create_cell(data_format[i][0], 1, 1);
+        } else if (data_format[i][0] === "count") {
+            // the counts of a rule follow its versions and iterations, unlike the counts of a version
+            cell = create_cell(data_format[i][0], data.rul[selected.rul][data_format[i][1] + RUL_COUNTS - VER_COUNTS]);
         } else {
             cell = create_cell(data_format[i][0], data.rul[selected.rul][data_format[i][1]]);
         }
@@ -576,11 +626,18 @@ var came_from = !1;
 var graph_vals = {
     labels:[],
     tot_t:[],
-    tuples:[]
+    tuples:[],
+    memory:[]
 };
 
 
 function init() {
+    if (!data.counters) {
+        var columns = document.getElementsByClassName("counter_col");
+        for (var i = 0; i < columns.length; i++) {
+            columns[i].style.display = "none";
+        }
+    }
     gen_top();
     gen_rel_table();
     gen_rul_table();
@@ -91,6 +91,10 @@ std::string htmlBodyTop = R"___(
                     <th data-sort-method="number">Tuples</th>
                     <th data-sort-method="number">% of Time</th>
                     <th data-sort-method="number">% of Tuples</th>
+                    <th class="counter_col" data-sort-method="number">Cycles</th>
+                    <th class="counter_col" data-sort-method="number">Instructions</th>
+                    <th class="counter_col" data-sort-method="number">IPC</th>
+                    <th class="counter_col" data-sort-method="number">LLC Misses</th>
                     <th data-sort-method="text">Source</th>
                 </tr>
                 </thead>
@@ -146,6 +150,10 @@ std::string htmlBodyTop = R"___(
                     <th data-sort-method="number">Tuples</th>
                     <th data-sort-method="number">% of Time</th>
                     <th data-sort-method="number">% of Tuples</th>
+                    <th class="counter_col" data-sort-method="number">Cycles</th>
+                    <th class="counter_col" data-sort-method="number">Instructions</th>
+                    <th class="counter_col" data-sort-method="number">IPC</th>
+                    <th class="counter_col" data-sort-method="number">LLC Misses</th>
                     <th data-sort-method="text" style="width:20%;">Source</th>
                 </tr>
                 </thead>
@@ -172,6 +180,10 @@ std::string htmlBodyTop = R"___(
                 <th data-sort-method="number">Tuples</th>
                 <th data-sort-method="number">% of Time</th>
                 <th data-sort-method="number">% of Tuples</th>
+                <th class="counter_col" data-sort-method="number">Cycles</th>
+                <th class="counter_col" data-sort-method="number">Instructions</th>
+                <th class="counter_col" data-sort-method="number">IPC</th>
+                <th class="counter_col" data-sort-method="number">LLC Misses</th>
                 <th data-sort-method="text">Source</th>
             </tr>
             </thead>
@@ -195,6 +207,10 @@ std::string htmlBodyTop = R"___(
                     <th data-sort-method="number">Ver</th>
                     <th data-sort-method="number">% of Time</th>
                     <th data-sort-method="number">% of Tuples</th>
+                    <th class="counter_col" data-sort-method="number">Cycles</th>
+                    <th class="counter_col" data-sort-method="number">Instructions</th>
+                    <th class="counter_col" data-sort-method="number">IPC</th>
+                    <th class="counter_col" data-sort-method="number">LLC Misses</th>
                     <th data-sort-method="text">Source</th>
                 </tr>
                 </thead>
@@ -227,8 +243,8 @@ std::string htmlBodyTop = R"___(
     <div class="ct-chart1"></div>
     <h1>Total number of tuples</h1>
     <div class="ct-chart2"></div>
-    <!--<h1>Copy time</h1>-->
-    <!--<div class="ct-chart3"></div>-->
+    <h1>Memory per index</h1>
+    <div class="ct-chart3"></div>
     <!--<button onclick="show_graph_vals=!show_graph_vals;draw_graph();">Toggle values</button>-->
 </div>
 <div id="Code" class="tabcontent">
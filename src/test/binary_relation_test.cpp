@@ -17,6 +17,7 @@
 #include "test.h"
 
 #include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <iostream>
 #include <set>
@@ -368,6 +369,42 @@ TEST(EqRelTest, IterBasic) {
     EXPECT_EQ(count, br.size());
 }
 
+TEST(EqRelTest, IterInterleaved) {
+    // interleave inserts with lookups, as a recursive stratum would
+    const int N = 1000;
+    EqRel br;
+    for (int i = 0; i < N; ++i) {
+        br.insert(i, i);
+        // join every node with its predecessor modulo 10
+        if (i >= 10) br.insert(i, i - 10);
+        if (i % 100 == 99) {
+            // scan a disjoint set and the whole relation
+            size_t count = 0;
+            for (auto x : br.getBoundaries<1>({{i, 0}})) {
+                EXPECT_EQ(i % 10, x[1] % 10);
+                ++count;
+            }
+            EXPECT_EQ((size_t)(i / 10 + 1), count);
+
+            count = 0;
+            for (auto x : br) {
+                ++count;
+                testutil::ignore(x);
+            }
+            EXPECT_EQ(count, br.size());
+            EXPECT_EQ((size_t)(10 * (i / 10 + 1) * (i / 10 + 1)), br.size());
+        }
+    }
+
+    // merge all disjoint sets into one
+    for (int i = 1; i < 10; ++i) {
+        br.insert(0, i);
+        EXPECT_EQ((size_t)((i + 1) * 100 * (i + 1) * 100 + (9 - i) * 100 * 100), br.size());
+    }
+    EXPECT_EQ((size_t)(N * N), br.size());
+    EXPECT_TRUE(br.contains(999, 0));
+}
+
 TEST(EqRelTest, IterRange) {
     // write some tests to use that templated range for different indexes too
     EqRel br;
@@ -523,6 +560,56 @@ TEST(EqRelTest, Scaling) {
     EXPECT_EQ(N, br.size());
 }
 
+TEST(EqRelTest, ConcurrentReads) {
+    // inserters join the values of each group into one disjoint set, while a reader
+    // keeps bringing the cache up to date and looking up classes
+    const int N = 4000;
+    const int G = 8;
+    const int T = 4;
+    EqRel br;
+    br.insert(0, 0);
+
+    std::atomic<bool> done(false);
+    bool monotone = true;
+    bool found = true;
+    std::thread reader([&]() {
+        size_t last = 0;
+        while (!done.load()) {
+            const size_t size = br.size();
+            monotone = monotone && last <= size;
+            last = size;
+            auto range = br.getBoundaries<1>({{0, 0}});
+            found = found && range.begin() != range.end() && (*range.begin())[0] == 0;
+            found = found && br.begin() != br.end();
+        }
+    });
+
+    std::vector<std::thread> inserters;
+    for (int t = 0; t < T; ++t) {
+        inserters.emplace_back([&, t]() {
+            for (int i = t; i < N; i += T) {
+                br.insert(i, i < G ? i : i - G);
+            }
+        });
+    }
+    for (auto& inserter : inserters) {
+        inserter.join();
+    }
+    done.store(true);
+    reader.join();
+
+    EXPECT_TRUE(monotone);
+    EXPECT_TRUE(found);
+    const size_t perGroup = N / G;
+    EXPECT_EQ(G * perGroup * perGroup, br.size());
+    size_t count = 0;
+    for (auto x : br) {
+        ++count;
+        testutil::ignore(x);
+    }
+    EXPECT_EQ(count, br.size());
+}
+
 #ifdef _OPENMP
 TEST(EqRelTest, ParallelScaling) {
     // use OpenMP this time
@@ -14,6 +14,7 @@
  *
  ***********************************************************************/
 
+#include "BTree.h"
 #include "Brie.h"
 #include "test.h"
 #include <cstring>
@@ -1147,6 +1148,48 @@ TEST(Trie, Merge_Stress) {
     }
 }
 
+TEST(Trie, Merge_Parallel) {
+    using entry_t = typename Trie<2>::entry_type;
+
+    const int N = 100000;
+
+    // spread the first component over multiple top-level branches
+    std::set<entry_t> ref;
+    Trie<2> a;
+    Trie<2> b;
+    for (int i = 0; i < N; i++) {
+        RamDomain x = rand() % (N / 10);
+        RamDomain y = rand() % N;
+        if (i % 2) {
+            a.insert(x, y);
+        } else {
+            b.insert(x, y);
+        }
+        ref.insert(entry_t({{x, y}}));
+    }
+
+    // merge into an empty trie
+    Trie<2> c;
+    c.insertAll(b);
+    EXPECT_EQ(b.size(), c.size());
+    EXPECT_EQ(std::set<entry_t>(b.begin(), b.end()), std::set<entry_t>(c.begin(), c.end()));
+
+    // merge into a non-empty trie
+    c.insertAll(a);
+    EXPECT_EQ(ref.size(), c.size());
+    EXPECT_EQ(ref, std::set<entry_t>(c.begin(), c.end()));
+
+    // merge a trie exhibiting a single top-level branch
+    Trie<2> d;
+    d.insert(N + 1, 1);
+    d.insert(N + 2, 2);
+    c.insertAll(d);
+    EXPECT_EQ(ref.size() + 2, c.size());
+    EXPECT_TRUE(c.contains(N + 1, 1));
+    EXPECT_TRUE(c.contains(N + 2, 2));
+    EXPECT_EQ(*ref.begin(), *c.begin());
+}
+
 TEST(Trie, Merge_Bug) {
     // having this set ...
     Trie<2> a;
@@ -1310,3 +1353,45 @@ TEST(Trie, Parallel) {
         EXPECT_EQ(should, is);
     }
 }
+
+#ifdef _OPENMP
+
+TEST(Trie, ParallelMergeScaling) {
+    using entry_t = typename Trie<2>::entry_type;
+    using btree_t = btree_set<entry_t>;
+
+    //    const int N = 10000000;     // real benchmark
+    const int N = 100000;  // to not run to long for unit testing
+
+    // create some random data
+    Trie<2> trieSrc;
+    btree_t btreeSrc;
+    for (int i = 0; i < N; i++) {
+        entry_t entry({{(RamDomain)(random() % N), (RamDomain)(random() % N)}});
+        trieSrc.insert(entry);
+        btreeSrc.insert(entry);
+    }
+
+    for (int i = 1; i <= 8; i *= 2) {
+        omp_set_num_threads(i);
+
+        Trie<2> trie;
+        double start = omp_get_wtime();
+        trie.insertAll(trieSrc);
+        double end = omp_get_wtime();
+
+        btree_t btree;
+        double bstart = omp_get_wtime();
+        btree.insertAll(btreeSrc);
+        double bend = omp_get_wtime();
+
+        std::cout << "Number of threads: " << i << " trie [" << (end - start) << "s] btree ["
+                  << (bend - bstart) << "s]\n";
+
+        EXPECT_EQ(trieSrc.size(), trie.size());
+        EXPECT_EQ(btreeSrc.size(), btree.size());
+        EXPECT_EQ(trie.size(), btree.size());
+    }
+}
+
+#endif
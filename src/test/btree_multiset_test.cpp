@@ -164,6 +164,23 @@ TEST(BTreeMultiSet, Duplicates) {
     }
 }
 
+TEST(BTreeMultiSet, CountDuplicates) {
+    using test_set = btree_counted_multiset<int>;
+    test_set t;
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j <= i; j++) {
+            t.insert(i);
+        }
+    }
+    t.freeze();
+    EXPECT_TRUE(t.hasOrderStatistics());
+    for (size_t i = 0; i < 100; i++) {
+        const int x = i;
+        EXPECT_EQ(i + 1, t.count(t.lower_bound(x), t.upper_bound(x)));
+        EXPECT_EQ(x, *t.nth(i * (i + 1) / 2));
+    }
+}
+
 TEST(BTreeMultiSet, Incremental) {
     using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
     test_set t;
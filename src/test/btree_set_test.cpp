@@ -23,6 +23,7 @@
 #include <iomanip>
 #include <iostream>
 #include <set>
+#include <stdexcept>
 #include <tuple>
 #include <unordered_set>
 #include <vector>
@@ -493,6 +494,60 @@ TEST(BTreeSet, Clear) {
     EXPECT_TRUE(t.empty());
 }
 
+TEST(BTreeSet, Freeze) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    const int N = 1000;
+
+    test_set t;
+    for (int i = 0; i < N; i++) {
+        t.insert(i);
+    }
+
+    EXPECT_FALSE(t.isFrozen());
+    t.freeze();
+    EXPECT_TRUE(t.isFrozen());
+
+    // lookups and iteration are unaffected
+    EXPECT_EQ(N, t.size());
+    EXPECT_TRUE(t.contains(N / 2));
+    EXPECT_FALSE(t.contains(N));
+    int last = -1;
+    for (int c : t) {
+        EXPECT_EQ(last + 1, c);
+        last = c;
+    }
+    EXPECT_EQ(N - 1, last);
+
+    // writes require the tree to be unfrozen
+    bool rejected = false;
+    try {
+        t.insert(N);
+    } catch (const std::logic_error&) {
+        rejected = true;
+    }
+    EXPECT_TRUE(rejected);
+    EXPECT_EQ(N, t.size());
+    t.unfreeze();
+    EXPECT_FALSE(t.isFrozen());
+    t.insert(N);
+    EXPECT_EQ(N + 1, t.size());
+
+    // frozen state is swapped along with the content
+    test_set other;
+    t.freeze();
+    other.swap(t);
+    EXPECT_TRUE(other.isFrozen());
+    EXPECT_FALSE(t.isFrozen());
+    EXPECT_EQ(N + 1, other.size());
+    EXPECT_EQ(0, t.size());
+
+    // clearing a tree resets the frozen state
+    other.clear();
+    EXPECT_FALSE(other.isFrozen());
+    EXPECT_EQ(0, other.size());
+}
+
 TEST(BTreeSet, ChunkSplit) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -563,6 +618,63 @@ TEST(BTreeSet, ChunkSplitStress) {
     }
 }
 
+TEST(BTreeSet, OrderStatistics) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 64,
+            detail::default_strategy<int>::type, detail::comparator<int>, detail::updater<int>, true>;
+
+    for (size_t n : {0, 1, 10, 1000, 5000}) {
+        std::vector<int> data;
+        for (size_t i = 0; i < n; i++) {
+            data.push_back(2 * i);
+        }
+        random_shuffle(data.begin(), data.end());
+
+        test_set t;
+        for (int x : data) t.insert(x);
+
+        // results are the same before and after freezing
+        for (bool frozen : {false, true}) {
+            if (frozen) {
+                t.freeze();
+            }
+            EXPECT_EQ(frozen, t.hasOrderStatistics());
+
+            EXPECT_EQ(n, t.count(t.begin(), t.end()));
+            for (size_t i = 0; i < n; i += 7) {
+                const int x = 2 * i;
+                EXPECT_EQ(x, *t.nth(i));
+                EXPECT_EQ(i, t.count(t.begin(), t.lower_bound(x)));
+                EXPECT_EQ(n - i, t.count(t.lower_bound(x), t.end()));
+                EXPECT_EQ(i / 2, t.count(t.lower_bound(x / 2), t.upper_bound(x - 1)));
+            }
+            EXPECT_TRUE(t.nth(n) == t.end());
+        }
+
+        // chunks of a frozen tree are of equal size
+        for (size_t j = 1; j < 50; j += 3) {
+            auto chunks = t.getChunks(j);
+            int last = -2;
+            for (const auto& cur : chunks) {
+                if (n >= j) {
+                    EXPECT_LT(n / j - 1, t.count(cur.begin(), cur.end()));
+                    EXPECT_LT(t.count(cur.begin(), cur.end()), n / j + 2);
+                }
+                for (int x : cur) {
+                    EXPECT_EQ(last + 2, x);
+                    last = x;
+                }
+            }
+            EXPECT_EQ(2 * (int)n - 2, last);
+        }
+
+        // inserting requires unfreezing, which falls back to iterating
+        t.unfreeze();
+        t.insert(-1);
+        EXPECT_FALSE(t.hasOrderStatistics());
+        EXPECT_EQ(n + 1, t.count(t.begin(), t.end()));
+    }
+}
+
 using Entry = std::tuple<int, int>;
 
 std::vector<Entry> getData(unsigned numEntries) {
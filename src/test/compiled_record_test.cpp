@@ -0,0 +1,115 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file compiled_record_test.cpp
+ *
+ * Test cases for the records of the compiled execution.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "CompiledRecord.h"
+#include "CompiledTuple.h"
+#include "RamTypes.h"
+
+#include <iostream>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+using t_pair = ram::Tuple<RamDomain, 2>;
+
+TEST(CompiledRecord, PackUnpack) {
+    RamDomain a = pack<t_pair>({{1, 2}});
+    RamDomain b = pack<t_pair>({{2, 1}});
+    EXPECT_FALSE(isNull<t_pair>(a));
+    EXPECT_FALSE(isNull<t_pair>(b));
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a, pack<t_pair>({{1, 2}}));
+
+    EXPECT_EQ(t_pair({{1, 2}}), unpack<t_pair>(a));
+    EXPECT_EQ(t_pair({{2, 1}}), unpack<t_pair>(b));
+}
+
+TEST(CompiledRecord, ManyBlocks) {
+    using t_wide = ram::Tuple<RamDomain, 16>;
+    detail::RecordMap<t_wide> map;
+
+    // covers several blocks, the first holding 1024 tuples of this size
+    const int N = 100000;
+    std::vector<RamDomain> refs;
+    for (int i = 0; i < N; i++) {
+        t_wide cur = {};
+        cur[i % 16] = i;
+        refs.push_back(map.pack(cur));
+    }
+    EXPECT_EQ(N, map.size());
+
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(i + 1, refs[i]);
+        EXPECT_EQ(i, map.unpack(refs[i])[i % 16]);
+    }
+}
+
+TEST(CompiledRecord, ParallelPack) {
+    const int N = 10000;
+    detail::RecordMap<t_pair> map;
+
+    // every record is packed by two threads, both obtain the same reference
+    std::vector<RamDomain> refs(2 * N);
+#pragma omp parallel for
+    for (int i = 0; i < 2 * N; i++) {
+        refs[i] = map.pack({{i % N, 0}});
+        EXPECT_EQ(i % N, map.unpack(refs[i])[0]);
+    }
+    EXPECT_EQ(N, map.size());
+
+    std::vector<bool> seen(N + 1, false);
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(refs[i], refs[i + N]);
+        ASSERT_TRUE(0 < refs[i] && refs[i] <= N);
+        EXPECT_FALSE(seen[refs[i]]);
+        seen[refs[i]] = true;
+    }
+}
+
+#ifdef _OPENMP
+
+TEST(CompiledRecord, ParallelScaling) {
+    //        const int N = 10000000;     // real benchmark
+    const int N = 100000;  // to not run to long for unit testing
+
+    for (int i = 1; i <= 8; i++) {
+        detail::RecordMap<t_pair> map;
+
+        omp_set_num_threads(i);
+
+        double start = omp_get_wtime();
+
+        // create all records, then look them up again as rules deriving known records do
+#pragma omp parallel for
+        for (int j = 0; j < 2 * N; j++) {
+            map.pack({{j % N, (j % N) % 7}});
+        }
+
+        double end = omp_get_wtime();
+
+        std::cout << "Number of threads: " << i << "[" << (end - start) << "s]\n";
+
+        EXPECT_EQ(N, map.size());
+    }
+}
+
+#endif
+}  // namespace test
+}  // end namespace souffle
@@ -390,6 +390,28 @@ TEST(SparseDjTest, TestUnion) {
     EXPECT_EQ(sds.size(), 3);
 }
 
+TEST(SparseDjTest, UnionAll) {
+    // union a batch of pairs forming a few chains
+    souffle::SparseDisjointSet<size_t> sds;
+    constexpr size_t N = 10000;
+    constexpr size_t K = 4;
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = K; i < N; ++i) {
+        pairs.emplace_back((i - K) * 50, i * 50);
+    }
+    std::random_shuffle(pairs.begin(), pairs.end());
+    sds.unionAll(pairs);
+
+    EXPECT_EQ(sds.size(), N);
+    for (size_t i = K; i < N; ++i) {
+        EXPECT_TRUE(sds.contains(i * 50, (i % K) * 50));
+    }
+    for (size_t i = 1; i < K; ++i) {
+        EXPECT_FALSE(sds.contains(0, i * 50));
+    }
+}
+
 TEST(SparseDjTest, SignedData) {
     // test when the sparse dj set stores different signed-ness to the internally stored data
     souffle::SparseDisjointSet<ssize_t> sds;
@@ -0,0 +1,103 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hash_index_test.cpp
+ *
+ * Test cases for the hash indices of relations.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "CompiledTuple.h"
+#include "HashIndex.h"
+#include "ParallelUtils.h"
+#include "RamTypes.h"
+
+#include <atomic>
+#include <set>
+
+namespace souffle {
+
+namespace test {
+
+using t_tuple = ram::Tuple<RamDomain, 2>;
+
+TEST(HashIndex, Set) {
+    HashIndex<t_tuple, 0, 1> set;
+    EXPECT_TRUE(set.empty());
+
+    EXPECT_TRUE(set.insert({{1, 2}}));
+    EXPECT_TRUE(set.insert({{2, 1}}));
+    EXPECT_FALSE(set.insert({{1, 2}}));
+    EXPECT_EQ(2, set.size());
+
+    EXPECT_TRUE(set.contains({{1, 2}}));
+    EXPECT_TRUE(set.contains({{2, 1}}));
+    EXPECT_FALSE(set.contains({{1, 1}}));
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains({{1, 2}}));
+}
+
+TEST(HashIndex, EqualRange) {
+    HashIndex<t_tuple, 1> index;
+    for (RamDomain i = 0; i < 1000; i++) {
+        index.insert({{i, i % 10}});
+    }
+    EXPECT_EQ(1000, index.size());
+
+    // all tuples agreeing on the second column are found
+    std::set<RamDomain> found;
+    for (const auto& cur : index.equalRange({{0, 3}})) {
+        EXPECT_EQ(3, cur[1]);
+        found.insert(cur[0]);
+    }
+    EXPECT_EQ(100, found.size());
+
+    EXPECT_TRUE(index.equalRange({{0, 10}}).empty());
+    EXPECT_TRUE(index.contains({{13, 3}}));
+    EXPECT_FALSE(index.contains({{14, 3}}));
+}
+
+TEST(HashIndex, InsertAll) {
+    HashIndex<t_tuple, 0, 1> a;
+    HashIndex<t_tuple, 0, 1> b;
+    for (RamDomain i = 0; i < 100; i++) {
+        a.insert({{i, 0}});
+        b.insert({{i, i % 2}});
+    }
+    a.insertAll(b);
+    EXPECT_EQ(150, a.size());
+    for (RamDomain i = 0; i < 100; i++) {
+        EXPECT_TRUE(a.contains({{i, 0}}));
+        EXPECT_EQ(i % 2 == 1, a.contains({{i, 1}}));
+    }
+}
+
+TEST(HashIndex, ParallelInsert) {
+    const int N = 10000;
+    HashIndex<t_tuple, 0, 1> set;
+
+    // every tuple is inserted by two threads, only one of them succeeds
+    std::atomic<int> inserted(0);
+#pragma omp parallel for
+    for (int i = 0; i < 2 * N; i++) {
+        if (set.insert({{i % N, 0}})) {
+            inserted++;
+        }
+    }
+    EXPECT_EQ(N, inserted);
+    EXPECT_EQ(N, set.size());
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,150 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file profile_counters_test.cpp
+ *
+ * Test cases for the hardware counts of a profile.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "EventProcessor.h"
+#include "ProfileDatabase.h"
+#include "json11.h"
+#include "profile/OutputProcessor.h"
+#include "profile/Reader.h"
+#include "profile/Tui.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace souffle {
+namespace profile {
+namespace test {
+
+/**
+ * Write the log of a profile with a non-recursive rule of relation a and a recursive rule of
+ * relation b, which runs in two iterations, with the hardware counts of each evaluation.
+ */
+void writeLog(const std::string& filename) {
+    auto log = std::make_shared<ProfileLog>();
+    ProfileDatabase db;
+    db.setLog(log);
+    auto& processor = EventProcessorSingleton::instance();
+    db.addTimeEntry({"program", "starttime"}, microseconds(0));
+    db.addDurationEntry({"program", "runtime"}, microseconds(0), microseconds(100));
+    for (const std::string relation : {"a", "b"}) {
+        db.addTextEntry({"program", "relation", relation, "source-locator"}, "[1:1-1:2]");
+        db.addDurationEntry({"program", "relation", relation, "runtime"}, microseconds(0), microseconds(50));
+        db.addSizeEntry({"program", "relation", relation, "num-tuples"}, 10);
+    }
+
+    const HardwareCounts rule = {{"cycles", 1000}, {"instructions", 2500}, {"llc-misses", 7}};
+    processor.process(db, "@t-nonrecursive-rule;a;[2:1-2:5];a(x) :- c(x).", microseconds(0),
+            microseconds(10), size_t(0), size_t(0), size_t(10), size_t(0), &rule);
+
+    const HardwareCounts first = {{"cycles", 100}, {"instructions", 200}, {"llc-misses", 1}};
+    const HardwareCounts second = {{"cycles", 300}, {"instructions", 600}, {"llc-misses", 2}};
+    processor.process(db, "@t-recursive-rule;b;0;[3:1-3:5];b(x) :- b(x).", microseconds(10),
+            microseconds(20), size_t(0), size_t(0), size_t(5), size_t(0), &first);
+    processor.process(db, "@t-recursive-rule;b;0;[3:1-3:5];b(x) :- b(x).", microseconds(20),
+            microseconds(30), size_t(0), size_t(0), size_t(5), size_t(1), &second);
+
+    std::ofstream file(filename, std::ios::binary);
+    const std::string records = log->take();
+    file.write(records.data(), records.size());
+}
+
+/** find the row of a rule by its id */
+std::shared_ptr<Row> findRow(Table table, const std::string& id) {
+    for (auto& row : table.getRows()) {
+        if ((*row)[6] != nullptr && (*row)[6]->toString(0) == id) {
+            return row;
+        }
+    }
+    return nullptr;
+}
+
+TEST(ProfileCounters, Tables) {
+    const std::string filename = "profile_counters_test_tables.log";
+    writeLog(filename);
+
+    OutputProcessor out;
+    Reader reader(filename, out.getProgramRun());
+    reader.processFile();
+
+    // cycles, instructions, llc misses and instructions per cycle of a rule from column 11
+    Table rules = out.getRulTable();
+    auto nonRecursive = findRow(rules, "N1.1");
+    auto recursive = findRow(rules, "C2.1");
+    EXPECT_TRUE(nonRecursive != nullptr && recursive != nullptr);
+    EXPECT_EQ(1000, (*nonRecursive)[11]->getLongVal());
+    EXPECT_EQ(2500, (*nonRecursive)[12]->getLongVal());
+    EXPECT_EQ(7, (*nonRecursive)[13]->getLongVal());
+    EXPECT_EQ(2.5, (*nonRecursive)[14]->getDoubleVal());
+
+    // the counts of a recursive rule add up over its iterations
+    EXPECT_EQ(400, (*recursive)[11]->getLongVal());
+    EXPECT_EQ(800, (*recursive)[12]->getLongVal());
+    EXPECT_EQ(3, (*recursive)[13]->getLongVal());
+    EXPECT_EQ(2, (*recursive)[14]->getDoubleVal());
+
+    // and so do the counts of its versions, from column 10
+    Table versions = out.getVersions("R2", "C2.1");
+    EXPECT_EQ(1, versions.getRows().size());
+    Row& version = *versions.getRows()[0];
+    EXPECT_EQ(400, version[10]->getLongVal());
+    EXPECT_EQ(800, version[11]->getLongVal());
+    EXPECT_EQ(3, version[12]->getLongVal());
+    EXPECT_EQ(2, version[13]->getDoubleVal());
+
+    std::remove(filename.c_str());
+}
+
+TEST(ProfileCounters, Json) {
+    const std::string filename = "profile_counters_test_json.log";
+    writeLog(filename);
+
+    // the data of the html script, without the semicolon ending its statement
+    Tui tui(filename, false, false);
+    std::string json = tui.genJson();
+    json = json.substr(0, json.rfind(';'));
+    std::string error;
+    auto data = json11::Json::parse(json, error);
+    EXPECT_EQ("", error);
+    EXPECT_TRUE(data["counters"].bool_value());
+
+    // the html script reads the counts of a rule from RUL_COUNTS = 10
+    const auto& rule = data["rul"]["C2.1"];
+    EXPECT_EQ(400, rule[10].number_value());
+    EXPECT_EQ(800, rule[11].number_value());
+    EXPECT_EQ(3, rule[12].number_value());
+    EXPECT_EQ(2, rule[13].number_value());
+
+    // and the counts of a version from VER_COUNTS = 8, two columns before those of its rule
+    const auto& version = rule[7][0];
+    EXPECT_EQ(400, version[8].number_value());
+    EXPECT_EQ(800, version[9].number_value());
+    EXPECT_EQ(3, version[10].number_value());
+    EXPECT_EQ(2, version[11].number_value());
+
+    // a non-recursive rule has no versions, but its counts are at the same columns
+    EXPECT_EQ(1000, data["rul"]["N1.1"][10].number_value());
+    EXPECT_EQ(2.5, data["rul"]["N1.1"][13].number_value());
+
+    std::remove(filename.c_str());
+}
+
+}  // namespace test
+}  // namespace profile
+}  // namespace souffle
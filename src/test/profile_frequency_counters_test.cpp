@@ -0,0 +1,89 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file profile_frequency_counters_test.cpp
+ *
+ * Test cases for the per-thread frequency counters of profiled programs.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "ProfileEvent.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+TEST(ProfileFrequencyCounters, Sequential) {
+    ProfileFrequencyCounters counters(3);
+    EXPECT_EQ(0, counters.sum(0));
+
+    counters[0]++;
+    counters[2] += 5;
+    EXPECT_EQ(1, counters.sum(0));
+    EXPECT_EQ(0, counters.sum(1));
+    EXPECT_EQ(5, counters.sum(2));
+}
+
+TEST(ProfileFrequencyCounters, Concurrent) {
+    const size_t numThreads = 8;
+    const size_t N = 100000;
+    ProfileFrequencyCounters counters(2);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < N; ++i) {
+                counters[0]++;
+                counters[1] += t;
+            }
+        });
+    }
+    for (auto& cur : threads) {
+        cur.join();
+    }
+
+    // each thread counted into a block of its own, the sums cover all of them
+    EXPECT_EQ(numThreads * N, counters.sum(0));
+    EXPECT_EQ(N * numThreads * (numThreads - 1) / 2, counters.sum(1));
+
+    // the current thread adds a block of its own
+    counters[0]++;
+    EXPECT_EQ(numThreads * N + 1, counters.sum(0));
+}
+
+TEST(ProfileFrequencyCounters, Destroyed) {
+    // a thread caches its block of each instance, which must not be found by a later instance
+    for (size_t round = 1; round <= 10; ++round) {
+        std::unique_ptr<ProfileFrequencyCounters> counters(new ProfileFrequencyCounters(1));
+        EXPECT_EQ(0, counters->sum(0));
+        for (size_t i = 0; i < round; ++i) {
+            (*counters)[0]++;
+        }
+        std::thread([&]() { (*counters)[0]++; }).join();
+        EXPECT_EQ(round + 1, counters->sum(0));
+    }
+
+    // instances alive at the same time count apart
+    ProfileFrequencyCounters first(1);
+    ProfileFrequencyCounters second(1);
+    first[0]++;
+    second[0] += 2;
+    EXPECT_EQ(1, first.sum(0));
+    EXPECT_EQ(2, second.sum(0));
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,96 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file profile_log_test.cpp
+ *
+ * Test cases for the binary profile log.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "ProfileDatabase.h"
+#include "profile/Reader.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace souffle {
+namespace profile {
+namespace test {
+
+/** write the records of a log to a file */
+void append(const std::string& filename, const std::string& records) {
+    std::ofstream file(filename, std::ios::binary | std::ios::app);
+    file.write(records.data(), records.size());
+}
+
+TEST(ProfileLog, RoundTrip) {
+    const std::string filename = "profile_log_test_round_trip.log";
+    std::remove(filename.c_str());
+
+    auto log = std::make_shared<ProfileLog>();
+    ProfileDatabase db;
+    db.setLog(log);
+    db.addSizeEntry({"program", "relation", "a", "num-tuples"}, 300);
+    db.addTextEntry({"program", "relation", "a", "source-locator"}, "[1:1-1:2]");
+    db.addDurationEntry({"program", "relation", "a", "runtime"}, microseconds(5), microseconds(1000005));
+    db.addTimeEntry({"program", "starttime"}, microseconds(5));
+    append(filename, log->take());
+
+    EXPECT_TRUE(LogReader::isLog(filename));
+    ProfileDatabase copy;
+    LogReader(filename).read(copy);
+
+    auto* size = dynamic_cast<SizeEntry*>(copy.lookupEntry({"program", "relation", "a", "num-tuples"}));
+    auto* text = dynamic_cast<TextEntry*>(copy.lookupEntry({"program", "relation", "a", "source-locator"}));
+    auto* duration = dynamic_cast<DurationEntry*>(copy.lookupEntry({"program", "relation", "a", "runtime"}));
+    auto* time = dynamic_cast<TimeEntry*>(copy.lookupEntry({"program", "starttime"}));
+    EXPECT_TRUE(size != nullptr && text != nullptr && duration != nullptr && time != nullptr);
+    EXPECT_EQ(300, size->getSize());
+    EXPECT_EQ("[1:1-1:2]", text->getText());
+    EXPECT_EQ(5, duration->getStart().count());
+    EXPECT_EQ(1000005, duration->getEnd().count());
+    EXPECT_EQ(5, time->getTime().count());
+
+    std::remove(filename.c_str());
+}
+
+TEST(ProfileLog, Incomplete) {
+    const std::string filename = "profile_log_test_incomplete.log";
+    std::remove(filename.c_str());
+
+    ProfileLog log;
+    log.addSize({"program", "relation", "a", "num-tuples"}, 1);
+    log.addSize({"program", "relation", "b", "num-tuples"}, 2);
+    const std::string records = log.take();
+
+    // a reader only takes complete records, and continues where it stopped
+    ProfileDatabase db;
+    LogReader reader(filename);
+    append(filename, records.substr(0, records.size() - 1));
+    reader.read(db);
+    EXPECT_TRUE(db.lookupEntry({"program", "relation", "a", "num-tuples"}) != nullptr);
+    EXPECT_TRUE(db.lookupEntry({"program", "relation", "b", "num-tuples"}) == nullptr);
+
+    append(filename, records.substr(records.size() - 1));
+    reader.read(db);
+    auto* size = dynamic_cast<SizeEntry*>(db.lookupEntry({"program", "relation", "b", "num-tuples"}));
+    EXPECT_TRUE(size != nullptr);
+    EXPECT_EQ(2, size->getSize());
+
+    std::remove(filename.c_str());
+}
+
+}  // namespace test
+}  // namespace profile
+}  // namespace souffle
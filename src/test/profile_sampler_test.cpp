@@ -0,0 +1,72 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file profile_sampler_test.cpp
+ *
+ * Test cases for the sampling profiler.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "ProfileSampler.h"
+
+#include <ctime>
+
+namespace souffle {
+
+namespace test {
+
+/** keep the processor busy for the given seconds of CPU time */
+void spin(double seconds) {
+    const std::clock_t start = std::clock();
+    volatile size_t counter = 0;
+    while (std::clock() - start < seconds * CLOCKS_PER_SEC) {
+        counter++;
+    }
+}
+
+TEST(ProfileSampler, Frames) {
+    auto& sampler = ProfileSampler::instance();
+    auto& frame = sampler.getFrame("@t-nonrecursive-relation;a;[1:1-1:2];");
+    EXPECT_EQ(&frame, &sampler.getFrame("@t-nonrecursive-relation;a;[1:1-1:2];"));
+    EXPECT_NE(&frame, &sampler.getFrame("@t-nonrecursive-relation;b;[2:1-2:2];"));
+    EXPECT_EQ("@t-nonrecursive-relation;a;[1:1-1:2];", frame.getLabel());
+}
+
+TEST(ProfileSampler, NestedScopes) {
+    auto& sampler = ProfileSampler::instance();
+    auto& relation = sampler.getFrame("@t-nonrecursive-relation;c;[3:1-3:2];");
+    auto& rule = sampler.getFrame("@t-nonrecursive-rule;c;[4:1-4:10];c(1).;");
+
+    size_t size = 0;
+    sampler.start(1000);
+    {
+        ProfileSampler::Scope outer(relation);
+        spin(0.1);
+        {
+            ProfileSampler::Scope inner(rule, [&]() { return size; });
+            spin(0.1);
+            size += 5;
+        }
+    }
+    spin(0.05);
+    sampler.stop();
+
+    // samples of the rule also count for the relation it is evaluated in
+    EXPECT_LT(0, rule.getSamples());
+    EXPECT_LT(rule.getSamples(), relation.getSamples());
+    EXPECT_LT(relation.getSamples(), sampler.getSamples());
+    EXPECT_EQ(5, rule.getTuples());
+    EXPECT_EQ(0, relation.getTuples());
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,162 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ram_index_analysis_test.cpp
+ *
+ * Test cases for the index selection of the RAM index analysis.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "AstTranslationUnit.h"
+#include "AstTranslator.h"
+#include "DebugReport.h"
+#include "ErrorReport.h"
+#include "Global.h"
+#include "ParserDriver.h"
+#include "RamIndexAnalysis.h"
+#include "RamProgram.h"
+#include "RamTransformer.h"
+#include "RamTransforms.h"
+#include "RamTranslationUnit.h"
+#include "SymbolTable.h"
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace souffle {
+
+namespace test {
+
+/** searches on the first column and on both columns of a binary relation, forming a single chain */
+MinIndexSelection getChainSelection() {
+    MinIndexSelection indexes;
+    indexes.addSearch(1);
+    indexes.addSearch(3);
+    indexes.solve();
+    return indexes;
+}
+
+TEST(MinIndexSelection, MinimalCover) {
+    MinIndexSelection indexes = getChainSelection();
+    EXPECT_EQ(1, indexes.getAllOrders().size());
+    EXPECT_EQ(0, indexes.getLexOrderNum(1));
+    EXPECT_EQ(0, indexes.getLexOrderNum(3));
+    EXPECT_FALSE(indexes.isHashIndex(0));
+}
+
+TEST(MinIndexSelection, RefineFrequentSearch) {
+    MinIndexSelection indexes = getChainSelection();
+    indexes.addLookups(3, 1000000);
+    indexes.addLookups(1, 10);
+    indexes.setStatistics(1000, true);
+    indexes.refine();
+
+    // the frequent search gets a hash index of its own
+    EXPECT_EQ(2, indexes.getAllOrders().size());
+    EXPECT_EQ(0, indexes.getLexOrderNum(1));
+    EXPECT_EQ(1, indexes.getLexOrderNum(3));
+    EXPECT_TRUE(indexes.isHashIndex(1));
+    EXPECT_EQ(MinIndexSelection::LexOrder({0}), indexes.getAllOrders()[0]);
+    EXPECT_EQ(MinIndexSelection::LexOrder({0, 1}), indexes.getAllOrders()[1]);
+
+    // the lookups saved exceed the maintenance cost
+    EXPECT_LT(indexes.getLookupCost(1) + indexes.getMaintenanceCost(1), 1000000 * 10.0);
+}
+
+TEST(MinIndexSelection, RefineRareSearch) {
+    MinIndexSelection indexes = getChainSelection();
+    indexes.addLookups(3, 100);
+    indexes.setStatistics(1000000, true);
+    indexes.refine();
+    EXPECT_EQ(1, indexes.getAllOrders().size());
+}
+
+TEST(MinIndexSelection, RefineWithoutStatistics) {
+    // unknown size
+    MinIndexSelection unknown = getChainSelection();
+    unknown.addLookups(3, 1000000);
+    unknown.setStatistics(-1, true);
+    unknown.refine();
+    EXPECT_EQ(1, unknown.getAllOrders().size());
+
+    // no hash indexes
+    MinIndexSelection ordered = getChainSelection();
+    ordered.addLookups(3, 1000000);
+    ordered.setStatistics(1000, false);
+    ordered.refine();
+    EXPECT_EQ(1, ordered.getAllOrders().size());
+}
+
+TEST(RamIndexAnalysis, UnqualifiedRelation) {
+    // a large relation probing a small one on its first column and on both columns
+    const std::string large = "ram_index_analysis_test_large.facts";
+    const std::string small = "ram_index_analysis_test_small.facts";
+    auto write = [](const std::string& filename, int numTuples) {
+        std::ofstream out(filename);
+        for (int i = 0; i < numTuples; i++) {
+            out << i << "\t" << i << "\n";
+        }
+    };
+    write(large, 100000);
+    write(small, 1000);
+    const std::string code = R"(
+        .decl a(x:number, y:number)
+        .input a(filename=")" + large + R"(")
+        .decl b(x:number, y:number)
+        .input b(filename=")" + small + R"(")
+        .decl c(x:number, y:number) btree
+        .input c(filename=")" + small + R"(")
+        .decl r(x:number, y:number)
+        .output r
+        r(x, y) :- a(x, y), b(x, _), c(x, _).
+        r(x, y) :- a(x, y), b(x, y), c(x, y).
+    )";
+
+    Global::config().set("fact-dir", ".");
+    auto getIndexes = [&](const std::string& name) {
+        SymbolTable symbolTable;
+        ErrorReport errorReport;
+        DebugReport debugReport;
+        auto astUnit = ParserDriver::parseTranslationUnit(code, symbolTable, errorReport, debugReport);
+        auto ramUnit = AstTranslator().translateUnit(*astUnit);
+        RamLoopTransformer(std::make_unique<RamTransformerSequence>(std::make_unique<ExpandFilterTransformer>(),
+                                   std::make_unique<HoistConditionsTransformer>(),
+                                   std::make_unique<MakeIndexTransformer>()))
+                .apply(*ramUnit);
+        const RamRelation* rel = ramUnit->getProgram()->getRelation(name);
+        return ramUnit->getAnalysis<RamIndexAnalysis>()->getIndexes(*rel);
+    };
+
+    // interpreted, b-tree indexes only
+    MinIndexSelection interpreted = getIndexes("b");
+    EXPECT_EQ(1, interpreted.getAllOrders().size());
+    EXPECT_FALSE(interpreted.isHashIndex(0));
+
+    // compiled, the frequent lookups of the relation without a qualifier get a hash index
+    Global::config().set("compile");
+    MinIndexSelection compiled = getIndexes("b");
+    EXPECT_EQ(2, compiled.getAllOrders().size());
+    EXPECT_TRUE(compiled.isHashIndex(1));
+
+    // the btree qualifier keeps b-tree indexes
+    MinIndexSelection ordered = getIndexes("c");
+    EXPECT_EQ(1, ordered.getAllOrders().size());
+    Global::config().unset("compile");
+
+    std::remove(large.c_str());
+    std::remove(small.c_str());
+}
+
+}  // namespace test
+}  // namespace souffle
@@ -0,0 +1,101 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file shm_test.cpp
+ *
+ * Tests for the message passing of the shm engine.
+ *
+ ***********************************************************************/
+
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Shm.h"
+#include "test.h"
+
+namespace souffle {
+
+namespace test {
+
+TEST(shm, OutOfOrder) {
+    // many more messages than a mailbox holds initially, received after a later message
+    const int count = 1000;
+    shm::init(2);
+    if (shm::commRank() == 1) {
+        for (int i = 0; i < count; ++i) {
+            shm::send(i, 0, 1);
+        }
+        shm::send(std::string(1000, 'x'), 0, 1);
+        shm::send(count, 0, 2);
+        shm::finalize();
+        std::_Exit(EXIT_SUCCESS);
+    }
+
+    int last;
+    shm::recv(last, 1, 2);
+    EXPECT_EQ(count, last);
+    bool ordered = true;
+    for (int i = 0; i < count; ++i) {
+        int value;
+        shm::recv(value, 1, 1);
+        ordered = ordered && value == i;
+    }
+    EXPECT_TRUE(ordered);
+    std::string large;
+    auto status = shm::probe(1, 1);
+    shm::recv(large, status);
+    EXPECT_EQ(std::string(1000, 'x'), large);
+    shm::finalize();
+}
+
+TEST(shm, CrashedWorker) {
+    // run the program in a process of its own, as its master process terminates when the worker does
+    const pid_t program = fork();
+    ASSERT_TRUE(program >= 0);
+    if (program == 0) {
+        shm::init(2);
+        if (shm::commRank() == 1) {
+            // grow the mailbox of the master process, and leave a payload unread
+            for (int i = 0; i < 100; ++i) {
+                shm::send(i, 0, 1);
+            }
+            shm::send(std::string(1000, 'x'), 0, 1);
+            raise(SIGKILL);
+        }
+        shm::finalize();
+        std::_Exit(EXIT_SUCCESS);
+    }
+
+    int status;
+    EXPECT_EQ(program, waitpid(program, &status, 0));
+    EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE);
+
+    // no segment of the program is left behind
+    const std::string prefix = "/souffle." + std::to_string(program) + ".";
+    for (const std::string& name : {prefix + "mailbox.0.0", prefix + "mailbox.0.1", prefix + "mailbox.0.2",
+                 prefix + "mailbox.1.0", prefix + "mailbox.1.1", prefix + "1.0"}) {
+        const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        EXPECT_TRUE(fd < 0) << name;
+        if (fd >= 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+        }
+    }
+}
+
+}  // namespace test
+}  // namespace souffle
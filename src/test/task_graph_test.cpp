@@ -0,0 +1,111 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file task_graph_test.cpp
+ *
+ * Test cases for the task graph running independent strata.
+ *
+ ***********************************************************************/
+
+#include "TaskGraph.h"
+#include "test.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+TEST(TaskGraph, Empty) {
+    TaskGraph graph;
+    graph.run();
+}
+
+TEST(TaskGraph, Chain) {
+    const int N = 100;
+
+    // each task must observe all of its predecessors completed
+    TaskGraph graph;
+    std::vector<int> order;
+    for (int i = 0; i < N; i++) {
+        std::vector<size_t> preds;
+        if (i > 0) preds.push_back(i - 1);
+        graph.addTask([&order, i]() { order.push_back(i); }, preds);
+    }
+    graph.run();
+
+    EXPECT_EQ(N, order.size());
+    for (int i = 0; i < (int)order.size(); i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(TaskGraph, Diamonds) {
+    const int N = 100;
+
+    // layers of independent tasks joined by a single task
+    TaskGraph graph;
+    std::vector<std::atomic<int>> done(N * 5);
+    for (auto& cur : done) {
+        cur = 0;
+    }
+    std::atomic<int> violations(0);
+    size_t join = 0;
+    for (int i = 0; i < N; i++) {
+        std::vector<size_t> layer;
+        for (int j = 0; j < 4; j++) {
+            std::vector<size_t> preds;
+            if (i > 0) preds.push_back(join);
+            layer.push_back(graph.addTask(
+                    [&, i, j, preds]() {
+                        for (size_t pred : preds) {
+                            if (done[pred] == 0) violations++;
+                        }
+                        done[i * 5 + j] = 1;
+                    },
+                    preds));
+        }
+        join = graph.addTask(
+                [&, i, layer]() {
+                    for (size_t pred : layer) {
+                        if (done[pred] == 0) violations++;
+                    }
+                    done[i * 5 + 4] = 1;
+                },
+                layer);
+    }
+    graph.run();
+
+    EXPECT_EQ(0, violations);
+    for (auto& cur : done) {
+        EXPECT_EQ(1, cur);
+    }
+}
+
+TEST(TaskGraph, Exception) {
+    TaskGraph graph;
+    std::atomic<int> count(0);
+    size_t first = graph.addTask([&]() { throw std::runtime_error("failed task"); });
+    graph.addTask([&]() { count++; }, {first});
+
+    bool caught = false;
+    try {
+        graph.run();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    EXPECT_TRUE(caught);
+    EXPECT_EQ(0, count);
+}
+
+}  // end namespace test
+}  // end namespace souffle
@@ -0,0 +1,186 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2019, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file work_stealing_test.cpp
+ *
+ * Test cases for the work-stealing scheduler behind the parallel utils.
+ *
+ ***********************************************************************/
+
+#include "test.h"
+
+#include "Brie.h"
+#include "ParallelUtils.h"
+#include "WorkStealing.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace souffle {
+
+namespace test {
+
+TEST(WorkStealing, SequentialLoop) {
+    // outside of a parallel region all iterations are processed by the current thread
+    int sum = 0;
+    pfor_range(i, 0, 100) {
+        sum += i;
+    }
+    EXPECT_EQ(4950, sum);
+
+    int count = 0;
+    pfor_range(i, 5, 5) {
+        count += i;
+    }
+    EXPECT_EQ(0, count);
+}
+
+TEST(WorkStealing, EachIterationOnce) {
+    WorkStealingPool::setNumThreads(4);
+    EXPECT_EQ(4, MAX_THREADS);
+
+    const int N = 10000;
+    std::vector<std::atomic<int>> hits(N);
+    for (auto& cur : hits) {
+        cur = 0;
+    }
+
+    PARALLEL_START {
+        // several loops in one region, without a barrier in between
+        pfor_range(i, 0, N) {
+            hits[i]++;
+        }
+        pfor_range_nowait(i, 0, N / 2) {
+            hits[2 * i]++;
+        }
+    }
+    PARALLEL_END
+
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ((i % 2 == 0) ? 2 : 1, hits[i]);
+    }
+}
+
+TEST(WorkStealing, Skewed) {
+    WorkStealingPool::setNumThreads(4);
+
+    // all the work is in the first few iterations -- the others have to steal it
+    std::vector<int> data(1000);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = i;
+    }
+    std::atomic<long> sum(0);
+    PARALLEL_START {
+        pfor_range(it, data.begin(), data.end()) {
+            if (*it < 8) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            sum += *it;
+        }
+    }
+    PARALLEL_END
+    EXPECT_EQ(499500, sum);
+}
+
+TEST(WorkStealing, ManyLoops) {
+    WorkStealingPool::setNumThreads(4);
+
+    // a loop per outer iteration, as of a collapsed scan; finished loops are freed on the way
+    const int N = 20000;
+    std::vector<std::atomic<int>> hits(N);
+    for (auto& cur : hits) {
+        cur = 0;
+    }
+    PARALLEL_START {
+        for (int i = 0; i < N; i++) {
+            pfor_range_nowait(j, 0, 3) {
+                hits[i] += j + 1;
+            }
+        }
+    }
+    PARALLEL_END
+
+    bool all = true;
+    for (int i = 0; i < N; i++) {
+        all = all && hits[i] == 6;
+    }
+    EXPECT_TRUE(all);
+}
+
+TEST(WorkStealing, Exception) {
+    WorkStealingPool::setNumThreads(4);
+
+    bool caught = false;
+    try {
+        PARALLEL_START {
+            pfor_range(i, 0, 100) {
+                if (i == 42) {
+                    throw std::runtime_error("failure");
+                }
+            }
+        }
+        PARALLEL_END
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    EXPECT_TRUE(caught);
+
+    // the pool is still usable afterwards
+    std::atomic<int> sum(0);
+    PARALLEL_START {
+        pfor_range(i, 0, 100) {
+            sum += i;
+        }
+    }
+    PARALLEL_END
+    EXPECT_EQ(4950, sum);
+}
+
+TEST(WorkStealing, Nested) {
+    WorkStealingPool::setNumThreads(3);
+
+    // regions started from within a region are processed as well
+    std::atomic<int> sum(0);
+    PARALLEL_START {
+        pfor_range(i, 0, 10) {
+            PARALLEL_START {
+                pfor_range(j, 0, 10) {
+                    sum += 10 * i + j;
+                }
+            }
+            PARALLEL_END
+        }
+    }
+    PARALLEL_END
+    EXPECT_EQ(4950, sum);
+}
+
+TEST(WorkStealing, BrieMerge) {
+    WorkStealingPool::setNumThreads(4);
+
+    Trie<2> a;
+    Trie<2> b;
+    for (RamDomain i = 0; i < 1000; i++) {
+        a.insert({i, i + 1});
+        b.insert({i * 7, i});
+    }
+    a.insertAll(b);
+
+    for (RamDomain i = 0; i < 1000; i++) {
+        EXPECT_TRUE(a.contains({i, i + 1}));
+        EXPECT_TRUE(a.contains({i * 7, i}));
+    }
+}
+
+}  // namespace test
+}  // namespace souffle